@@ -0,0 +1,270 @@
+/*
+ * Lectura y escritura del formato binario .cmag
+ */
+
+#define _DEFAULT_SOURCE
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "archivo_cuadro.h"
+
+// Un varint de 64 bits ocupa como máximo 10 bytes
+#define MAX_BYTES_VARINT 10
+
+// ============= VARINT ZIGZAG =============
+
+static uint8_t* escribir_varint(uint8_t* p, uint64_t valor) {
+    while (valor >= 0x80) {
+        *p++ = (uint8_t)(valor | 0x80);
+        valor >>= 7;
+    }
+    *p++ = (uint8_t)valor;
+    return p;
+}
+
+// Lee un varint sin pasar de fin; devuelve NULL si está truncado
+static const uint8_t* leer_varint(const uint8_t* p, const uint8_t* fin, uint64_t* valor) {
+    uint64_t resultado = 0;
+    for (int desplazamiento = 0; p < fin && desplazamiento < 64; desplazamiento += 7) {
+        uint8_t byte = *p++;
+        resultado |= (uint64_t)(byte & 0x7f) << desplazamiento;
+        if (!(byte & 0x80)) {
+            *valor = resultado;
+            return p;
+        }
+    }
+    return NULL;
+}
+
+static uint64_t zigzag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static int64_t deszigzag(uint64_t z) {
+    return (int64_t)(z >> 1) ^ -(int64_t)(z & 1);
+}
+
+// ============= CODIFICACIÓN DELTA =============
+
+// Codifica una fila como segundas diferencias. Un cero va seguido de la
+// longitud de la racha menos uno. Devuelve el final de lo escrito.
+static uint8_t* codificar_fila_delta(const long long* fila, int n, uint8_t* p) {
+    int64_t anterior = 0, delta_anterior = 0;
+    int ceros = 0;
+
+    for (int j = 0; j < n; j++) {
+        int64_t delta = fila[j] - anterior;
+        int64_t segunda = delta - delta_anterior;
+        anterior = fila[j];
+        delta_anterior = delta;
+
+        if (segunda == 0) {
+            ceros++;
+            continue;
+        }
+        if (ceros > 0) {
+            p = escribir_varint(p, 0);
+            p = escribir_varint(p, (uint64_t)(ceros - 1));
+            ceros = 0;
+        }
+        p = escribir_varint(p, zigzag(segunda));
+    }
+    if (ceros > 0) {
+        p = escribir_varint(p, 0);
+        p = escribir_varint(p, (uint64_t)(ceros - 1));
+    }
+    return p;
+}
+
+// Decodifica una fila; devuelve NULL si los datos no alcanzan o no cuadran.
+// Se acumula sin signo (un archivo armado no puede desbordar nada) y cada
+// valor se corta contra n² apenas aparece: los negativos dan la vuelta y
+// también quedan afuera.
+static const uint8_t* decodificar_fila_delta(const uint8_t* p, const uint8_t* fin, int n, long long* fila) {
+    uint64_t maximo = (uint64_t)n * n;
+    uint64_t valor = 0, delta = 0;
+    int j = 0;
+
+    while (j < n) {
+        uint64_t z;
+        p = leer_varint(p, fin, &z);
+        if (!p) return NULL;
+
+        uint64_t repeticiones = 1;
+        if (z == 0) {
+            p = leer_varint(p, fin, &repeticiones);
+            if (!p || repeticiones >= (uint64_t)(n - j)) return NULL;
+            repeticiones++;
+        }
+
+        uint64_t segunda = (uint64_t)deszigzag(z);
+        for (uint64_t r = 0; r < repeticiones; r++) {
+            delta += segunda;
+            valor += delta;
+            if (valor > maximo) return NULL;
+            fila[j++] = (long long)valor;
+        }
+    }
+    return p;
+}
+
+// ============= ESCRITURA =============
+
+void llenar_cabecera_cuadro(const CuadroMagico* cuadro, CodificacionCuadro codificacion,
+                            uint64_t bytes_datos, CabeceraCuadro* cabecera) {
+    memset(cabecera, 0, sizeof(*cabecera));
+    memcpy(cabecera->firma, FIRMA_ARCHIVO_CUADRO, 4);
+    cabecera->version = VERSION_ARCHIVO_CUADRO;
+    cabecera->codificacion = (uint16_t)codificacion;
+    cabecera->orden = (uint32_t)cuadro->tamaño;
+    cabecera->algoritmo = (uint32_t)cuadro->algoritmo;
+    cabecera->ancho_elemento = (uint32_t)cuadro->ancho;
+    cabecera->banderas = cuadro->es_valido ? BANDERA_CUADRO_VALIDO : 0;
+    cabecera->suma_magica = cuadro->suma_magica;
+    cabecera->bytes_datos = bytes_datos;
+}
+
+bool guardar_cuadro_magico(const CuadroMagico* cuadro, const char* ruta, CodificacionCuadro codificacion) {
+    if (!cuadro || !ruta) return false;
+
+    FILE* archivo = fopen(ruta, "wb");
+    if (!archivo) return false;
+
+    int n = cuadro->tamaño;
+    size_t ancho = cuadro->ancho;
+    // Las filas planas van en el ancho del cuadro; las delta, como long long
+    void* fila = malloc((size_t)n * (codificacion == CODIFICACION_DELTA ? sizeof(long long) : ancho));
+    uint8_t* codificada = codificacion == CODIFICACION_DELTA ?
+                          (uint8_t*)malloc((size_t)n * MAX_BYTES_VARINT) : NULL;
+    bool ok = fila && (codificacion != CODIFICACION_DELTA || codificada);
+
+    // La cabecera se reescribe al final, cuando se conoce el tamaño de los datos
+    CabeceraCuadro cabecera;
+    llenar_cabecera_cuadro(cuadro, codificacion, 0, &cabecera);
+    ok = ok && fwrite(&cabecera, sizeof(cabecera), 1, archivo) == 1;
+
+    uint64_t bytes_datos = 0;
+    if (ok && codificacion == CODIFICACION_PLANA && cuadro->modo == CUADRO_MATERIALIZADO) {
+        size_t celdas = (size_t)n * n;
+        ok = fwrite(cuadro->matriz, ancho, celdas, archivo) == celdas;
+        bytes_datos = (uint64_t)celdas * ancho;
+    } else {
+        for (int i = 0; ok && i < n; i++) {
+            if (codificacion == CODIFICACION_DELTA) {
+                obtener_fila_valores(cuadro, i, (long long*)fila);
+                size_t bytes = (size_t)(codificar_fila_delta((const long long*)fila, n, codificada) - codificada);
+                ok = fwrite(codificada, 1, bytes, archivo) == bytes;
+                bytes_datos += bytes;
+            } else {
+                obtener_fila_cuadro(cuadro, i, fila);
+                ok = fwrite(fila, ancho, (size_t)n, archivo) == (size_t)n;
+                bytes_datos += (uint64_t)n * ancho;
+            }
+        }
+    }
+
+    if (ok) {
+        cabecera.bytes_datos = bytes_datos;
+        ok = fseek(archivo, 0, SEEK_SET) == 0 &&
+             fwrite(&cabecera, sizeof(cabecera), 1, archivo) == 1;
+    }
+
+    free(codificada);
+    free(fila);
+    if (fclose(archivo) != 0) ok = false;
+    if (!ok) remove(ruta);
+    return ok;
+}
+
+// ============= CARGA =============
+
+static bool cabecera_valida(const CabeceraCuadro* cabecera, size_t bytes_archivo) {
+    if (memcmp(cabecera->firma, FIRMA_ARCHIVO_CUADRO, 4) != 0) return false;
+    if (cabecera->version != VERSION_ARCHIVO_CUADRO) return false;
+    if (cabecera->algoritmo >= NUM_ALGORITMOS) return false;
+    if (!orden_valido_para_algoritmo((int)cabecera->orden, (TipoAlgoritmo)cabecera->algoritmo)) return false;
+    if (cabecera->ancho_elemento != (uint32_t)ancho_celda_para_orden((int)cabecera->orden)) return false;
+    if (cabecera->suma_magica != calcular_suma_magica((int)cabecera->orden)) return false;
+    if (cabecera->bytes_datos > bytes_archivo - BYTES_CABECERA_CUADRO) return false;
+
+    uint64_t celdas = (uint64_t)cabecera->orden * cabecera->orden;
+    switch (cabecera->codificacion) {
+        case CODIFICACION_PLANA:
+            return cabecera->bytes_datos == celdas * cabecera->ancho_elemento;
+        case CODIFICACION_DELTA:
+            return true;
+        default:
+            return false;
+    }
+}
+
+CuadroMagico* cargar_cuadro_magico(const char* ruta) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+    (void)ruta;
+    return NULL;    // El formato es little-endian y se lee sin conversión
+#else
+    int fd = open(ruta, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < BYTES_CABECERA_CUADRO) {
+        close(fd);
+        return NULL;
+    }
+
+    size_t bytes_archivo = (size_t)info.st_size;
+    void* mapeo = mmap(NULL, bytes_archivo, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapeo == MAP_FAILED) return NULL;
+
+    const CabeceraCuadro* cabecera = (const CabeceraCuadro*)mapeo;
+    CuadroMagico* cuadro = cabecera_valida(cabecera, bytes_archivo) ?
+                           (CuadroMagico*)malloc(sizeof(CuadroMagico)) : NULL;
+    if (!cuadro) {
+        munmap(mapeo, bytes_archivo);
+        return NULL;
+    }
+
+    int n = (int)cabecera->orden;
+    const uint8_t* datos = (const uint8_t*)mapeo + BYTES_CABECERA_CUADRO;
+    cuadro->tamaño = n;
+    cuadro->ancho = (AnchoCelda)cabecera->ancho_elemento;
+    cuadro->suma_magica = cabecera->suma_magica;
+    cuadro->es_valido = (cabecera->banderas & BANDERA_CUADRO_VALIDO) != 0;
+    cuadro->modo = CUADRO_MATERIALIZADO;
+    cuadro->algoritmo = (TipoAlgoritmo)cabecera->algoritmo;
+    cuadro->mapeo = NULL;
+    cuadro->bytes_mapeo = 0;
+
+    if (cabecera->codificacion == CODIFICACION_PLANA) {
+        // Vista directa: la cabecera mide 64 bytes, así que las celdas quedan alineadas
+        madvise(mapeo, bytes_archivo, MADV_SEQUENTIAL);
+        cuadro->matriz = (void*)datos;
+        cuadro->mapeo = mapeo;
+        cuadro->bytes_mapeo = bytes_archivo;
+        return cuadro;
+    }
+
+    // Cada fila se decodifica a long long y se guarda en el ancho del cuadro
+    cuadro->matriz = malloc((size_t)n * n * cuadro->ancho);
+    long long* fila = (long long*)malloc((size_t)n * sizeof(long long));
+    const uint8_t* p = cuadro->matriz && fila ? datos : NULL;
+    const uint8_t* fin = datos + cabecera->bytes_datos;
+    for (int i = 0; p && i < n; i++) {
+        p = decodificar_fila_delta(p, fin, n, fila);
+        for (int j = 0; p && j < n; j++) {
+            escribir_celda(cuadro->matriz, cuadro->ancho, (size_t)i * n + j, (unsigned long long)fila[j]);
+        }
+    }
+    free(fila);
+    munmap(mapeo, bytes_archivo);
+
+    if (!p) {
+        liberar_cuadro_magico(cuadro);
+        return NULL;
+    }
+    return cuadro;
+#endif
+}
@@ -0,0 +1,61 @@
+/*
+ * Formato binario de cuadros mágicos (.cmag).
+ *
+ * Una cabecera de 64 bytes (little-endian) seguida de las celdas fila por
+ * fila, de 2, 4 u 8 bytes según el orden (ver AnchoCelda). Con la
+ * codificación plana las celdas se guardan tal cual y el archivo se carga
+ * con mmap sin copiar nada: la matriz del cuadro apunta al mapeo. Con la
+ * codificación delta cada fila se guarda como segundas diferencias en
+ * varint zigzag, con las rachas de ceros comprimidas; las filas de la
+ * familia siamés son progresiones aritméticas por tramos, así que casi todo
+ * el archivo son rachas de ceros.
+ */
+
+#ifndef ARCHIVO_CUADRO_H
+#define ARCHIVO_CUADRO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cuadros_magicos.h"
+
+#define FIRMA_ARCHIVO_CUADRO "CMAG"
+#define VERSION_ARCHIVO_CUADRO 2
+#define BYTES_CABECERA_CUADRO 64
+
+typedef enum {
+    CODIFICACION_PLANA = 0,     // Celdas sin comprimir, se cargan con mmap
+    CODIFICACION_DELTA = 1      // Segundas diferencias por fila en varint
+} CodificacionCuadro;
+
+// Bit de banderas: el cuadro era válido al guardarse
+#define BANDERA_CUADRO_VALIDO 1u
+
+typedef struct {
+    char firma[4];              // "CMAG"
+    uint16_t version;
+    uint16_t codificacion;      // CodificacionCuadro
+    uint32_t orden;
+    uint32_t algoritmo;         // TipoAlgoritmo
+    uint32_t ancho_elemento;    // Bytes por celda (AnchoCelda del orden)
+    uint32_t banderas;
+    int64_t suma_magica;
+    uint64_t bytes_datos;       // Tamaño de lo que sigue a la cabecera
+    uint8_t reservado[24];
+} CabeceraCuadro;
+
+// La cabecera debe medir exactamente BYTES_CABECERA_CUADRO
+typedef char comprobar_tamano_cabecera[sizeof(CabeceraCuadro) == BYTES_CABECERA_CUADRO ? 1 : -1];
+
+// Guarda el cuadro (materializado o virtual); devuelve false si falla la escritura
+bool guardar_cuadro_magico(const CuadroMagico* cuadro, const char* ruta, CodificacionCuadro codificacion);
+
+// Llena la cabecera que describe al cuadro; bytes_datos es el tamaño de lo que sigue
+void llenar_cabecera_cuadro(const CuadroMagico* cuadro, CodificacionCuadro codificacion,
+                            uint64_t bytes_datos, CabeceraCuadro* cabecera);
+
+// Carga un archivo .cmag. Los archivos planos se devuelven como una vista de
+// solo lectura sobre el mapeo (no se debe escribir en la matriz); los delta
+// se decodifican a una matriz nueva. Devuelve NULL si el archivo no es válido.
+CuadroMagico* cargar_cuadro_magico(const char* ruta);
+
+#endif // ARCHIVO_CUADRO_H
@@ -0,0 +1,104 @@
+/*
+ * Arena de cuadros: bloques encadenados con asignación por avance de puntero
+ */
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "arena_cuadros.h"
+
+// Alineación de cada reserva (una línea de caché, suficiente para AVX2)
+#define ALINEACION_ARENA 64
+
+struct BloqueArena {
+    BloqueArena* siguiente;
+    size_t capacidad;
+    size_t usado;
+    // Los datos empiezan en la primera dirección alineada tras la cabecera
+};
+
+static size_t alinear(size_t bytes) {
+    return (bytes + ALINEACION_ARENA - 1) & ~(size_t)(ALINEACION_ARENA - 1);
+}
+
+static char* datos_bloque(BloqueArena* bloque) {
+    return (char*)alinear((uintptr_t)(bloque + 1));
+}
+
+static BloqueArena* nuevo_bloque(size_t capacidad) {
+    BloqueArena* bloque = (BloqueArena*)malloc(sizeof(BloqueArena) + ALINEACION_ARENA + capacidad);
+    if (!bloque) return NULL;
+    bloque->siguiente = NULL;
+    bloque->capacidad = capacidad;
+    bloque->usado = 0;
+    return bloque;
+}
+
+void iniciar_arena_cuadros(ArenaCuadros* arena, size_t bytes_bloque) {
+    arena->primero = NULL;
+    arena->actual = NULL;
+    arena->bytes_bloque = alinear(bytes_bloque ? bytes_bloque : BYTES_BLOQUE_ARENA);
+}
+
+// Toma bytes de la arena: del bloque actual, del siguiente ya reservado
+// o, si ninguno alcanza, de un bloque nuevo
+void* arena_reservar(ArenaCuadros* arena, size_t bytes) {
+    bytes = alinear(bytes);
+
+    BloqueArena* bloque = arena->actual;
+    while (bloque && bloque->capacidad - bloque->usado < bytes) {
+        bloque = bloque->siguiente;
+        if (bloque) bloque->usado = 0;
+    }
+
+    if (!bloque) {
+        size_t capacidad = bytes > arena->bytes_bloque ? bytes : arena->bytes_bloque;
+        bloque = nuevo_bloque(capacidad);
+        if (!bloque) return NULL;
+
+        // Se agrega tras el bloque actual para no perder los que siguen
+        if (arena->actual) {
+            bloque->siguiente = arena->actual->siguiente;
+            arena->actual->siguiente = bloque;
+        } else {
+            bloque->siguiente = arena->primero;
+            arena->primero = bloque;
+        }
+    }
+
+    arena->actual = bloque;
+    void* resultado = datos_bloque(bloque) + bloque->usado;
+    bloque->usado += bytes;
+    return resultado;
+}
+
+CuadroMagico* arena_crear_cuadro(ArenaCuadros* arena, int n, TipoAlgoritmo algoritmo) {
+    size_t bytes_celdas = bytes_celdas_cuadro(n);
+    if (bytes_celdas == 0) return NULL;
+
+    // Estructura y celdas juntas, en una sola reserva
+    size_t bytes_estructura = alinear(sizeof(CuadroMagico));
+    char* memoria = (char*)arena_reservar(arena, bytes_estructura + bytes_celdas);
+    if (!memoria) return NULL;
+
+    CuadroMagico* cuadro = (CuadroMagico*)memoria;
+    if (!generar_cuadro_en_buffer(cuadro, memoria + bytes_estructura, bytes_celdas, n, algoritmo, NULL, NULL)) {
+        return NULL;
+    }
+    return cuadro;
+}
+
+void reiniciar_arena_cuadros(ArenaCuadros* arena) {
+    arena->actual = arena->primero;
+    if (arena->actual) arena->actual->usado = 0;
+}
+
+void destruir_arena_cuadros(ArenaCuadros* arena) {
+    BloqueArena* bloque = arena->primero;
+    while (bloque) {
+        BloqueArena* siguiente = bloque->siguiente;
+        free(bloque);
+        bloque = siguiente;
+    }
+    arena->primero = NULL;
+    arena->actual = NULL;
+}
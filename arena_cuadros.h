@@ -0,0 +1,42 @@
+/*
+ * Arena de cuadros mágicos para lotes.
+ *
+ * Los cuadros (estructura y celdas) se toman de bloques grandes con un
+ * simple avance de puntero, y se liberan todos juntos al reiniciar la
+ * arena. Los bloques se conservan entre lotes, así que después del primer
+ * lote generar no vuelve a pasar por malloc.
+ */
+
+#ifndef ARENA_CUADROS_H
+#define ARENA_CUADROS_H
+
+#include <stddef.h>
+#include "cuadros_magicos.h"
+
+// Tamaño por defecto de cada bloque de la arena
+#define BYTES_BLOQUE_ARENA (1u << 20)
+
+typedef struct BloqueArena BloqueArena;
+
+typedef struct {
+    BloqueArena* primero;
+    BloqueArena* actual;        // Bloque del que se está tomando memoria
+    size_t bytes_bloque;
+} ArenaCuadros;
+
+// bytes_bloque 0 usa BYTES_BLOQUE_ARENA
+void iniciar_arena_cuadros(ArenaCuadros* arena, size_t bytes_bloque);
+
+// Reserva bytes sin inicializar, alineados a 64, que viven hasta reiniciar
+// o destruir la arena
+void* arena_reservar(ArenaCuadros* arena, size_t bytes);
+
+// Genera un cuadro dentro de la arena, sin validar. El cuadro vive hasta
+// reiniciar o destruir la arena; no se libera con liberar_cuadro_magico.
+CuadroMagico* arena_crear_cuadro(ArenaCuadros* arena, int n, TipoAlgoritmo algoritmo);
+
+// Libera de una vez todos los cuadros de la arena (conserva los bloques)
+void reiniciar_arena_cuadros(ArenaCuadros* arena);
+void destruir_arena_cuadros(ArenaCuadros* arena);
+
+#endif // ARENA_CUADROS_H
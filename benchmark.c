@@ -0,0 +1,341 @@
+/*
+ * Benchmark de generación y validación de cuadros mágicos
+ * Proyecto de Análisis de Algoritmos
+ *
+ * Recorre todos los algoritmos y una serie de órdenes y mide por separado la
+ * generación y la validación (ns por celda), las reservas de memoria por
+ * cuadro y la variación entre repeticiones. Con --json la salida se puede
+ * guardar y comparar entre compilaciones.
+ *
+ * Uso: ./cuadros_magicos_benchmark [--json] [--repeticiones R] [--ordenes 3,5,101]
+ *
+ * Las reservas se cuentan envolviendo malloc/calloc/realloc con el enlazador
+ * (-Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc), ver compilar.sh.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "cuadros_magicos.h"
+#include "validacion.h"
+#include "materializacion.h"
+#include "arena_cuadros.h"
+
+#define MAX_ORDENES 64
+#define REPETICIONES_POR_DEFECTO 5
+#define CELDAS_POR_MUESTRA 1000000   // Los cuadros pequeños se repiten hasta sumar esto
+
+// ============= CONTEO DE RESERVAS =============
+
+void* __real_malloc(size_t tamaño);
+void* __real_calloc(size_t cantidad, size_t tamaño);
+void* __real_realloc(void* puntero, size_t tamaño);
+
+// Los hilos de validación también reservan, por eso los contadores son atómicos
+static unsigned long long reservas_contadas = 0;
+static unsigned long long bytes_contados = 0;
+
+static void contar_reserva(size_t bytes) {
+    __atomic_fetch_add(&reservas_contadas, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&bytes_contados, bytes, __ATOMIC_RELAXED);
+}
+
+void* __wrap_malloc(size_t tamaño) {
+    contar_reserva(tamaño);
+    return __real_malloc(tamaño);
+}
+
+void* __wrap_calloc(size_t cantidad, size_t tamaño) {
+    contar_reserva(cantidad * tamaño);
+    return __real_calloc(cantidad, tamaño);
+}
+
+void* __wrap_realloc(void* puntero, size_t tamaño) {
+    contar_reserva(tamaño);
+    return __real_realloc(puntero, tamaño);
+}
+
+// ============= MEDICIÓN =============
+
+// Forma de generar el cuadro que se mide
+typedef enum {
+    MODO_MATERIALIZADO,     // crear_cuadro_magico_con_progreso (sin validar)
+    MODO_VIRTUAL,           // crear_cuadro_virtual (solo la fórmula, sin validar)
+    MODO_KUROSAKA_LEGADO,   // generar_kurosaka (incluye su propia validación)
+    MODO_ARENA              // arena_crear_cuadro, reiniciando la arena tras cada cuadro
+} ModoBenchmark;
+
+static const char* nombres_modo[] = {"materializado", "virtual", "generar_kurosaka", "arena"};
+
+static ArenaCuadros arena_benchmark;
+
+// Media, desviación estándar y mínimo de una serie de muestras
+typedef struct {
+    double media;
+    double desviacion;
+    double minimo;
+} Estadistica;
+
+typedef struct {
+    TipoAlgoritmo algoritmo;
+    ModoBenchmark modo;
+    int n;
+    bool valido;
+    Estadistica generacion;      // ns por celda
+    Estadistica validacion;      // ns por celda
+    double reservas_generacion;  // Por cuadro
+    double bytes_generacion;
+    double reservas_validacion;  // Por validación
+} ResultadoBenchmark;
+
+static double ahora_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static Estadistica calcular_estadistica(const double* muestras, int cantidad) {
+    Estadistica e = {0, 0, muestras[0]};
+    for (int i = 0; i < cantidad; i++) {
+        e.media += muestras[i];
+        if (muestras[i] < e.minimo) e.minimo = muestras[i];
+    }
+    e.media /= cantidad;
+
+    if (cantidad > 1) {
+        double suma = 0;
+        for (int i = 0; i < cantidad; i++) {
+            suma += (muestras[i] - e.media) * (muestras[i] - e.media);
+        }
+        e.desviacion = sqrt(suma / (cantidad - 1));
+    }
+    return e;
+}
+
+static CuadroMagico* generar_segun_modo(ModoBenchmark modo, int n, TipoAlgoritmo algoritmo) {
+    switch (modo) {
+        case MODO_VIRTUAL:         return crear_cuadro_virtual(n, algoritmo);
+        case MODO_KUROSAKA_LEGADO: return generar_kurosaka(n);
+        case MODO_ARENA:           return arena_crear_cuadro(&arena_benchmark, n, algoritmo);
+        default:                   return crear_cuadro_magico_con_progreso(n, algoritmo, NULL, NULL);
+    }
+}
+
+// Mide un algoritmo en un orden. Cada muestra repite la operación las veces
+// necesarias para cubrir CELDAS_POR_MUESTRA celdas; antes de medir se hace
+// una pasada de calentamiento que no se cuenta.
+static bool medir(ModoBenchmark modo, TipoAlgoritmo algoritmo, int n, int repeticiones,
+                  ResultadoBenchmark* resultado) {
+    double celdas = (double)n * n;
+    int iteraciones = celdas >= CELDAS_POR_MUESTRA ? 1 : (int)(CELDAS_POR_MUESTRA / celdas);
+
+    double* muestras_gen = (double*)malloc(repeticiones * sizeof(double));
+    double* muestras_val = (double*)malloc(repeticiones * sizeof(double));
+    if (!muestras_gen || !muestras_val) {
+        free(muestras_gen);
+        free(muestras_val);
+        return false;
+    }
+
+    resultado->algoritmo = algoritmo;
+    resultado->modo = modo;
+    resultado->n = n;
+    resultado->valido = true;
+
+    unsigned long long reservas_gen = 0, bytes_gen = 0, reservas_val = 0;
+    bool ok = true;
+
+    for (int r = -1; r < repeticiones && ok; r++) {
+        double tiempo_gen = 0, tiempo_val = 0;
+
+        for (int it = 0; it < iteraciones; it++) {
+            unsigned long long reservas_antes = reservas_contadas;
+            unsigned long long bytes_antes = bytes_contados;
+
+            double inicio = ahora_ns();
+            CuadroMagico* cuadro = generar_segun_modo(modo, n, algoritmo);
+            tiempo_gen += ahora_ns() - inicio;
+            if (!cuadro) {
+                ok = false;
+                break;
+            }
+
+            unsigned long long reservas_medio = reservas_contadas;
+            inicio = ahora_ns();
+            bool valido = validar_cuadro_magico(cuadro);
+            tiempo_val += ahora_ns() - inicio;
+
+            if (r >= 0) {
+                reservas_gen += reservas_medio - reservas_antes;
+                bytes_gen += bytes_contados - bytes_antes;
+                reservas_val += reservas_contadas - reservas_medio;
+            }
+            resultado->valido = resultado->valido && valido;
+            if (modo == MODO_ARENA) reiniciar_arena_cuadros(&arena_benchmark);
+            else liberar_cuadro_magico(cuadro);
+        }
+
+        if (r >= 0) {
+            muestras_gen[r] = tiempo_gen / (iteraciones * celdas);
+            muestras_val[r] = tiempo_val / (iteraciones * celdas);
+        }
+    }
+
+    if (ok) {
+        double cuadros = (double)repeticiones * iteraciones;
+        resultado->generacion = calcular_estadistica(muestras_gen, repeticiones);
+        resultado->validacion = calcular_estadistica(muestras_val, repeticiones);
+        resultado->reservas_generacion = reservas_gen / cuadros;
+        resultado->bytes_generacion = bytes_gen / cuadros;
+        resultado->reservas_validacion = reservas_val / cuadros;
+    }
+
+    free(muestras_gen);
+    free(muestras_val);
+    return ok;
+}
+
+// ============= SALIDA =============
+
+static void imprimir_encabezado_tabla(int repeticiones) {
+    printf("=== BENCHMARK DE CUADROS MÁGICOS ===\n");
+    printf("Kernel de generación: %s · Kernel de validación: %s · Hilos: %d · Repeticiones: %d\n\n",
+           nombre_kernel_formula(), nombre_kernel_fila(), hilos_disponibles(), repeticiones);
+    printf("%-10s %-17s %6s  %18s  %18s  %9s %12s %9s  %s\n",
+           "algoritmo", "modo", "n", "gen ns/celda (±)", "val ns/celda (±)",
+           "reservas", "bytes", "res. val", "válido");
+}
+
+static void imprimir_fila_tabla(const ResultadoBenchmark* r) {
+    printf("%-10s %-17s %6d  %9.3f (±%6.3f)  %9.3f (±%6.3f)  %9.1f %12.0f %9.1f  %s\n",
+           nombre_algoritmo(r->algoritmo), nombres_modo[r->modo], r->n,
+           r->generacion.media, r->generacion.desviacion,
+           r->validacion.media, r->validacion.desviacion,
+           r->reservas_generacion, r->bytes_generacion, r->reservas_validacion,
+           r->valido ? "sí" : "no");
+}
+
+static void imprimir_estadistica_json(const char* nombre, const Estadistica* e) {
+    printf("\"%s\": {\"ns_por_celda\": %.4f, \"desviacion\": %.4f, \"minimo\": %.4f}",
+           nombre, e->media, e->desviacion, e->minimo);
+}
+
+static void imprimir_json(const ResultadoBenchmark* resultados, int cantidad, int repeticiones) {
+    printf("{\n");
+    printf("  \"kernel_generacion\": \"%s\",\n", nombre_kernel_formula());
+    printf("  \"kernel_validacion\": \"%s\",\n", nombre_kernel_fila());
+    printf("  \"hilos\": %d,\n", hilos_disponibles());
+    printf("  \"repeticiones\": %d,\n", repeticiones);
+    printf("  \"resultados\": [\n");
+    for (int i = 0; i < cantidad; i++) {
+        const ResultadoBenchmark* r = &resultados[i];
+        printf("    {\"algoritmo\": \"%s\", \"modo\": \"%s\", \"n\": %d, \"valido\": %s, ",
+               nombre_algoritmo(r->algoritmo), nombres_modo[r->modo], r->n,
+               r->valido ? "true" : "false");
+        imprimir_estadistica_json("generacion", &r->generacion);
+        printf(", ");
+        imprimir_estadistica_json("validacion", &r->validacion);
+        printf(", \"reservas_por_cuadro\": %.2f, \"bytes_por_cuadro\": %.0f, "
+               "\"reservas_por_validacion\": %.2f}%s\n",
+               r->reservas_generacion, r->bytes_generacion, r->reservas_validacion,
+               i + 1 < cantidad ? "," : "");
+    }
+    printf("  ]\n}\n");
+}
+
+// ============= PROGRAMA PRINCIPAL =============
+
+// Lee una lista de órdenes separados por comas; devuelve cuántos leyó
+static int leer_ordenes(const char* texto, int* ordenes) {
+    int cantidad = 0;
+    const char* p = texto;
+    while (*p && cantidad < MAX_ORDENES) {
+        char* fin;
+        long n = strtol(p, &fin, 10);
+        if (fin == p) return 0;
+        if (n < 3 || n > MAX_ORDEN) {
+            fprintf(stderr, "Orden inválido: %ld (debe estar entre 3 y %d)\n", n, MAX_ORDEN);
+            return 0;
+        }
+        ordenes[cantidad++] = (int)n;
+        p = *fin == ',' ? fin + 1 : fin;
+        if (*fin != ',' && *fin != '\0') return 0;
+    }
+    return cantidad;
+}
+
+static void mostrar_uso(const char* programa) {
+    fprintf(stderr, "Uso: %s [--json] [--repeticiones R] [--ordenes 3,5,101]\n", programa);
+}
+
+int main(int argc, char* argv[]) {
+    int ordenes[MAX_ORDENES] = {3, 4, 5, 6, 11, 51, 100, 101, 102, 501, 1001, 1002, 2001, 2002};
+    int num_ordenes = 14;
+    int repeticiones = REPETICIONES_POR_DEFECTO;
+    bool json = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0) {
+            json = true;
+        } else if (strcmp(argv[i], "--repeticiones") == 0 && i + 1 < argc) {
+            repeticiones = atoi(argv[++i]);
+            if (repeticiones < 1) {
+                mostrar_uso(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--ordenes") == 0 && i + 1 < argc) {
+            num_ordenes = leer_ordenes(argv[++i], ordenes);
+            if (num_ordenes == 0) {
+                mostrar_uso(argv[0]);
+                return 1;
+            }
+        } else {
+            mostrar_uso(argv[0]);
+            return 1;
+        }
+    }
+
+    int maximo = num_ordenes * NUM_ALGORITMOS * 3 + num_ordenes;
+    ResultadoBenchmark* resultados = (ResultadoBenchmark*)malloc(maximo * sizeof(ResultadoBenchmark));
+    if (!resultados) {
+        fprintf(stderr, "Error: No se pudo reservar memoria.\n");
+        return 1;
+    }
+    int cantidad = 0;
+
+    if (!json) imprimir_encabezado_tabla(repeticiones);
+    iniciar_arena_cuadros(&arena_benchmark, 0);
+
+    for (int k = 0; k < num_ordenes; k++) {
+        for (int modo = MODO_MATERIALIZADO; modo <= MODO_ARENA; modo++) {
+            for (int alg = ALGORITMO_KUROSAKA; alg < NUM_ALGORITMOS; alg++) {
+                // generar_kurosaka solo existe para Kurosaka, y los cuadros
+                // virtuales solo para los recorridos (órdenes impares)
+                if (modo == MODO_KUROSAKA_LEGADO && alg != ALGORITMO_KUROSAKA) continue;
+                if (modo == MODO_VIRTUAL && ordenes[k] % 2 == 0) continue;
+                if (!orden_valido_para_algoritmo(ordenes[k], (TipoAlgoritmo)alg)) continue;
+
+                ResultadoBenchmark* r = &resultados[cantidad];
+                if (!medir((ModoBenchmark)modo, (TipoAlgoritmo)alg, ordenes[k], repeticiones, r)) {
+                    fprintf(stderr, "Error: No se pudo generar %s n=%d (%s)\n",
+                            nombre_algoritmo(alg), ordenes[k], nombres_modo[modo]);
+                    continue;
+                }
+                cantidad++;
+                if (!json) {
+                    imprimir_fila_tabla(r);
+                    fflush(stdout);
+                }
+            }
+        }
+    }
+
+    if (json) imprimir_json(resultados, cantidad, repeticiones);
+
+    free(resultados);
+    destruir_arena_cuadros(&arena_benchmark);
+    return 0;
+}
@@ -0,0 +1,506 @@
+/*
+ * Búsqueda local de cuadros mágicos: recocido simulado con cadenas por hilo
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+#include "busqueda_local.h"
+#include "validacion.h"
+
+// Intercambios por celda que se le dan a una cadena antes de reiniciarla
+#define INTERCAMBIOS_POR_CELDA 1000
+
+// Aumento de costo a partir del cual un intercambio nunca se acepta
+#define MAX_AUMENTO_ACEPTADO 64
+
+// Uno de cada tantos intercambios se elige al azar, sin mirar las líneas
+#define PERIODO_INTERCAMBIO_LIBRE 64
+
+// Cada cuántos intercambios una cadena mira si ya hay cuadros suficientes
+#define PERIODO_CONSULTA 65536
+
+// Repetidos seguidos tras los cuales se da por hecho que el orden no tiene
+// más cuadros que encontrar (orden 3 tiene 8)
+#define MAX_REPETIDOS_SEGUIDOS 256
+
+// Temperaturas con que se van probando las cadenas, relativas a la de
+// temperatura_base(n)
+static const double temperaturas[] = {1.0, 0.5};
+#define NUM_TEMPERATURAS ((int)(sizeof(temperaturas) / sizeof(temperaturas[0])))
+
+// Los órdenes chicos necesitan más temperatura para salir de los mínimos
+// locales; en los grandes hay tantas líneas que conviene casi no subir
+static double temperatura_base(int n) {
+    double t = 8.0 / n;
+    return t > 1.0 ? 1.0 : t < 0.1 ? 0.1 : t;
+}
+
+// ============= GENERADOR =============
+
+typedef struct {
+    uint64_t s[4];
+} GeneradorAleatorio;
+
+static uint64_t splitmix64(uint64_t* x) {
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static void sembrar_generador(GeneradorAleatorio* g, uint64_t semilla) {
+    for (int k = 0; k < 4; k++) g->s[k] = splitmix64(&semilla);
+}
+
+static inline uint64_t rotar(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+// xoshiro256**
+static inline uint64_t siguiente_aleatorio(GeneradorAleatorio* g) {
+    uint64_t resultado = rotar(g->s[1] * 5, 7) * 9;
+    uint64_t t = g->s[1] << 17;
+    g->s[2] ^= g->s[0];
+    g->s[3] ^= g->s[1];
+    g->s[1] ^= g->s[2];
+    g->s[0] ^= g->s[3];
+    g->s[2] ^= t;
+    g->s[3] = rotar(g->s[3], 45);
+    return resultado;
+}
+
+// Entero en [0, limite) sin divisiones (el sesgo es despreciable)
+static inline uint32_t aleatorio_menor(GeneradorAleatorio* g, uint32_t limite) {
+    return (uint32_t)(((siguiente_aleatorio(g) >> 32) * limite) >> 32);
+}
+
+// ============= CADENA =============
+
+// Estado de una cadena. Las líneas se numeran: filas 0..n-1, columnas
+// n..2n-1, diagonal 2n y antidiagonal 2n+1.
+typedef struct {
+    int n;
+    int celdas;
+    uint64_t inverso;           // ceil(2^40 / n): celda / n sin dividir
+    long long suma;
+    int* valores;               // Celda -> valor
+    int* posiciones;            // Valor -> celda (índices 1..n²)
+    long long* sumas;           // Suma de cada línea
+    int* malas;                 // Líneas que no dan la suma mágica
+    int* indice_mala;           // Línea -> su lugar en malas, o -1
+    int num_malas;
+    long long costo;            // Suma de |suma - suma mágica| de las líneas
+    uint64_t umbral[MAX_AUMENTO_ACEPTADO];  // Probabilidad de aceptar cada aumento, en 2^-64
+    GeneradorAleatorio generador;
+    long long intercambios;
+    const int* fijos;           // Valor fijo de cada celda (0 = libre), o NULL
+    int* libres;                // Celdas libres, si hay fijas
+    int num_libres;
+} CadenaBusqueda;
+
+static long long absoluto(long long x) {
+    return x < 0 ? -x : x;
+}
+
+// Líneas que pasan por una celda. Con celda < 2^20 y n <= 1000 el
+// producto por el inverso da el cociente exacto.
+static int lineas_de_celda(const CadenaBusqueda* c, int celda, int* lineas) {
+    int n = c->n;
+    int i = (int)(((uint64_t)celda * c->inverso) >> 40);
+    int j = celda - i * n;
+    int cantidad = 0;
+    lineas[cantidad++] = i;
+    lineas[cantidad++] = n + j;
+    if (i == j) lineas[cantidad++] = 2 * n;
+    if (i + j == n - 1) lineas[cantidad++] = 2 * n + 1;
+    return cantidad;
+}
+
+// k-ésima celda de una línea
+static int celda_de_linea(int n, int linea, int k) {
+    if (linea < n) return linea * n + k;
+    if (linea < 2 * n) return k * n + (linea - n);
+    if (linea == 2 * n) return k * (n + 1);
+    return (k + 1) * (n - 1);
+}
+
+// Mantiene el conjunto de líneas malas al cambiar la suma de una
+static void actualizar_linea(CadenaBusqueda* c, int linea, long long suma) {
+    bool era_mala = c->indice_mala[linea] >= 0;
+    bool es_mala = suma != c->suma;
+    c->sumas[linea] = suma;
+
+    if (es_mala && !era_mala) {
+        c->indice_mala[linea] = c->num_malas;
+        c->malas[c->num_malas++] = linea;
+    } else if (!es_mala && era_mala) {
+        int lugar = c->indice_mala[linea];
+        int ultima = c->malas[--c->num_malas];
+        c->malas[lugar] = ultima;
+        c->indice_mala[ultima] = lugar;
+        c->indice_mala[linea] = -1;
+    }
+}
+
+static void preparar_temperatura(CadenaBusqueda* c, double temperatura) {
+    for (int d = 1; d < MAX_AUMENTO_ACEPTADO; d++) {
+        c->umbral[d] = (uint64_t)(exp(-d / temperatura) * 18446744073709549568.0);
+    }
+    c->umbral[0] = UINT64_MAX;
+}
+
+// Una celda que se puede mover, al azar
+static int celda_movible(CadenaBusqueda* c) {
+    if (!c->fijos) return (int)aleatorio_menor(&c->generador, (uint32_t)c->celdas);
+    return c->libres[aleatorio_menor(&c->generador, (uint32_t)c->num_libres)];
+}
+
+// Empieza una cadena con una permutación al azar de 1..n² (o, con celdas
+// fijas, de los valores que faltan repartidos en las libres)
+static void reiniciar_cadena(CadenaBusqueda* c, double temperatura) {
+    int n = c->n;
+    int lineas = 2 * n + 2;
+
+    if (c->fijos) {
+        // posiciones sirve de marca de los valores ya usados por las fijas
+        memset(c->posiciones, 0, sizeof(int) * (c->celdas + 1));
+        for (int k = 0; k < c->celdas; k++) {
+            if (c->fijos[k] != 0) c->posiciones[c->fijos[k]] = 1;
+        }
+        int siguiente = 0;
+        for (int v = 1; v <= c->celdas; v++) {
+            if (!c->posiciones[v]) c->valores[c->libres[siguiente++]] = v;
+        }
+        for (int k = 0; k < c->celdas; k++) {
+            if (c->fijos[k] != 0) c->valores[k] = c->fijos[k];
+        }
+    } else {
+        for (int k = 0; k < c->celdas; k++) c->valores[k] = k + 1;
+    }
+
+    // Mezcla de las celdas movibles
+    int movibles = c->fijos ? c->num_libres : c->celdas;
+    for (int k = movibles - 1; k > 0; k--) {
+        int otro = (int)aleatorio_menor(&c->generador, (uint32_t)k + 1);
+        int ck = c->fijos ? c->libres[k] : k;
+        int co = c->fijos ? c->libres[otro] : otro;
+        int t = c->valores[ck];
+        c->valores[ck] = c->valores[co];
+        c->valores[co] = t;
+    }
+
+    memset(c->sumas, 0, sizeof(long long) * lineas);
+    for (int k = 0; k < c->celdas; k++) {
+        int v = c->valores[k];
+        c->posiciones[v] = k;
+        int l[4];
+        int num = lineas_de_celda(c, k, l);
+        for (int m = 0; m < num; m++) c->sumas[l[m]] += v;
+    }
+
+    c->num_malas = 0;
+    c->costo = 0;
+    for (int linea = 0; linea < lineas; linea++) {
+        long long suma = c->sumas[linea];
+        c->indice_mala[linea] = -1;
+        c->sumas[linea] = c->suma;
+        actualizar_linea(c, linea, suma);
+        c->costo += absoluto(suma - c->suma);
+    }
+    preparar_temperatura(c, temperatura);
+}
+
+// Evalúa el intercambio de las celdas a y b y lo hace si el recocido lo
+// acepta. Solo cambian las líneas de a o de b que no comparten.
+static void intentar_intercambio(CadenaBusqueda* c, int a, int b) {
+    long long d = c->valores[b] - c->valores[a];
+    if (a == b || d == 0) return;
+    c->intercambios++;
+
+    int lineas[8];
+    long long cambios[8];
+    int num = lineas_de_celda(c, a, lineas);
+    for (int m = 0; m < num; m++) cambios[m] = d;
+
+    int de_b[4];
+    int num_b = lineas_de_celda(c, b, de_b);
+    for (int m = 0; m < num_b; m++) {
+        int compartida = -1;
+        for (int k = 0; k < num; k++) {
+            if (lineas[k] == de_b[m]) compartida = k;
+        }
+        if (compartida >= 0) {
+            cambios[compartida] = 0;
+        } else {
+            lineas[num] = de_b[m];
+            cambios[num++] = -d;
+        }
+    }
+
+    long long aumento = 0;
+    for (int m = 0; m < num; m++) {
+        long long suma = c->sumas[lineas[m]];
+        aumento += absoluto(suma + cambios[m] - c->suma) - absoluto(suma - c->suma);
+    }
+    if (aumento > 0 &&
+        (aumento >= MAX_AUMENTO_ACEPTADO || siguiente_aleatorio(&c->generador) >= c->umbral[aumento])) {
+        return;
+    }
+
+    int va = c->valores[a], vb = c->valores[b];
+    c->valores[a] = vb;
+    c->valores[b] = va;
+    c->posiciones[vb] = a;
+    c->posiciones[va] = b;
+    for (int m = 0; m < num; m++) {
+        if (cambios[m] != 0) actualizar_linea(c, lineas[m], c->sumas[lineas[m]] + cambios[m]);
+    }
+    c->costo += aumento;
+}
+
+// Corre la cadena hasta que todas las líneas sumen bien (true), se gaste
+// el presupuesto o *detener se active
+static bool correr_cadena(CadenaBusqueda* c, const int* detener) {
+    long long presupuesto = (long long)INTERCAMBIOS_POR_CELDA * c->celdas;
+    long long inicio = c->intercambios;
+
+    for (long long paso = 0; c->num_malas > 0; paso++) {
+        if (c->intercambios - inicio >= presupuesto) return false;
+        if (paso % PERIODO_CONSULTA == 0 && __atomic_load_n(detener, __ATOMIC_RELAXED)) return false;
+
+        int a, b;
+        if (aleatorio_menor(&c->generador, PERIODO_INTERCAMBIO_LIBRE) == 0) {
+            a = celda_movible(c);
+            b = celda_movible(c);
+        } else {
+            // Una celda de una línea mala y la que tiene el valor que la arregla
+            int linea = c->malas[aleatorio_menor(&c->generador, (uint32_t)c->num_malas)];
+            a = celda_de_linea(c->n, linea, (int)aleatorio_menor(&c->generador, (uint32_t)c->n));
+            if (c->fijos && c->fijos[a] != 0) continue;
+            long long objetivo = c->valores[a] - (c->sumas[linea] - c->suma);
+            b = objetivo >= 1 && objetivo <= c->celdas ? c->posiciones[objetivo] : celda_movible(c);
+            if (c->fijos && c->fijos[b] != 0) b = celda_movible(c);
+        }
+        intentar_intercambio(c, a, b);
+    }
+    return true;
+}
+
+// fijos puede ser NULL; si no, la cadena solo mueve sus celdas en 0
+static bool iniciar_cadena(CadenaBusqueda* c, int n, const int* fijos, uint64_t semilla) {
+    memset(c, 0, sizeof(*c));
+    c->n = n;
+    c->celdas = n * n;
+    c->inverso = ((1ull << 40) + n - 1) / n;
+    c->suma = calcular_suma_magica(n);
+    int lineas = 2 * n + 2;
+
+    c->valores = (int*)malloc(sizeof(int) * c->celdas);
+    c->posiciones = (int*)malloc(sizeof(int) * (c->celdas + 1));
+    c->sumas = (long long*)malloc(sizeof(long long) * lineas);
+    c->malas = (int*)malloc(sizeof(int) * lineas);
+    c->indice_mala = (int*)malloc(sizeof(int) * lineas);
+    sembrar_generador(&c->generador, semilla);
+
+    if (fijos) {
+        c->fijos = fijos;
+        c->libres = (int*)malloc(sizeof(int) * c->celdas);
+        if (!c->libres) return false;
+        for (int k = 0; k < c->celdas; k++) {
+            if (fijos[k] == 0) c->libres[c->num_libres++] = k;
+        }
+    }
+    return c->valores && c->posiciones && c->sumas && c->malas && c->indice_mala;
+}
+
+static void liberar_cadena(CadenaBusqueda* c) {
+    free(c->valores);
+    free(c->posiciones);
+    free(c->sumas);
+    free(c->malas);
+    free(c->indice_mala);
+    free(c->libres);
+}
+
+// ============= HILOS =============
+
+// Estado compartido: los cuadros aceptados y una tabla de sus hashes para
+// descartar repetidos
+typedef struct {
+    int n;
+    AnchoCelda ancho;
+    size_t bytes_cuadro;
+    int pedidos;
+    char* cuadros;
+    int cantidad;
+    int* tabla;                 // Índice + 1 de cada cuadro, 0 si está libre
+    unsigned int mascara_tabla;
+    long long repetidos;
+    int repetidos_seguidos;
+    int detener;
+    pthread_mutex_t mutex;
+} BusquedaCompartida;
+
+typedef struct {
+    BusquedaCompartida* compartida;
+    CadenaBusqueda cadena;
+    unsigned char* celdas;      // El cuadro encontrado, en el ancho del resultado
+    long long cadenas;
+    pthread_t hilo;
+} TrabajadorBusqueda;
+
+static uint64_t hash_cuadro(const unsigned char* celdas, size_t bytes) {
+    uint64_t h = 0xCBF29CE484222325ull;
+    for (size_t k = 0; k < bytes; k++) h = (h ^ celdas[k]) * 0x100000001B3ull;
+    return h;
+}
+
+// Agrega el cuadro del trabajador si no estaba; activa detener al
+// completar lo pedido o con demasiados repetidos seguidos
+static void registrar_cuadro(BusquedaCompartida* e, const unsigned char* celdas) {
+    unsigned int ranura = (unsigned int)hash_cuadro(celdas, e->bytes_cuadro) & e->mascara_tabla;
+
+    pthread_mutex_lock(&e->mutex);
+    if (e->cantidad < e->pedidos) {
+        bool repetido = false;
+        while (e->tabla[ranura] != 0) {
+            const char* otro = e->cuadros + (size_t)(e->tabla[ranura] - 1) * e->bytes_cuadro;
+            if (memcmp(otro, celdas, e->bytes_cuadro) == 0) {
+                repetido = true;
+                break;
+            }
+            ranura = (ranura + 1) & e->mascara_tabla;
+        }
+
+        if (repetido) {
+            e->repetidos++;
+            if (++e->repetidos_seguidos > MAX_REPETIDOS_SEGUIDOS) {
+                __atomic_store_n(&e->detener, 1, __ATOMIC_RELAXED);
+            }
+        } else {
+            memcpy(e->cuadros + (size_t)e->cantidad * e->bytes_cuadro, celdas, e->bytes_cuadro);
+            e->tabla[ranura] = ++e->cantidad;
+            e->repetidos_seguidos = 0;
+            if (e->cantidad == e->pedidos) __atomic_store_n(&e->detener, 1, __ATOMIC_RELAXED);
+        }
+    }
+    pthread_mutex_unlock(&e->mutex);
+}
+
+static void* buscar_cuadros(void* arg) {
+    TrabajadorBusqueda* t = (TrabajadorBusqueda*)arg;
+    BusquedaCompartida* e = t->compartida;
+    CadenaBusqueda* c = &t->cadena;
+
+    while (!__atomic_load_n(&e->detener, __ATOMIC_RELAXED)) {
+        reiniciar_cadena(c, temperatura_base(c->n) * temperaturas[t->cadenas % NUM_TEMPERATURAS]);
+        t->cadenas++;
+        if (!correr_cadena(c, &e->detener)) continue;
+
+        for (int k = 0; k < c->celdas; k++) escribir_celda(t->celdas, e->ancho, k, c->valores[k]);
+        registrar_cuadro(e, t->celdas);
+    }
+    return NULL;
+}
+
+// ============= GENERACIÓN =============
+
+bool generar_cuadros_aleatorios(int n, const OpcionesBusquedaLocal* opciones, CuadrosAleatorios* resultado) {
+    memset(resultado, 0, sizeof(*resultado));
+    if (n < 3 || n > MAX_ORDEN_BUSQUEDA_LOCAL || !opciones || opciones->cantidad < 1) return false;
+    resultado->tamaño = n;
+    resultado->ancho = ancho_celda_para_orden(n);
+
+    BusquedaCompartida e;
+    memset(&e, 0, sizeof(e));
+    e.n = n;
+    e.ancho = resultado->ancho;
+    e.bytes_cuadro = (size_t)n * n * e.ancho;
+    e.pedidos = opciones->cantidad;
+
+    unsigned int ranuras = 16;
+    while (ranuras < 2u * (unsigned int)e.pedidos) ranuras <<= 1;
+    e.mascara_tabla = ranuras - 1;
+    e.tabla = (int*)calloc(ranuras, sizeof(int));
+    e.cuadros = (char*)malloc((size_t)e.pedidos * e.bytes_cuadro);
+    if (!e.tabla || !e.cuadros) {
+        free(e.tabla);
+        free(e.cuadros);
+        return false;
+    }
+    pthread_mutex_init(&e.mutex, NULL);
+
+    int num_hilos = opciones->hilos > 0 ? opciones->hilos : hilos_disponibles();
+    if (num_hilos > e.pedidos) num_hilos = e.pedidos;
+    TrabajadorBusqueda* trabajadores = (TrabajadorBusqueda*)calloc((size_t)num_hilos, sizeof(TrabajadorBusqueda));
+
+    // Cada hilo tiene su cadena y su generador, sembrado desde la semilla
+    bool ok = trabajadores != NULL;
+    int preparados = 0;
+    uint64_t semilla = opciones->semilla;
+    for (; ok && preparados < num_hilos; preparados++) {
+        TrabajadorBusqueda* t = &trabajadores[preparados];
+        t->compartida = &e;
+        t->celdas = (unsigned char*)malloc(e.bytes_cuadro);
+        ok = iniciar_cadena(&t->cadena, n, NULL, splitmix64(&semilla)) && t->celdas;
+    }
+
+    if (ok) {
+        // El hilo actual hace de trabajador 0
+        int lanzados = 0;
+        for (int h = 1; h < num_hilos; h++) {
+            if (pthread_create(&trabajadores[h].hilo, NULL, buscar_cuadros, &trabajadores[h]) != 0) break;
+            lanzados++;
+        }
+        buscar_cuadros(&trabajadores[0]);
+        for (int h = 1; h <= lanzados; h++) {
+            pthread_join(trabajadores[h].hilo, NULL);
+        }
+
+        for (int h = 0; h <= lanzados; h++) {
+            resultado->intercambios += trabajadores[h].cadena.intercambios;
+            resultado->cadenas += trabajadores[h].cadenas;
+        }
+        resultado->cuadros = e.cuadros;
+        resultado->cantidad = e.cantidad;
+        resultado->repetidos = e.repetidos;
+        e.cuadros = NULL;
+    }
+
+    for (int h = 0; h < preparados; h++) {
+        liberar_cadena(&trabajadores[h].cadena);
+        free(trabajadores[h].celdas);
+    }
+    free(trabajadores);
+    free(e.cuadros);
+    free(e.tabla);
+    pthread_mutex_destroy(&e.mutex);
+    return ok;
+}
+
+void liberar_cuadros_aleatorios(CuadrosAleatorios* cuadros) {
+    free(cuadros->cuadros);
+    cuadros->cuadros = NULL;
+    cuadros->cantidad = 0;
+}
+
+bool completar_por_busqueda_local(int n, const int* fijos, uint64_t semilla, const int* detener, int* solucion) {
+    if (n < 3 || n > MAX_ORDEN_BUSQUEDA_LOCAL || !fijos) return false;
+
+    CadenaBusqueda c;
+    bool ok = iniciar_cadena(&c, n, fijos, semilla);
+    bool encontrado = false;
+    // Sin celdas libres no hay nada que mover: el cuadro ya es lo que es
+    for (long long cadenas = 0; ok && c.num_libres > 1 && !__atomic_load_n(detener, __ATOMIC_RELAXED); cadenas++) {
+        reiniciar_cadena(&c, temperatura_base(n) * temperaturas[cadenas % NUM_TEMPERATURAS]);
+        if (correr_cadena(&c, detener)) {
+            memcpy(solucion, c.valores, sizeof(int) * c.celdas);
+            encontrado = true;
+            break;
+        }
+    }
+    liberar_cadena(&c);
+    return encontrado;
+}
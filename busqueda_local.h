@@ -0,0 +1,59 @@
+/*
+ * Generación de cuadros mágicos al azar por búsqueda local.
+ *
+ * Los algoritmos de construcción dan siempre el mismo cuadro para cada n.
+ * Acá cada cadena parte de una permutación al azar de 1..n² y la corrige
+ * intercambiando pares de celdas con recocido simulado. El costo es la
+ * suma de |suma de la línea - suma mágica| sobre filas, columnas y
+ * diagonales; las sumas se mantienen al día, así que evaluar un
+ * intercambio toca a lo sumo seis líneas sin importar n. Los intercambios
+ * se eligen sobre una línea que todavía no suma bien: una de sus celdas se
+ * cambia por la que tiene el valor que la arreglaría. Si una cadena no
+ * converge en su presupuesto se reinicia con otra permutación y otra
+ * temperatura.
+ *
+ * Las cadenas corren independientes en todos los núcleos, cada hilo con su
+ * generador xoshiro256**. Los cuadros repetidos se descartan.
+ */
+
+#ifndef BUSQUEDA_LOCAL_H
+#define BUSQUEDA_LOCAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "cuadros_magicos.h"
+
+// Orden máximo: las cadenas convergen en O(n²) intercambios por intento,
+// pero más allá de unos cientos cada cuadro tarda segundos
+#define MAX_ORDEN_BUSQUEDA_LOCAL 1000
+
+typedef struct {
+    int cantidad;           // Cuadros distintos a generar
+    uint64_t semilla;
+    int hilos;              // <= 0 usa todos los núcleos
+} OpcionesBusquedaLocal;
+
+typedef struct {
+    int tamaño;
+    AnchoCelda ancho;           // El de ancho_celda_para_orden(tamaño)
+    void* cuadros;              // cantidad cuadros de n*n celdas, fila por fila
+    int cantidad;
+    long long intercambios;     // Intercambios evaluados en todas las cadenas
+    long long cadenas;          // Cadenas empezadas, incluidas las reiniciadas
+    long long repetidos;        // Cuadros descartados por ya estar
+} CuadrosAleatorios;
+
+// Genera hasta opciones->cantidad cuadros mágicos distintos de orden n (3 a
+// MAX_ORDEN_BUSQUEDA_LOCAL). Puede devolver menos si el orden no tiene
+// tantos (orden 3 tiene 8) y las cadenas solo dan repetidos. Con un hilo
+// la misma semilla da los mismos cuadros; con varios depende del reparto.
+bool generar_cuadros_aleatorios(int n, const OpcionesBusquedaLocal* opciones, CuadrosAleatorios* resultado);
+void liberar_cuadros_aleatorios(CuadrosAleatorios* cuadros);
+
+// Completa un cuadro de n*n valores donde fijos[k] != 0 son celdas fijas,
+// moviendo solo las libres. No puede probar que no haya solución: sigue
+// hasta encontrar una (la deja en solucion y devuelve true) o hasta que
+// *detener se active. Los fijos no deben repetir valores.
+bool completar_por_busqueda_local(int n, const int* fijos, uint64_t semilla, const int* detener, int* solucion);
+
+#endif // BUSQUEDA_LOCAL_H
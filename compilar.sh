@@ -17,15 +17,19 @@ echo "Compilando versiones..."
 
 # Compilar versión automática (GTK Simple)
 echo "- Versión automática..."
-gcc -std=c99 $(pkg-config --cflags gtk+-3.0) main_gtk_simple.c $(pkg-config --libs gtk+-3.0) -o cuadros_magicos_gtk
+gcc -std=c99 -O2 -pthread $(pkg-config --cflags gtk+-3.0) main_gtk_simple.c cuadros_magicos.c cuadros_pares.c materializacion.c movimientos.c validacion.c salida.c lienzo_cuadro.c $(pkg-config --libs gtk+-3.0) -lm -o cuadros_magicos_gtk
 
 # Compilar versión interactiva
 echo "- Versión interactiva..."
-gcc -std=c99 $(pkg-config --cflags gtk+-3.0) cuadros_magicos_interactivo_completo.c $(pkg-config --libs gtk+-3.0) -o cuadros_magicos_completo
+gcc -std=c99 -O2 -pthread $(pkg-config --cflags gtk+-3.0) cuadros_magicos_interactivo_completo.c cuadros_magicos.c cuadros_pares.c materializacion.c movimientos.c validacion.c salida.c lienzo_cuadro.c $(pkg-config --libs gtk+-3.0) -lm -o cuadros_magicos_completo
 
 # Compilar versión de consola (si se desea)
 echo "- Versión de consola..."
-gcc -std=c99 main_console.c cuadros_magicos.c movimientos.c -o cuadros_magicos_consola
+gcc -std=c99 -O2 -pthread main_console.c modo_lote.c archivo_cuadro.c generacion_bandas.c arena_cuadros.c lote_cuadros.c exploracion_movimientos.c enumeracion_cuadros.c busqueda_local.c completado_cuadros.c cuadros_magicos.c cuadros_pares.c materializacion.c movimientos.c validacion.c salida.c -lm -o cuadros_magicos_consola
+
+# Compilar benchmark (cuenta reservas envolviendo malloc/calloc/realloc)
+echo "- Benchmark..."
+gcc -std=c99 -O2 -pthread benchmark.c arena_cuadros.c cuadros_magicos.c cuadros_pares.c materializacion.c movimientos.c validacion.c salida.c -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc -lm -o cuadros_magicos_benchmark
 
 echo ""
 echo "¡Compilación completada!"
@@ -34,5 +38,6 @@ echo "Ejecutables creados:"
 echo "  ./cuadros_magicos_gtk       (Versión automática)"
 echo "  ./cuadros_magicos_completo  (Versión paso a paso)"
 echo "  ./cuadros_magicos_consola   (Versión de consola)"
+echo "  ./cuadros_magicos_benchmark (Benchmark, --json para salida legible por máquina)"
 echo ""
 
@@ -0,0 +1,569 @@
+/*
+ * Completado de cuadros parciales: propagación por sumas de líneas y
+ * ramificación en paralelo con tiempo máximo
+ */
+
+#define _POSIX_C_SOURCE 199309L
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "completado_cuadros.h"
+#include "busqueda_local.h"
+#include "validacion.h"
+
+#define MAX_CELDAS_COMPLETADO (MAX_ORDEN_COMPLETADO * MAX_ORDEN_COMPLETADO)
+#define MAX_LINEAS_COMPLETADO (2 * MAX_ORDEN_COMPLETADO + 2)
+#define PALABRAS_CONJUNTO (MAX_CELDAS_COMPLETADO / 64)
+
+// Ramas abiertas por hilo antes de repartir
+#define RAMAS_POR_HILO 8
+
+// Cada cuántos nodos un hilo mira el reloj
+#define PERIODO_RELOJ 256
+
+// ============= CONJUNTOS DE VALORES =============
+
+// Bit v - 1 encendido si el valor v está en el conjunto
+typedef struct {
+    uint64_t p[PALABRAS_CONJUNTO];
+} ConjuntoValores;
+
+static void conjunto_vacio(ConjuntoValores* c) {
+    memset(c, 0, sizeof(*c));
+}
+
+static void agregar_valor(ConjuntoValores* c, int v) {
+    c->p[(v - 1) >> 6] |= 1ull << ((v - 1) & 63);
+}
+
+static void quitar_valor(ConjuntoValores* c, int v) {
+    c->p[(v - 1) >> 6] &= ~(1ull << ((v - 1) & 63));
+}
+
+static bool tiene_valor(const ConjuntoValores* c, int v) {
+    return (c->p[(v - 1) >> 6] >> ((v - 1) & 63)) & 1;
+}
+
+static int contar_valores(const ConjuntoValores* c) {
+    int cantidad = 0;
+    for (int k = 0; k < PALABRAS_CONJUNTO; k++) cantidad += __builtin_popcountll(c->p[k]);
+    return cantidad;
+}
+
+// Menor valor del conjunto, o 0 si está vacío
+static int primer_valor(const ConjuntoValores* c) {
+    for (int k = 0; k < PALABRAS_CONJUNTO; k++) {
+        if (c->p[k]) return k * 64 + __builtin_ctzll(c->p[k]) + 1;
+    }
+    return 0;
+}
+
+static bool conjuntos_iguales(const ConjuntoValores* a, const ConjuntoValores* b) {
+    return memcmp(a, b, sizeof(*a)) == 0;
+}
+
+// Deja en c solo los valores de [desde, hasta]
+static void recortar_rango(ConjuntoValores* c, long long desde, long long hasta) {
+    for (int k = 0; k < PALABRAS_CONJUNTO; k++) {
+        long long base = (long long)k * 64 + 1;   // Valor del bit 0 de la palabra
+        uint64_t mascara = ~0ull;
+        if (desde > base) mascara = desde - base >= 64 ? 0 : mascara << (desde - base);
+        if (hasta < base + 63) mascara &= hasta < base ? 0 : ~0ull >> (63 - (hasta - base));
+        c->p[k] &= mascara;
+    }
+}
+
+// ============= ESTADO =============
+
+// Forma del cuadro, común a todos los estados. Las líneas se numeran:
+// filas 0..n-1, columnas n..2n-1, diagonal 2n y antidiagonal 2n+1.
+typedef struct {
+    int n;
+    int celdas;
+    int num_lineas;
+    int suma;
+} FormaCompletado;
+
+typedef struct {
+    uint16_t valores[MAX_CELDAS_COMPLETADO];   // 0 si la celda está vacía
+    ConjuntoValores libres;                     // Valores que no están en ninguna celda
+    int sumas[MAX_LINEAS_COMPLETADO];
+    uint8_t vacias[MAX_LINEAS_COMPLETADO];
+    int num_vacias;
+} EstadoCompletado;
+
+static int lineas_de_celda(const FormaCompletado* f, int celda, int* lineas) {
+    int n = f->n;
+    int i = celda / n, j = celda % n;
+    int cantidad = 0;
+    lineas[cantidad++] = i;
+    lineas[cantidad++] = n + j;
+    if (i == j) lineas[cantidad++] = 2 * n;
+    if (i + j == n - 1) lineas[cantidad++] = 2 * n + 1;
+    return cantidad;
+}
+
+static void poner_valor(const FormaCompletado* f, EstadoCompletado* e, int celda, int v) {
+    int lineas[4];
+    int num = lineas_de_celda(f, celda, lineas);
+    e->valores[celda] = (uint16_t)v;
+    quitar_valor(&e->libres, v);
+    e->num_vacias--;
+    for (int m = 0; m < num; m++) {
+        e->sumas[lineas[m]] += v;
+        e->vacias[lineas[m]]--;
+    }
+}
+
+// ============= PROPAGACIÓN =============
+
+// k-ésima celda de una línea
+static int celda_de_linea(const FormaCompletado* f, int linea, int k) {
+    int n = f->n;
+    if (linea < n) return linea * n + k;
+    if (linea < 2 * n) return k * n + (linea - n);
+    if (linea == 2 * n) return k * (n + 1);
+    return (k + 1) * (n - 1);
+}
+
+// Complementos de un dominio respecto de falta: { falta - v : v en d }
+static void complementos(const ConjuntoValores* d, int falta, int celdas, ConjuntoValores* resultado) {
+    conjunto_vacio(resultado);
+    ConjuntoValores resto = *d;
+    for (int v = primer_valor(&resto); v != 0; v = primer_valor(&resto)) {
+        quitar_valor(&resto, v);
+        int otro = falta - v;
+        if (otro >= 1 && otro <= celdas && otro != v) agregar_valor(resultado, otro);
+    }
+}
+
+// Deja en los dominios de las dos celdas vacías de la línea solo los
+// valores cuyo complemento está en el dominio de la otra
+static void recortar_pareja(const FormaCompletado* f, const EstadoCompletado* e, int linea,
+                            ConjuntoValores* dominios) {
+    int vacias[2], num = 0;
+    for (int k = 0; k < f->n && num < 2; k++) {
+        int celda = celda_de_linea(f, linea, k);
+        if (e->valores[celda] == 0) vacias[num++] = celda;
+    }
+
+    int falta = f->suma - e->sumas[linea];
+    ConjuntoValores de_primera, de_segunda;
+    complementos(&dominios[vacias[0]], falta, f->celdas, &de_primera);
+    complementos(&dominios[vacias[1]], falta, f->celdas, &de_segunda);
+    for (int k = 0; k < PALABRAS_CONJUNTO; k++) {
+        dominios[vacias[0]].p[k] &= de_segunda.p[k];
+        dominios[vacias[1]].p[k] &= de_primera.p[k];
+    }
+}
+
+// Aplica las reglas hasta que ninguna ponga otro valor. Devuelve false si
+// el estado no tiene solución; si no, *celda_rama es la celda vacía con
+// menos valores posibles (-1 si el cuadro quedó completo) y *dominio_rama
+// sus valores.
+static bool propagar(const FormaCompletado* f, EstadoCompletado* e, int* celda_rama,
+                     ConjuntoValores* dominio_rama) {
+    ConjuntoValores dominios[MAX_CELDAS_COMPLETADO];
+    int menores[MAX_CELDAS_COMPLETADO + 1];     // Suma de los k libres más chicos
+    int mayores[MAX_CELDAS_COMPLETADO + 1];     // Suma de los k libres más grandes
+
+    for (;;) {
+        int num_libres = 0;
+        menores[0] = 0;
+        for (int v = 1; v <= f->celdas; v++) {
+            if (tiene_valor(&e->libres, v)) {
+                menores[num_libres + 1] = menores[num_libres] + v;
+                num_libres++;
+            }
+        }
+        for (int k = 0; k <= num_libres; k++) mayores[k] = menores[num_libres] - menores[num_libres - k];
+
+        for (int linea = 0; linea < f->num_lineas; linea++) {
+            int falta = f->suma - e->sumas[linea];
+            int k = e->vacias[linea];
+            if (falta < menores[k] || falta > mayores[k]) return false;
+        }
+        if (e->num_vacias == 0) {
+            *celda_rama = -1;
+            return true;
+        }
+
+        // Dominio de cada celda vacía: lo que le falta a cada línea menos
+        // lo que pueden aportar sus otras celdas vacías
+        for (int celda = 0; celda < f->celdas; celda++) {
+            if (e->valores[celda] != 0) continue;
+            ConjuntoValores* d = &dominios[celda];
+            *d = e->libres;
+
+            int lineas[4];
+            int num = lineas_de_celda(f, celda, lineas);
+            for (int m = 0; m < num; m++) {
+                int falta = f->suma - e->sumas[lineas[m]];
+                int otras = e->vacias[lineas[m]] - 1;
+                recortar_rango(d, falta - mayores[otras], falta - menores[otras]);
+            }
+        }
+
+        // En una línea con dos celdas vacías cada valor de una necesita su
+        // complemento en la otra
+        for (int linea = 0; linea < f->num_lineas; linea++) {
+            if (e->vacias[linea] == 2) recortar_pareja(f, e, linea, dominios);
+        }
+
+        ConjuntoValores alguna, varias;
+        conjunto_vacio(&alguna);
+        conjunto_vacio(&varias);
+        int mejor = -1, mejor_cantidad = 0;
+        int forzada = -1;
+
+        for (int celda = 0; celda < f->celdas && forzada < 0; celda++) {
+            if (e->valores[celda] != 0) continue;
+            const ConjuntoValores* d = &dominios[celda];
+
+            int cantidad = contar_valores(d);
+            if (cantidad == 0) return false;
+            if (cantidad == 1) forzada = celda;
+            int lineas[4];
+            int num = lineas_de_celda(f, celda, lineas);
+            int menos_vacias = f->n;
+            for (int m = 0; m < num; m++) {
+                if (e->vacias[lineas[m]] < menos_vacias) menos_vacias = e->vacias[lineas[m]];
+            }
+            int puntaje = menos_vacias * (f->celdas + 1) + cantidad;
+            if (mejor < 0 || puntaje < mejor_cantidad) {
+                mejor = celda;
+                mejor_cantidad = puntaje;
+            }
+            for (int k = 0; k < PALABRAS_CONJUNTO; k++) {
+                varias.p[k] |= alguna.p[k] & d->p[k];
+                alguna.p[k] |= d->p[k];
+            }
+        }
+
+        if (forzada >= 0) {
+            poner_valor(f, e, forzada, primer_valor(&dominios[forzada]));
+            continue;
+        }
+
+        // Hay tantos valores libres como celdas vacías: cada libre tiene
+        // que caber en alguna, y si cabe en una sola va ahí
+        if (!conjuntos_iguales(&alguna, &e->libres)) return false;
+        ConjuntoValores unicos;
+        for (int k = 0; k < PALABRAS_CONJUNTO; k++) unicos.p[k] = alguna.p[k] & ~varias.p[k];
+        int v = primer_valor(&unicos);
+        if (v != 0) {
+            for (int celda = 0; celda < f->celdas; celda++) {
+                if (e->valores[celda] == 0 && tiene_valor(&dominios[celda], v)) {
+                    poner_valor(f, e, celda, v);
+                    break;
+                }
+            }
+            continue;
+        }
+
+        *celda_rama = mejor;
+        *dominio_rama = dominios[mejor];
+        return true;
+    }
+}
+
+// Valor que le vendría mejor a la celda: el promedio de lo que le falta a
+// su línea con menos celdas vacías
+static int valor_ideal(const FormaCompletado* f, const EstadoCompletado* e, int celda) {
+    int lineas[4];
+    int num = lineas_de_celda(f, celda, lineas);
+    int elegida = lineas[0];
+    for (int m = 1; m < num; m++) {
+        if (e->vacias[lineas[m]] < e->vacias[elegida]) elegida = lineas[m];
+    }
+    return (f->suma - e->sumas[elegida]) / e->vacias[elegida];
+}
+
+// Saca del dominio el valor más cercano al ideal (0 si está vacío)
+static int siguiente_valor(ConjuntoValores* dominio, int ideal, int celdas) {
+    for (int distancia = 0; distancia < celdas; distancia++) {
+        int abajo = ideal - distancia, arriba = ideal + distancia;
+        if (abajo >= 1 && abajo <= celdas && tiene_valor(dominio, abajo)) {
+            quitar_valor(dominio, abajo);
+            return abajo;
+        }
+        if (arriba >= 1 && arriba <= celdas && tiene_valor(dominio, arriba)) {
+            quitar_valor(dominio, arriba);
+            return arriba;
+        }
+    }
+    return 0;
+}
+
+// ============= BÚSQUEDA =============
+
+typedef struct {
+    FormaCompletado forma;
+    EstadoCompletado* ramas;
+    int num_ramas;
+    int siguiente_rama;         // Atómico: próxima rama sin tomar
+    double fin_ms;              // Hora límite, 0 = sin límite
+    int encontrado;             // Atómico: algún hilo completó el cuadro
+    int sin_tiempo;             // Atómico: se pasó la hora límite
+    int detener_local;          // Atómico: la búsqueda local debe terminar
+    EstadoCompletado solucion;
+    int fijos[MAX_CELDAS_COMPLETADO];           // Celdas del pedido, 0 = libre
+    int solucion_local[MAX_CELDAS_COMPLETADO];
+} BusquedaCompletado;
+
+typedef struct {
+    BusquedaCompletado* busqueda;
+    long long nodos;
+    pthread_t hilo;
+} TrabajadorCompletado;
+
+static double ahora_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static bool debe_parar(TrabajadorCompletado* t) {
+    BusquedaCompletado* b = t->busqueda;
+    if (__atomic_load_n(&b->encontrado, __ATOMIC_RELAXED) ||
+        __atomic_load_n(&b->sin_tiempo, __ATOMIC_RELAXED)) {
+        return true;
+    }
+    if (b->fin_ms > 0 && t->nodos % PERIODO_RELOJ == 0 && ahora_ms() > b->fin_ms) {
+        __atomic_store_n(&b->sin_tiempo, 1, __ATOMIC_RELAXED);
+        return true;
+    }
+    return false;
+}
+
+// El primer hilo que completa el cuadro deja su solución
+static void registrar_solucion(BusquedaCompletado* b, const EstadoCompletado* e) {
+    int esperado = 0;
+    if (__atomic_compare_exchange_n(&b->encontrado, &esperado, 2, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        b->solucion = *e;
+        __atomic_store_n(&b->encontrado, 1, __ATOMIC_RELEASE);
+    }
+}
+
+// Búsqueda en profundidad; cada hijo es una copia del estado con un valor
+// más, así que volver atrás no deshace nada
+static void completar_rama(TrabajadorCompletado* t, EstadoCompletado* e) {
+    const FormaCompletado* f = &t->busqueda->forma;
+    t->nodos++;
+    if (debe_parar(t)) return;
+
+    int celda;
+    ConjuntoValores dominio;
+    if (!propagar(f, e, &celda, &dominio)) return;
+    if (celda < 0) {
+        registrar_solucion(t->busqueda, e);
+        return;
+    }
+
+    int ideal = valor_ideal(f, e, celda);
+    for (int v = siguiente_valor(&dominio, ideal, f->celdas); v != 0;
+         v = siguiente_valor(&dominio, ideal, f->celdas)) {
+        EstadoCompletado hijo = *e;
+        poner_valor(f, &hijo, celda, v);
+        completar_rama(t, &hijo);
+        if (__atomic_load_n(&t->busqueda->encontrado, __ATOMIC_RELAXED) ||
+            __atomic_load_n(&t->busqueda->sin_tiempo, __ATOMIC_RELAXED)) {
+            return;
+        }
+    }
+}
+
+static void* trabajar_ramas(void* arg) {
+    TrabajadorCompletado* t = (TrabajadorCompletado*)arg;
+    BusquedaCompletado* b = t->busqueda;
+
+    for (;;) {
+        int rama = __atomic_fetch_add(&b->siguiente_rama, 1, __ATOMIC_RELAXED);
+        if (rama >= b->num_ramas || debe_parar(t)) break;
+        completar_rama(t, &b->ramas[rama]);
+    }
+    return NULL;
+}
+
+// Hilo de búsqueda local: corre hasta completar el cuadro o hasta que la
+// búsqueda exacta termine
+static void* completar_localmente(void* arg) {
+    BusquedaCompletado* b = (BusquedaCompletado*)arg;
+    const FormaCompletado* f = &b->forma;
+    uint64_t semilla = (uint64_t)f->n * 0x9E3779B97F4A7C15ull;
+
+    if (completar_por_busqueda_local(f->n, b->fijos, semilla, &b->detener_local, b->solucion_local)) {
+        EstadoCompletado e;
+        memset(&e, 0, sizeof(e));
+        for (int celda = 0; celda < f->celdas; celda++) e.valores[celda] = (uint16_t)b->solucion_local[celda];
+        registrar_solucion(b, &e);
+    }
+    return NULL;
+}
+
+// Abre ramas por niveles hasta tener al menos objetivo. Devuelve false sin
+// memoria; si el cuadro se completa o todas las ramas mueren antes, la
+// lista puede quedar vacía o con menos.
+static bool abrir_ramas(BusquedaCompletado* b, const EstadoCompletado* raiz, int objetivo, long long* nodos) {
+    const FormaCompletado* f = &b->forma;
+    EstadoCompletado* ramas = (EstadoCompletado*)malloc(sizeof(EstadoCompletado));
+    if (!ramas) return false;
+    ramas[0] = *raiz;
+    int num_ramas = 1;
+
+    while (num_ramas > 0 && num_ramas < objetivo) {
+        EstadoCompletado* nuevas = NULL;
+        int num_nuevas = 0, capacidad_nuevas = 0;
+
+        for (int r = 0; r < num_ramas; r++) {
+            int celda;
+            ConjuntoValores dominio;
+            (*nodos)++;
+            if (!propagar(f, &ramas[r], &celda, &dominio)) continue;
+            if (celda < 0) {
+                registrar_solucion(b, &ramas[r]);
+                free(nuevas);
+                free(ramas);
+                b->ramas = NULL;
+                b->num_ramas = 0;
+                return true;
+            }
+
+            for (int v = primer_valor(&dominio); v != 0; v = primer_valor(&dominio)) {
+                quitar_valor(&dominio, v);
+                if (num_nuevas == capacidad_nuevas) {
+                    capacidad_nuevas = capacidad_nuevas ? capacidad_nuevas * 2 : 64;
+                    EstadoCompletado* mas = (EstadoCompletado*)realloc(nuevas, sizeof(EstadoCompletado) * capacidad_nuevas);
+                    if (!mas) {
+                        free(nuevas);
+                        free(ramas);
+                        return false;
+                    }
+                    nuevas = mas;
+                }
+                nuevas[num_nuevas] = ramas[r];
+                poner_valor(f, &nuevas[num_nuevas], celda, v);
+                num_nuevas++;
+            }
+        }
+
+        free(ramas);
+        ramas = nuevas;
+        num_ramas = num_nuevas;
+    }
+
+    b->ramas = ramas;
+    b->num_ramas = num_ramas;
+    return true;
+}
+
+// ============= COMPLETADO =============
+
+const char* nombre_resultado_completado(ResultadoCompletado resultado) {
+    switch (resultado) {
+        case COMPLETADO_ENCONTRADO: return "completado";
+        case COMPLETADO_IMPOSIBLE:  return "sin solución";
+        case COMPLETADO_SIN_TIEMPO: return "sin tiempo";
+        default:                    return "error";
+    }
+}
+
+ResultadoCompletado completar_cuadro_magico(CuadroMagico* cuadro, int num_hilos, double ms_limite,
+                                            EstadisticasCompletado* estadisticas) {
+    double inicio = ahora_ms();
+    EstadisticasCompletado stats = {0, 0, 0};
+    if (!estadisticas) estadisticas = &stats;
+    memset(estadisticas, 0, sizeof(*estadisticas));
+
+    if (!cuadro || !cuadro->matriz || cuadro->modo != CUADRO_MATERIALIZADO ||
+        cuadro->tamaño < 3 || cuadro->tamaño > MAX_ORDEN_COMPLETADO) {
+        return COMPLETADO_ERROR;
+    }
+
+    BusquedaCompletado b;
+    memset(&b, 0, sizeof(b));
+    FormaCompletado* f = &b.forma;
+    f->n = cuadro->tamaño;
+    f->celdas = f->n * f->n;
+    f->num_lineas = 2 * f->n + 2;
+    f->suma = (int)calcular_suma_magica(f->n);
+    b.fin_ms = ms_limite > 0 ? inicio + ms_limite : 0;
+
+    // Estado inicial con las celdas fijas; un valor repetido o fuera de
+    // rango ya prueba que no hay solución
+    EstadoCompletado raiz;
+    memset(&raiz, 0, sizeof(raiz));
+    for (int v = 1; v <= f->celdas; v++) agregar_valor(&raiz.libres, v);
+    for (int linea = 0; linea < f->num_lineas; linea++) raiz.vacias[linea] = (uint8_t)f->n;
+    raiz.num_vacias = f->celdas;
+    for (int celda = 0; celda < f->celdas; celda++) {
+        unsigned long long v = leer_celda(cuadro->matriz, cuadro->ancho, celda);
+        if (v == 0) continue;
+        if (v > (unsigned long long)f->celdas || !tiene_valor(&raiz.libres, (int)v)) {
+            estadisticas->ms = ahora_ms() - inicio;
+            return COMPLETADO_IMPOSIBLE;
+        }
+        poner_valor(f, &raiz, celda, (int)v);
+        b.fijos[celda] = (int)v;
+    }
+
+    if (num_hilos <= 0) num_hilos = hilos_disponibles();
+    long long nodos = 0;
+    if (!abrir_ramas(&b, &raiz, num_hilos > 1 ? num_hilos * RAMAS_POR_HILO : 1, &nodos)) {
+        return COMPLETADO_ERROR;
+    }
+    if (num_hilos > b.num_ramas) num_hilos = b.num_ramas > 0 ? b.num_ramas : 1;
+
+    TrabajadorCompletado* trabajadores =
+        (TrabajadorCompletado*)calloc((size_t)num_hilos, sizeof(TrabajadorCompletado));
+    if (!trabajadores) {
+        free(b.ramas);
+        return COMPLETADO_ERROR;
+    }
+    for (int h = 0; h < num_hilos; h++) trabajadores[h].busqueda = &b;
+
+    // Mientras los hilos recorren las ramas, uno más busca una solución por
+    // búsqueda local moviendo solo las celdas libres: con pocas celdas
+    // fijas suele encontrarla mucho antes, pero no puede probar que no la
+    // haya. Si falla al crearse, queda solo la búsqueda exacta.
+    pthread_t hilo_local;
+    bool con_local = !__atomic_load_n(&b.encontrado, __ATOMIC_ACQUIRE) && b.num_ramas > 0 &&
+                     pthread_create(&hilo_local, NULL, completar_localmente, &b) == 0;
+
+    // El hilo actual hace de trabajador 0
+    int lanzados = 0;
+    for (int h = 1; h < num_hilos; h++) {
+        if (pthread_create(&trabajadores[h].hilo, NULL, trabajar_ramas, &trabajadores[h]) != 0) break;
+        lanzados++;
+    }
+    trabajar_ramas(&trabajadores[0]);
+    for (int h = 1; h <= lanzados; h++) {
+        pthread_join(trabajadores[h].hilo, NULL);
+    }
+    if (con_local) {
+        __atomic_store_n(&b.detener_local, 1, __ATOMIC_RELAXED);
+        pthread_join(hilo_local, NULL);
+    }
+
+    for (int h = 0; h <= lanzados; h++) nodos += trabajadores[h].nodos;
+    estadisticas->nodos = nodos;
+    estadisticas->ramas = b.num_ramas;
+    free(trabajadores);
+    free(b.ramas);
+
+    ResultadoCompletado resultado;
+    if (__atomic_load_n(&b.encontrado, __ATOMIC_ACQUIRE)) {
+        for (int celda = 0; celda < f->celdas; celda++) {
+            escribir_celda(cuadro->matriz, cuadro->ancho, celda, b.solucion.valores[celda]);
+        }
+        cuadro->es_valido = true;
+        resultado = COMPLETADO_ENCONTRADO;
+    } else if (b.sin_tiempo) {
+        resultado = COMPLETADO_SIN_TIEMPO;
+    } else {
+        resultado = COMPLETADO_IMPOSIBLE;
+    }
+    estadisticas->ms = ahora_ms() - inicio;
+    return resultado;
+}
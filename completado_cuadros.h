@@ -0,0 +1,48 @@
+/*
+ * Completado de cuadros mágicos parciales.
+ *
+ * Recibe un cuadro con algunas celdas fijas (las vacías valen 0) y busca
+ * cómo llenar el resto, o demuestra que no se puede. Cada celda vacía
+ * tiene un dominio de valores posibles en un mapa de bits, que se recorta
+ * con las sumas de sus líneas: lo que le falta a una línea con k celdas
+ * vacías tiene que estar entre la suma de los k números libres más chicos
+ * y la de los k más grandes. Las celdas con un solo valor posible y los
+ * valores que solo caben en una celda se ponen sin ramificar. Cuando la
+ * propagación no avanza se ramifica sobre la celda con menos valores.
+ *
+ * Las primeras ramas se abren hasta tener varias por hilo y los hilos las
+ * van tomando; el primero que completa el cuadro detiene a los demás. La
+ * búsqueda tiene un tiempo máximo para poder atender pedidos interactivos.
+ */
+
+#ifndef COMPLETADO_CUADROS_H
+#define COMPLETADO_CUADROS_H
+
+#include <stdbool.h>
+#include "cuadros_magicos.h"
+
+// Orden máximo: los dominios son mapas de n² bits
+#define MAX_ORDEN_COMPLETADO 16
+
+typedef enum {
+    COMPLETADO_ENCONTRADO,      // La matriz quedó llena con una solución
+    COMPLETADO_IMPOSIBLE,       // Se recorrió todo: no hay solución
+    COMPLETADO_SIN_TIEMPO,      // Se acabó el tiempo antes de decidir
+    COMPLETADO_ERROR            // Cuadro no soportado o sin memoria
+} ResultadoCompletado;
+
+typedef struct {
+    long long nodos;            // Estados propagados en toda la búsqueda
+    int ramas;                  // Ramas repartidas entre los hilos
+    double ms;
+} EstadisticasCompletado;
+
+// Completa un cuadro materializado de orden 3 a MAX_ORDEN_COMPLETADO cuyas
+// celdas vacías valen 0. Solo si encuentra solución escribe la matriz (y
+// marca el cuadro como válido). num_hilos <= 0 usa todos los núcleos y
+// ms_limite <= 0 no pone tiempo máximo. estadisticas puede ser NULL.
+ResultadoCompletado completar_cuadro_magico(CuadroMagico* cuadro, int num_hilos, double ms_limite,
+                                            EstadisticasCompletado* estadisticas);
+const char* nombre_resultado_completado(ResultadoCompletado resultado);
+
+#endif // COMPLETADO_CUADROS_H
@@ -1,241 +1,556 @@
+#define _DEFAULT_SOURCE
+#include <string.h>
+#include <sys/mman.h>
 #include "cuadros_magicos.h"
-
-// No incluir movimientos.h aquí para evitar definiciones múltiples
-
-// Declaraciones de las funciones de movimientos.h para que el compilador las conozca
-extern int metodoSiames(int matriz[21][21], int n, int fila, int columna);
-extern int metodoEnL(int matriz[21][21], int n, int fila, int columna);
-extern int metodoLouber(int matriz[21][21], int n, int fila, int columna);
-extern int metodoAlterno(int matriz[21][21], int n, int fila, int columna);
-
-// Implementación del algoritmo de Kurosaka (movimiento noreste con break-move)
-int metodo_kurosaka(int matriz[max][max], int n, int fila, int columna) {
-    // Movimiento noreste: arriba (-1) y derecha (+1)
-    int nuevaFila = (fila - 1 + n) % n;
-    int nuevaColumna = (columna + 1) % n;
-    
-    // Si la celda está ocupada, aplicar break-move (mover hacia abajo)
-    if (matriz[nuevaFila][nuevaColumna] != 0) {
-        nuevaFila = (fila + 1) % n;
-        nuevaColumna = columna;
-    }
-    
-    return nuevaFila * max + nuevaColumna;
-}
+#include "movimientos.h"
+#include "cuadros_pares.h"
+#include "materializacion.h"
+#include "validacion.h"
+#include "salida.h"
 
 // Limpia la matriz inicializándola con ceros
-void limpiar_matriz(int matriz[max][max], int n) {
-    for (int i = 0; i < n; i++) {
-        for (int j = 0; j < n; j++) {
-            matriz[i][j] = 0;
-        }
-    }
+void limpiar_matriz(void* matriz, AnchoCelda ancho, int n) {
+    memset(matriz, 0, (size_t)n * n * ancho);
 }
 
-// Calcula la suma mágica para un cuadro de tamaño n
-int calcular_suma_magica(int n) {
-    return (n * (n * n + 1)) / 2;
-}
-
-// Obtiene la posición de inicio según el algoritmo seleccionado
-void obtener_posicion_inicio(int n, TipoAlgoritmo algoritmo, int* fila, int* columna) {
+// Los recorridos piden n impar; las construcciones pares, su tipo de n par
+bool orden_valido_para_algoritmo(int n, TipoAlgoritmo algoritmo) {
+    if (n < 3 || n > MAX_ORDEN) return false;
     switch (algoritmo) {
+        case ALGORITMO_PAR_DOBLE:  return n % 4 == 0;
+        case ALGORITMO_PAR_SIMPLE: return n % 4 == 2;
         case ALGORITMO_KUROSAKA:
-            // Kurosaka: centro de la primera fila
-            *fila = 0;
-            *columna = n / 2;
-            break;
         case ALGORITMO_SIAMES:
-            // Siamés: centro de la primera fila
-            *fila = 0;
-            *columna = n / 2;
-            break;
         case ALGORITMO_LOUBERE:
-            // De la Loubère: centro de la primera fila
-            *fila = 0;
-            *columna = n / 2;
-            break;
         case ALGORITMO_L:
-            // Método L: centro de la primera fila
-            *fila = 0;
-            *columna = n / 2;
-            break;
-        case ALGORITMO_ALTERNO:
-            // Alterno: centro de la primera fila
-            *fila = 0;
-            *columna = n / 2;
-            break;
-        default:
-            *fila = 0;
-            *columna = n / 2;
-            break;
+        case ALGORITMO_ALTERNO:    return n % 2 == 1;
     }
+    return false;
 }
 
-// Genera un cuadro mágico usando el algoritmo de Kurosaka
-CuadroMagico* generar_kurosaka(int n) {
-    if (n % 2 == 0 || n < 3 || n > max) {
-        return NULL; // Solo para cuadros impares entre 3 y max
+const char* nombre_algoritmo(TipoAlgoritmo algoritmo) {
+    switch (algoritmo) {
+        case ALGORITMO_PAR_DOBLE:  return "par_doble";
+        case ALGORITMO_PAR_SIMPLE: return "par_simple";
+        default:                   return descriptor_de_algoritmo(algoritmo)->nombre;
     }
+}
+
+// El tipo más chico donde cabe el valor más grande, n²
+AnchoCelda ancho_celda_para_orden(int n) {
+    if (n <= 255) return CELDA_16;
+    if (n <= 65535) return CELDA_32;
+    return CELDA_64;
+}
+
+// Calcula la suma mágica para un cuadro de tamaño n
+// (en 64 bits: n(n²+1)/2 desborda un int a partir de n ≈ 1291;
+// MAX_ORDEN garantiza que n(n²+1) cabe en un long long)
+long long calcular_suma_magica(int n) {
+    return ((long long)n * ((long long)n * n + 1)) / 2;
+}
+
+static bool llenado_escribe_todo(int n, TipoAlgoritmo algoritmo);
+
+// Matrices desde este tamaño se piden con mmap, alineadas a 2 MiB y con
+// páginas grandes donde el núcleo las dé: con páginas de 4 KiB los fallos
+// de página cuestan más que escribir las celdas
+#define BYTES_MATRIZ_MAPEADA (64u << 20)
+#define ALINEACION_PAGINA_GRANDE ((size_t)2 << 20)
+
+// Reserva la matriz de un cuadro grande como memoria anónima (ya en cero).
+// La región queda en cuadro->mapeo para que liberar_cuadro_magico la suelte.
+static bool mapear_matriz(CuadroMagico* cuadro, size_t bytes) {
+    size_t total = bytes + ALINEACION_PAGINA_GRANDE;
+    void* region = mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (region == MAP_FAILED) return false;
     
+    char* matriz = (char*)region;
+    matriz += (ALINEACION_PAGINA_GRANDE - ((uintptr_t)matriz & (ALINEACION_PAGINA_GRANDE - 1))) &
+              (ALINEACION_PAGINA_GRANDE - 1);
+#ifdef MADV_HUGEPAGE
+    madvise(matriz, bytes, MADV_HUGEPAGE);
+#endif
+    cuadro->matriz = matriz;
+    cuadro->mapeo = region;
+    cuadro->bytes_mapeo = total;
+    return true;
+}
+
+// Reserva un cuadro materializado con su matriz de n*n celdas, en cero solo
+// si el llenado lo necesita. La matriz no se toca aquí: cada página la toca
+// primero el hilo que la llena.
+static CuadroMagico* reservar_cuadro(int n, TipoAlgoritmo algoritmo) {
     CuadroMagico* cuadro = (CuadroMagico*)malloc(sizeof(CuadroMagico));
     if (!cuadro) return NULL;
     
+    cuadro->ancho = ancho_celda_para_orden(n);
+    cuadro->mapeo = NULL;
+    cuadro->bytes_mapeo = 0;
+    size_t bytes = (size_t)n * n * cuadro->ancho;
+    if (bytes >= BYTES_MATRIZ_MAPEADA) {
+        if (!mapear_matriz(cuadro, bytes)) cuadro->matriz = NULL;
+    } else {
+        cuadro->matriz = llenado_escribe_todo(n, algoritmo) ? malloc(bytes)
+                                                            : calloc((size_t)n * n, cuadro->ancho);
+    }
+    if (!cuadro->matriz) {
+        free(cuadro);
+        return NULL;
+    }
+    
     cuadro->tamaño = n;
     cuadro->suma_magica = calcular_suma_magica(n);
-    limpiar_matriz(cuadro->matriz, n);
-    
-    int fila, columna;
-    obtener_posicion_inicio(n, ALGORITMO_KUROSAKA, &fila, &columna);
-    
-    // Colocar los números del 1 al n²
-    for (int numero = 1; numero <= n * n; numero++) {
-        cuadro->matriz[fila][columna] = numero;
-        
-        if (numero < n * n) { // No calcular siguiente posición para el último número
-            int siguiente_pos = metodo_kurosaka(cuadro->matriz, n, fila, columna);
-            fila = siguiente_pos / max;
-            columna = siguiente_pos % max;
-        }
+    cuadro->modo = CUADRO_MATERIALIZADO;
+    cuadro->algoritmo = algoritmo;
+    cuadro->es_valido = false;
+    return cuadro;
+}
+
+// Obtiene la posición de inicio según el algoritmo seleccionado
+void obtener_posicion_inicio(int n, TipoAlgoritmo algoritmo, int* fila, int* columna) {
+    const DescriptorMovimiento* d = descriptor_de_algoritmo(algoritmo);
+    *fila = d->ancla_fila * (n - 1) / 2;
+    *columna = d->ancla_columna * (n - 1) / 2;
+}
+
+// Obtiene el movimiento principal y el break-move de cada algoritmo
+void obtener_vectores_movimiento(TipoAlgoritmo algoritmo, int* df, int* dc, int* bf, int* bc) {
+    const DescriptorMovimiento* d = descriptor_de_algoritmo(algoritmo);
+    *df = d->df; *dc = d->dc;
+    *bf = d->bf; *bc = d->bc;
+}
+
+// Reduce a al rango [0, n)
+static int modulo_positivo(long long a, int n) {
+    long long r = a % n;
+    return (int)(r < 0 ? r + n : r);
+}
+
+// Inverso de a módulo n con el algoritmo de Euclides extendido, -1 si no existe
+static int inverso_modular(int a, int n) {
+    long long r0 = n, r1 = modulo_positivo(a, n);
+    long long t0 = 0, t1 = 1;
+    while (r1 != 0) {
+        long long q = r0 / r1;
+        long long tmp = r0 - q * r1; r0 = r1; r1 = tmp;
+        tmp = t0 - q * t1; t0 = t1; t1 = tmp;
     }
+    if (r0 != 1) return -1;
+    return modulo_positivo(t0, n);
+}
+
+// Calcula la fórmula cerrada del recorrido con break-move.
+// Cada n pasos el movimiento principal regresa a una celda ocupada, así que el
+// número k = q*n + p (base 0) cae en inicio + q*(b - d) + p*d, con d el
+// movimiento principal y b el break-move. Se invierte ese sistema lineal
+// módulo n; si el determinante no es invertible no hay fórmula.
+static bool calcular_formula_cerrada(int n, TipoAlgoritmo algoritmo, FormulaCerrada* f) {
+    int df, dc, bf, bc, f0, c0;
+    obtener_vectores_movimiento(algoritmo, &df, &dc, &bf, &bc);
+    obtener_posicion_inicio(n, algoritmo, &f0, &c0);
     
-    cuadro->es_valido = validar_cuadro_magico(cuadro);
-    return cuadro;
+    int u = bf - df;
+    int v = bc - dc;
+    int det_inv = inverso_modular(u * dc - df * v, n);
+    if (det_inv < 0) return false;
+    
+    // q = det⁻¹ (dc x - df y),  p = det⁻¹ (u y - v x),  x = i - f0, y = j - c0
+    f->qf = modulo_positivo((long long)det_inv * dc, n);
+    f->qc = modulo_positivo((long long)det_inv * -df, n);
+    f->q0 = modulo_positivo((long long)det_inv * modulo_positivo((long long)df * c0 - (long long)dc * f0, n), n);
+    f->pf = modulo_positivo((long long)det_inv * -v, n);
+    f->pc = modulo_positivo((long long)det_inv * u, n);
+    f->p0 = modulo_positivo((long long)det_inv * modulo_positivo((long long)v * f0 - (long long)u * c0, n), n);
+    return true;
 }
 
-// Crea un cuadro mágico usando el algoritmo especificado
-CuadroMagico* crear_cuadro_magico(int n, TipoAlgoritmo algoritmo) {
-    if (n % 2 == 0 || n < 3 || n > max) {
-        return NULL; // Solo para cuadros impares
+// Crea un cuadro virtual: solo calcula la fórmula, sin reservar la matriz
+// ni recorrer las n² celdas. No se valida al crearlo (es_valido queda en
+// false): quien lo necesite llama a validar_cuadro_magico, y la generación
+// por bandas valida mientras escribe.
+CuadroMagico* crear_cuadro_virtual(int n, TipoAlgoritmo algoritmo) {
+    if (n % 2 == 0 || !orden_valido_para_algoritmo(n, algoritmo)) {
+        return NULL; // Solo los recorridos de orden impar tienen fórmula
     }
     
     CuadroMagico* cuadro = (CuadroMagico*)malloc(sizeof(CuadroMagico));
     if (!cuadro) return NULL;
     
+    if (!calcular_formula_cerrada(n, algoritmo, &cuadro->formula)) {
+        free(cuadro);
+        return NULL;
+    }
+    
+    cuadro->matriz = NULL;
+    cuadro->ancho = ancho_celda_para_orden(n);
+    cuadro->mapeo = NULL;
+    cuadro->bytes_mapeo = 0;
     cuadro->tamaño = n;
     cuadro->suma_magica = calcular_suma_magica(n);
-    limpiar_matriz(cuadro->matriz, n);
+    cuadro->modo = CUADRO_VIRTUAL;
+    cuadro->algoritmo = algoritmo;
+    cuadro->es_valido = false;
+    return cuadro;
+}
+
+// Devuelve el valor de una celda en O(1), sea el cuadro virtual o materializado
+long long celda_cuadro_magico(const CuadroMagico* cuadro, int fila, int columna) {
+    if (cuadro->modo == CUADRO_MATERIALIZADO) {
+        return (long long)leer_celda(cuadro->matriz, cuadro->ancho, (size_t)fila * cuadro->tamaño + columna);
+    }
     
-    int fila, columna;
-    obtener_posicion_inicio(n, algoritmo, &fila, &columna);
+    const FormulaCerrada* f = &cuadro->formula;
+    int n = cuadro->tamaño;
+    long long q = ((long long)f->qf * fila + (long long)f->qc * columna + f->q0) % n;
+    long long p = ((long long)f->pf * fila + (long long)f->pc * columna + f->p0) % n;
+    return q * n + p + 1;
+}
+
+// Recorre una fila virtual avanzando q y p con sus coeficientes, sin
+// divisiones, y escribe cada celda como TIPO (las filas del ancho de la
+// celda usan los kernels de materializacion.h)
+#define DEFINIR_FILA_VIRTUAL(NOMBRE, TIPO)                                   \
+static void NOMBRE(const FormulaCerrada* f, int n, int fila, TIPO* destino) { \
+    int q = (int)(((long long)f->qf * fila + f->q0) % n);                   \
+    int p = (int)(((long long)f->pf * fila + f->p0) % n);                   \
+    for (int j = 0; j < n; j++) {                                           \
+        destino[j] = (TIPO)((long long)q * n + p + 1);                      \
+        q += f->qc;                                                         \
+        if (q >= n) q -= n;                                                 \
+        p += f->pc;                                                         \
+        if (p >= n) p -= n;                                                 \
+    }                                                                       \
+}
+
+DEFINIR_FILA_VIRTUAL(fila_virtual_valores, long long)
+
+// Copia una fila completa en destino (n celdas del ancho del cuadro)
+void obtener_fila_cuadro(const CuadroMagico* cuadro, int fila, void* destino) {
+    int n = cuadro->tamaño;
     
-    // Función de movimiento según el algoritmo
-    int (*funcion_movimiento)(int[max][max], int, int, int) = NULL;
+    if (cuadro->modo == CUADRO_MATERIALIZADO) {
+        memcpy(destino, (const char*)cuadro->matriz + (size_t)fila * n * cuadro->ancho,
+               (size_t)n * cuadro->ancho);
+        return;
+    }
     
-    switch (algoritmo) {
-        case ALGORITMO_KUROSAKA:
-            funcion_movimiento = metodo_kurosaka;
-            break;
-        case ALGORITMO_SIAMES:
-            funcion_movimiento = metodoSiames;
-            break;
-        case ALGORITMO_LOUBERE:
-            funcion_movimiento = metodoLouber;
-            break;
-        case ALGORITMO_L:
-            funcion_movimiento = metodoEnL;
+    // El destino suele ser un buffer que se reutiliza: se escribe por la caché
+    seleccionar_kernel_formula(cuadro->ancho, false)(&cuadro->formula, n, fila, destino);
+}
+
+// Copia una fila completa en destino como n long long, sea cual sea el ancho
+void obtener_fila_valores(const CuadroMagico* cuadro, int fila, long long* destino) {
+    int n = cuadro->tamaño;
+    
+    if (cuadro->modo == CUADRO_VIRTUAL) {
+        fila_virtual_valores(&cuadro->formula, n, fila, destino);
+        return;
+    }
+    
+    size_t inicio = (size_t)fila * n;
+    switch (cuadro->ancho) {
+        case CELDA_16: {
+            const uint16_t* celdas = (const uint16_t*)cuadro->matriz + inicio;
+            for (int j = 0; j < n; j++) destino[j] = celdas[j];
             break;
-        case ALGORITMO_ALTERNO:
-            funcion_movimiento = metodoAlterno;
+        }
+        case CELDA_32: {
+            const uint32_t* celdas = (const uint32_t*)cuadro->matriz + inicio;
+            for (int j = 0; j < n; j++) destino[j] = celdas[j];
             break;
-        default:
-            funcion_movimiento = metodo_kurosaka;
+        }
+        case CELDA_64: {
+            const uint64_t* celdas = (const uint64_t*)cuadro->matriz + inicio;
+            for (int j = 0; j < n; j++) destino[j] = (long long)celdas[j];
             break;
+        }
     }
+}
+
+// Coloca los números del 1 al n² siguiendo el recorrido, con celdas de tipo
+// TIPO, informando el avance cerca de cada 1%. Solo hace falta sin
+// calendario fijo (sin fórmula cerrada): el recorrido consulta la matriz,
+// que debe empezar en cero. Devuelve false si el callback cancela.
+#define DEFINIR_RECORRIDO(NOMBRE, TIPO, AVANZAR)                                     \
+static bool NOMBRE(TIPO* celdas, Recorrido* r, CallbackProgreso progreso, void* datos) { \
+    long long total = (long long)r->n * r->n;                                       \
+    long long paso_progreso = total / 100 > 4096 ? total / 100 : 4096;              \
+    size_t n = (size_t)r->n;                                                        \
+                                                                                    \
+    for (long long numero = 1; numero <= total; ) {                                 \
+        long long fin = numero + paso_progreso - 1;                                 \
+        if (fin > total) fin = total;                                               \
+        for (; numero <= fin; numero++) {                                           \
+            celdas[(size_t)r->fila * n + r->columna] = (TIPO)numero;                \
+            AVANZAR;                                                                \
+        }                                                                           \
+        if (progreso && numero <= total &&                                          \
+            !progreso((double)(numero - 1) / total, datos)) return false;           \
+    }                                                                               \
+    return true;                                                                    \
+}
+
+DEFINIR_RECORRIDO(recorrer_consultando_16, uint16_t, avanzar_recorrido_consultando(r, celdas, CELDA_16))
+DEFINIR_RECORRIDO(recorrer_consultando_32, uint32_t, avanzar_recorrido_consultando(r, celdas, CELDA_32))
+DEFINIR_RECORRIDO(recorrer_consultando_64, uint64_t, avanzar_recorrido_consultando(r, celdas, CELDA_64))
+
+// Llena la matriz del cuadro con el recorrido de su algoritmo, usando el
+// bucle del ancho de celda que le corresponde
+static bool recorrer_cuadro(CuadroMagico* cuadro, CallbackProgreso progreso, void* datos) {
+    Recorrido r;
+    iniciar_recorrido(&r, cuadro->tamaño, descriptor_de_algoritmo(cuadro->algoritmo));
     
-    // Generar el cuadro mágico
-    for (int numero = 1; numero <= n * n; numero++) {
-        cuadro->matriz[fila][columna] = numero;
-        
-        if (numero < n * n) { // No calcular siguiente posición para el último número
-            int siguiente_pos = funcion_movimiento(cuadro->matriz, n, fila, columna);
-            fila = siguiente_pos / max;
-            columna = siguiente_pos % max;
-        }
+    switch (cuadro->ancho) {
+        case CELDA_16: return recorrer_consultando_16((uint16_t*)cuadro->matriz, &r, progreso, datos);
+        case CELDA_32: return recorrer_consultando_32((uint32_t*)cuadro->matriz, &r, progreso, datos);
+        case CELDA_64: return recorrer_consultando_64((uint64_t*)cuadro->matriz, &r, progreso, datos);
     }
+    return false;
+}
+
+// Si el cuadro se llena por filas (construcciones pares y recorridos con
+// calendario fijo, que tienen fórmula cerrada); si hay fórmula queda en f
+static bool llenado_por_filas(int n, TipoAlgoritmo algoritmo, FormulaCerrada* f) {
+    return es_algoritmo_par(algoritmo) || calcular_formula_cerrada(n, algoritmo, f);
+}
+
+// Si llenar la matriz escribe todas sus celdas, sin importar lo que tenga:
+// el llenado por filas lo hace, el recorrido que consulta la matriz no
+static bool llenado_escribe_todo(int n, TipoAlgoritmo algoritmo) {
+    FormulaCerrada f;
+    return llenado_por_filas(n, algoritmo, &f);
+}
+
+// Llena la matriz de un cuadro ya preparado (en cero, salvo que
+// llenado_escribe_todo lo permita), informando el avance. Si cada celda
+// sale de una fórmula, las filas se escriben vectorizadas y en paralelo;
+// si no, se sigue el recorrido. Devuelve false si el callback cancela.
+static bool llenar_cuadro(CuadroMagico* cuadro, CallbackProgreso progreso, void* datos) {
+    bool completo = llenado_por_filas(cuadro->tamaño, cuadro->algoritmo, &cuadro->formula)
+                    ? materializar_por_filas(cuadro, 0, progreso, datos)
+                    : recorrer_cuadro(cuadro, progreso, datos);
+    if (!completo) {
+        return false;
+    }
+    if (progreso) progreso(1.0, datos);
+    return true;
+}
+
+// Genera un cuadro mágico usando el algoritmo de Kurosaka
+CuadroMagico* generar_kurosaka(int n) {
+    if (n % 2 == 0 || n < 3 || n > MAX_ORDEN) {
+        return NULL; // Solo para cuadros impares entre 3 y MAX_ORDEN
+    }
+    
+    CuadroMagico* cuadro = reservar_cuadro(n, ALGORITMO_KUROSAKA);
+    if (!cuadro) return NULL;
+    
+    // Colocar los números del 1 al n²
+    llenar_cuadro(cuadro, NULL, NULL);
     
     cuadro->es_valido = validar_cuadro_magico(cuadro);
     return cuadro;
 }
 
-// Libera la memoria del cuadro mágico
+// Crea un cuadro mágico usando el algoritmo especificado
+CuadroMagico* crear_cuadro_magico(int n, TipoAlgoritmo algoritmo) {
+    CuadroMagico* cuadro = crear_cuadro_magico_con_progreso(n, algoritmo, NULL, NULL);
+    if (cuadro) {
+        cuadro->es_valido = validar_cuadro_magico(cuadro);
+    }
+    return cuadro;
+}
+
+// Crea un cuadro mágico sin validarlo, informando el avance cerca de cada 1%.
+// Si el callback devuelve false la generación se cancela y se devuelve NULL.
+CuadroMagico* crear_cuadro_magico_con_progreso(int n, TipoAlgoritmo algoritmo,
+                                               CallbackProgreso progreso, void* datos) {
+    if (!orden_valido_para_algoritmo(n, algoritmo)) {
+        return NULL;
+    }
+    
+    CuadroMagico* cuadro = reservar_cuadro(n, algoritmo);
+    if (!cuadro) return NULL;
+    
+    // La matriz recién reservada ya está en cero
+    if (!llenar_cuadro(cuadro, progreso, datos)) {
+        liberar_cuadro_magico(cuadro);
+        return NULL;
+    }
+    return cuadro;
+}
+
+// Bytes de celdas que necesita un cuadro de orden n (0 si el orden no es válido)
+size_t bytes_celdas_cuadro(int n) {
+    if (n < 3 || n > MAX_ORDEN) return 0;
+    return (size_t)n * n * ancho_celda_para_orden(n);
+}
+
+// Genera sin reservar memoria: la estructura y las celdas son del llamador.
+// El resultado no se valida y no se debe pasar a liberar_cuadro_magico.
+bool generar_cuadro_en_buffer(CuadroMagico* cuadro, void* celdas, size_t capacidad, int n,
+                              TipoAlgoritmo algoritmo, CallbackProgreso progreso, void* datos) {
+    size_t bytes = bytes_celdas_cuadro(n);
+    if (!cuadro || !celdas || !orden_valido_para_algoritmo(n, algoritmo) || capacidad < bytes) {
+        return false;
+    }
+    
+    if (!llenado_escribe_todo(n, algoritmo)) memset(celdas, 0, bytes);
+    cuadro->matriz = celdas;
+    cuadro->ancho = ancho_celda_para_orden(n);
+    cuadro->tamaño = n;
+    cuadro->suma_magica = calcular_suma_magica(n);
+    cuadro->modo = CUADRO_MATERIALIZADO;
+    cuadro->algoritmo = algoritmo;
+    cuadro->es_valido = false;
+    cuadro->mapeo = NULL;
+    cuadro->bytes_mapeo = 0;
+    return llenar_cuadro(cuadro, progreso, datos);
+}
+
+// Libera la memoria del cuadro mágico (o el mapeo, si se cargó de un
+// archivo o la matriz era grande)
 void liberar_cuadro_magico(CuadroMagico* cuadro) {
     if (cuadro) {
+        if (cuadro->mapeo) {
+            munmap(cuadro->mapeo, cuadro->bytes_mapeo);
+        } else {
+            free(cuadro->matriz);
+        }
         free(cuadro);
     }
 }
 
 // Valida si la suma de una fila es correcta
-bool validar_suma_fila(int matriz[max][max], int n, int fila, int suma_esperada) {
-    int suma = 0;
+bool validar_suma_fila(const void* matriz, AnchoCelda ancho, int n, int fila, long long suma_esperada) {
+    size_t inicio = (size_t)fila * n;
+    long long suma = 0;
     for (int j = 0; j < n; j++) {
-        suma += matriz[fila][j];
+        suma += (long long)leer_celda(matriz, ancho, inicio + j);
     }
     return suma == suma_esperada;
 }
 
 // Valida si la suma de una columna es correcta
-bool validar_suma_columna(int matriz[max][max], int n, int columna, int suma_esperada) {
-    int suma = 0;
+bool validar_suma_columna(const void* matriz, AnchoCelda ancho, int n, int columna, long long suma_esperada) {
+    long long suma = 0;
     for (int i = 0; i < n; i++) {
-        suma += matriz[i][columna];
+        suma += (long long)leer_celda(matriz, ancho, (size_t)i * n + columna);
     }
     return suma == suma_esperada;
 }
 
 // Valida si la suma de la diagonal principal es correcta
-bool validar_suma_diagonal_principal(int matriz[max][max], int n, int suma_esperada) {
-    int suma = 0;
+bool validar_suma_diagonal_principal(const void* matriz, AnchoCelda ancho, int n, long long suma_esperada) {
+    long long suma = 0;
     for (int i = 0; i < n; i++) {
-        suma += matriz[i][i];
+        suma += (long long)leer_celda(matriz, ancho, (size_t)i * n + i);
     }
     return suma == suma_esperada;
 }
 
 // Valida si la suma de la diagonal secundaria es correcta
-bool validar_suma_diagonal_secundaria(int matriz[max][max], int n, int suma_esperada) {
-    int suma = 0;
+bool validar_suma_diagonal_secundaria(const void* matriz, AnchoCelda ancho, int n, long long suma_esperada) {
+    long long suma = 0;
     for (int i = 0; i < n; i++) {
-        suma += matriz[i][n - 1 - i];
+        suma += (long long)leer_celda(matriz, ancho, (size_t)i * n + (n - 1 - i));
     }
     return suma == suma_esperada;
 }
 
-// Valida si el cuadro es realmente mágico
-bool validar_cuadro_magico(CuadroMagico* cuadro) {
+// Fuente de filas de un cuadro virtual: calcula la fila en el buffer
+static const void* fila_de_cuadro_virtual(const void* datos, int n, int fila, void* buffer) {
+    (void)n;
+    obtener_fila_cuadro((const CuadroMagico*)datos, fila, buffer);
+    return buffer;
+}
+
+// Valida con num_hilos hilos (num_hilos <= 0 usa todos los núcleos).
+// Cada hilo toma bandas de filas y todos se detienen en cuanto una línea falla.
+bool validar_cuadro_magico_paralelo(CuadroMagico* cuadro, int num_hilos) {
     if (!cuadro) return false;
     
     int n = cuadro->tamaño;
-    int suma_esperada = cuadro->suma_magica;
-    
-    // Validar todas las filas
-    for (int i = 0; i < n; i++) {
-        if (!validar_suma_fila(cuadro->matriz, n, i, suma_esperada)) {
-            return false;
-        }
+    if (cuadro->modo == CUADRO_VIRTUAL) {
+        return validar_filas(fila_de_cuadro_virtual, cuadro, cuadro->ancho, n, cuadro->suma_magica, num_hilos);
     }
-    
-    // Validar todas las columnas
-    for (int j = 0; j < n; j++) {
-        if (!validar_suma_columna(cuadro->matriz, n, j, suma_esperada)) {
-            return false;
-        }
+    return validar_matriz_paralela(cuadro->matriz, cuadro->ancho, n, cuadro->suma_magica, num_hilos);
+}
+
+// Fuente de filas de un cuadro materializado: sin copias
+static const void* fila_de_cuadro_materializado(const void* datos, int n, int fila, void* buffer) {
+    (void)buffer;
+    const CuadroMagico* cuadro = (const CuadroMagico*)datos;
+    return (const char*)cuadro->matriz + (size_t)fila * n * cuadro->ancho;
+}
+
+// Envuelve otra fuente para contar las filas leídas e informarlas
+typedef struct {
+    FuenteFila fuente;
+    const void* datos_fuente;
+    AnchoCelda ancho;
+    CallbackProgreso progreso;
+    void* datos;
+    int paso;                // Filas entre dos llamadas al callback
+    int filas_leidas;        // Contador atómico: lo comparten todos los hilos
+    int cancelada;
+} FilasConProgreso;
+
+static const void* fila_con_progreso(const void* datos, int n, int fila, void* buffer) {
+    FilasConProgreso* p = (FilasConProgreso*)datos;
+    if (__atomic_load_n(&p->cancelada, __ATOMIC_RELAXED)) {
+        // Una fila de ceros no suma la constante: validar_filas corta enseguida
+        memset(buffer, 0, (size_t)n * p->ancho);
+        return buffer;
     }
-    
-    // Validar diagonal principal
-    if (!validar_suma_diagonal_principal(cuadro->matriz, n, suma_esperada)) {
-        return false;
+    int leidas = __atomic_add_fetch(&p->filas_leidas, 1, __ATOMIC_RELAXED);
+    if (leidas % p->paso == 0 && !p->progreso((double)leidas / n, p->datos)) {
+        __atomic_store_n(&p->cancelada, 1, __ATOMIC_RELAXED);
     }
+    return p->fuente(p->datos_fuente, n, fila, buffer);
+}
+
+// Valida como validar_cuadro_magico, pero leyendo las filas a través de
+// fila_con_progreso
+bool validar_cuadro_magico_con_progreso(CuadroMagico* cuadro, CallbackProgreso progreso, void* datos) {
+    if (!cuadro) return false;
+    if (!progreso) return validar_cuadro_magico(cuadro);
     
-    // Validar diagonal secundaria
-    if (!validar_suma_diagonal_secundaria(cuadro->matriz, n, suma_esperada)) {
-        return false;
-    }
+    int n = cuadro->tamaño;
+    FilasConProgreso p;
+    p.fuente = cuadro->modo == CUADRO_VIRTUAL ? fila_de_cuadro_virtual : fila_de_cuadro_materializado;
+    p.datos_fuente = cuadro;
+    p.ancho = cuadro->ancho;
+    p.progreso = progreso;
+    p.datos = datos;
+    p.paso = n / 100 > 1 ? n / 100 : 1;
+    p.filas_leidas = 0;
+    p.cancelada = 0;
     
-    return true;
+    size_t celdas = (size_t)n * n;
+    int num_hilos = celdas >= UMBRAL_VALIDACION_PARALELA ? 0 : 1;
+    bool valido = validar_filas(fila_con_progreso, &p, cuadro->ancho, n, cuadro->suma_magica, num_hilos);
+    if (p.cancelada) return false;
+    progreso(1.0, datos);
+    return valido;
 }
 
-// Imprime el cuadro mágico en la consola
+// Valida si el cuadro es realmente mágico.
+// Filas, columnas y diagonales se comprueban en una sola pasada por filas
+// (ver validacion.c), en lugar de recorrer cada columna con stride n.
+// A partir de UMBRAL_VALIDACION_PARALELA celdas se usan todos los núcleos.
+bool validar_cuadro_magico(CuadroMagico* cuadro) {
+    if (!cuadro) return false;
+    
+    size_t celdas = (size_t)cuadro->tamaño * cuadro->tamaño;
+    int num_hilos = celdas >= UMBRAL_VALIDACION_PARALELA ? 0 : 1;
+    return validar_cuadro_magico_paralelo(cuadro, num_hilos);
+}
+
+// Imprime el cuadro mágico en la consola.
+// El ancho de columna sale de los dígitos de n² y cada fila se formatea en el
+// buffer del escritor, que se vacía con pocas escrituras grandes.
 void imprimir_cuadro_magico(CuadroMagico* cuadro) {
     if (!cuadro) {
         printf("Cuadro mágico inválido\n");
@@ -244,26 +559,36 @@ void imprimir_cuadro_magico(CuadroMagico* cuadro) {
     
     int n = cuadro->tamaño;
     
-    printf("\nCuadro Mágico %dx%d (Suma mágica: %d)\n", n, n, cuadro->suma_magica);
+    printf("\nCuadro Mágico %dx%d (Suma mágica: %lld)\n", n, n, cuadro->suma_magica);
     printf("Estado: %s\n", cuadro->es_valido ? "VÁLIDO" : "INVÁLIDO");
     printf("─────────────────────────────────\n");
     
-    // Encontrar el ancho máximo para alineación
-    int ancho_max = 0;
-    for (int i = 0; i < n; i++) {
-        for (int j = 0; j < n; j++) {
-            int ancho = snprintf(NULL, 0, "%d", cuadro->matriz[i][j]);
-            if (ancho > ancho_max) ancho_max = ancho;
-        }
+    long long* fila = (long long*)malloc((size_t)n * sizeof(long long));
+    EscritorSalida* escritor = (EscritorSalida*)malloc(sizeof(EscritorSalida));
+    if (!fila || !escritor) {
+        free(fila);
+        free(escritor);
+        printf("Error: No hay memoria para imprimir el cuadro\n");
+        return;
     }
+    escritor_iniciar(escritor, stdout);
+    
+    // El valor más grande es n², así que su ancho sirve para todas las celdas
+    int ancho_max = digitos_decimales((unsigned long long)n * n);
     
     // Imprimir la matriz
     for (int i = 0; i < n; i++) {
-        printf("│ ");
+        obtener_fila_valores(cuadro, i, fila);
+        escritor_texto(escritor, "│ ");
         for (int j = 0; j < n; j++) {
-            printf("%*d ", ancho_max, cuadro->matriz[i][j]);
+            escritor_entero(escritor, (unsigned long long)fila[j], ancho_max);
+            escritor_caracter(escritor, ' ');
         }
-        printf("│\n");
+        escritor_texto(escritor, "│\n");
     }
-    printf("─────────────────────────────────\n\n");
+    escritor_texto(escritor, "─────────────────────────────────\n\n");
+    escritor_vaciar(escritor);
+    
+    free(escritor);
+    free(fila);
 }
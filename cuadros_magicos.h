@@ -4,46 +4,139 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 
-// Definir max aquí para evitar dependencia de movimientos.h
-#define max 21
+// Orden máximo de un cuadro: n(n²+1) debe caber en un long long
+#define MAX_ORDEN 2097151
 
-// Estructura para almacenar información del cuadro mágico
-typedef struct {
-    int matriz[max][max];
-    int tamaño;
-    int suma_magica;
-    bool es_valido;
-} CuadroMagico;
+// Celdas a partir de las cuales validar_cuadro_magico usa varios hilos
+#define UMBRAL_VALIDACION_PARALELA (1u << 22)
 
-// Enumeración para los diferentes algoritmos
+// Enumeración para los diferentes algoritmos. Los recorridos (Kurosaka a
+// Alterno) son para órdenes impares; los de orden par se llenan por filas
+// con fórmulas cerradas.
 typedef enum {
     ALGORITMO_KUROSAKA,
     ALGORITMO_SIAMES,
     ALGORITMO_LOUBERE,
     ALGORITMO_L,
-    ALGORITMO_ALTERNO
+    ALGORITMO_ALTERNO,
+    ALGORITMO_PAR_DOBLE,     // n múltiplo de 4: patrón de complementos
+    ALGORITMO_PAR_SIMPLE     // n = 4m + 2, n >= 6: método LUX de Conway
 } TipoAlgoritmo;
 
+#define NUM_ALGORITMOS (ALGORITMO_PAR_SIMPLE + 1)
+
+// Bytes de cada celda guardada: el tipo más chico donde cabe n²
+typedef enum {
+    CELDA_16 = 2,   // n <= 255
+    CELDA_32 = 4,   // n <= 65535
+    CELDA_64 = 8
+} AnchoCelda;
+
+// Forma en que el cuadro guarda sus celdas
+typedef enum {
+    CUADRO_MATERIALIZADO,   // Las celdas están escritas en la matriz
+    CUADRO_VIRTUAL          // Las celdas se calculan con una fórmula cerrada
+} ModoCuadro;
+
+// Coeficientes de la fórmula cerrada de un cuadro virtual:
+// valor(i, j) = n * q + p + 1, con
+// q = (qf * i + qc * j + q0) mod n  (número de break-moves previos)
+// p = (pf * i + pc * j + p0) mod n  (pasos desde el último break-move)
+typedef struct {
+    int qf, qc, q0;
+    int pf, pc, p0;
+} FormulaCerrada;
+
+// Estructura para almacenar información del cuadro mágico
+typedef struct {
+    void* matriz;            // n*n celdas fila por fila (stride n), NULL si es virtual
+    AnchoCelda ancho;        // Tipo de cada celda de la matriz y de las filas
+    int tamaño;
+    long long suma_magica;
+    bool es_valido;
+    ModoCuadro modo;
+    TipoAlgoritmo algoritmo;
+    FormulaCerrada formula;  // Modo virtual, o llenado por filas de un recorrido
+    void* mapeo;             // Región mapeada (archivo o memoria anónima) con la matriz, o NULL
+    size_t bytes_mapeo;
+} CuadroMagico;
+
+// Recibe la fracción generada (0 a 1); si devuelve false se cancela la generación
+typedef bool (*CallbackProgreso)(double fraccion, void* datos);
+
+// Si el algoritmo sabe construir un cuadro de orden n
+bool orden_valido_para_algoritmo(int n, TipoAlgoritmo algoritmo);
+
+// Nombre corto del algoritmo ("kurosaka", "par_doble", ...)
+const char* nombre_algoritmo(TipoAlgoritmo algoritmo);
+
 // Funciones principales
 CuadroMagico* crear_cuadro_magico(int n, TipoAlgoritmo algoritmo);
+CuadroMagico* crear_cuadro_magico_con_progreso(int n, TipoAlgoritmo algoritmo,
+                                               CallbackProgreso progreso, void* datos);
 void liberar_cuadro_magico(CuadroMagico* cuadro);
+
+// Generación en memoria del llamador: sin reservas, reentrante. celdas debe
+// tener al menos bytes_celdas_cuadro(n) bytes (0 si ningún algoritmo
+// admite el orden); el resultado no se valida y no se libera con
+// liberar_cuadro_magico.
+size_t bytes_celdas_cuadro(int n);
+bool generar_cuadro_en_buffer(CuadroMagico* cuadro, void* celdas, size_t capacidad, int n,
+                              TipoAlgoritmo algoritmo, CallbackProgreso progreso, void* datos);
 bool validar_cuadro_magico(CuadroMagico* cuadro);
+bool validar_cuadro_magico_paralelo(CuadroMagico* cuadro, int num_hilos);
+// El callback recibe la fracción de filas validadas, desde los hilos de
+// validación; si devuelve false se cancela y el resultado es false
+bool validar_cuadro_magico_con_progreso(CuadroMagico* cuadro, CallbackProgreso progreso, void* datos);
 void imprimir_cuadro_magico(CuadroMagico* cuadro);
 
+// Cuadros virtuales: ninguna celda se guarda, cada consulta es O(1).
+// Crearlos es O(1) y no los valida (es_valido queda en false hasta que se
+// llame a validar_cuadro_magico). Solo para los recorridos de orden impar.
+CuadroMagico* crear_cuadro_virtual(int n, TipoAlgoritmo algoritmo);
+long long celda_cuadro_magico(const CuadroMagico* cuadro, int fila, int columna);
+
+// Copia una fila en destino: n celdas del ancho del cuadro, o n long long
+void obtener_fila_cuadro(const CuadroMagico* cuadro, int fila, void* destino);
+void obtener_fila_valores(const CuadroMagico* cuadro, int fila, long long* destino);
+
+// Ancho de celda que usa un cuadro de orden n
+AnchoCelda ancho_celda_para_orden(int n);
+
+// Lee y escribe una celda de una matriz del ancho dado
+static inline unsigned long long leer_celda(const void* matriz, AnchoCelda ancho, size_t indice) {
+    switch (ancho) {
+        case CELDA_16: return ((const uint16_t*)matriz)[indice];
+        case CELDA_64: return ((const uint64_t*)matriz)[indice];
+        default:       return ((const uint32_t*)matriz)[indice];
+    }
+}
+
+static inline void escribir_celda(void* matriz, AnchoCelda ancho, size_t indice, unsigned long long valor) {
+    switch (ancho) {
+        case CELDA_16: ((uint16_t*)matriz)[indice] = (uint16_t)valor; break;
+        case CELDA_64: ((uint64_t*)matriz)[indice] = (uint64_t)valor; break;
+        default:       ((uint32_t*)matriz)[indice] = (uint32_t)valor; break;
+    }
+}
+
 // Implementación del algoritmo de Kurosaka
-int metodo_kurosaka(int matriz[max][max], int n, int fila, int columna);
 CuadroMagico* generar_kurosaka(int n);
 
 // Funciones auxiliares
-void limpiar_matriz(int matriz[max][max], int n);
-int calcular_suma_magica(int n);
-bool validar_suma_fila(int matriz[max][max], int n, int fila, int suma_esperada);
-bool validar_suma_columna(int matriz[max][max], int n, int columna, int suma_esperada);
-bool validar_suma_diagonal_principal(int matriz[max][max], int n, int suma_esperada);
-bool validar_suma_diagonal_secundaria(int matriz[max][max], int n, int suma_esperada);
+void limpiar_matriz(void* matriz, AnchoCelda ancho, int n);
+long long calcular_suma_magica(int n);
+bool validar_suma_fila(const void* matriz, AnchoCelda ancho, int n, int fila, long long suma_esperada);
+bool validar_suma_columna(const void* matriz, AnchoCelda ancho, int n, int columna, long long suma_esperada);
+bool validar_suma_diagonal_principal(const void* matriz, AnchoCelda ancho, int n, long long suma_esperada);
+bool validar_suma_diagonal_secundaria(const void* matriz, AnchoCelda ancho, int n, long long suma_esperada);
 
 // Función para obtener la posición de inicio según el algoritmo
 void obtener_posicion_inicio(int n, TipoAlgoritmo algoritmo, int* fila, int* columna);
 
+// Obtiene el movimiento principal (df, dc) y el break-move (bf, bc) del algoritmo
+void obtener_vectores_movimiento(TipoAlgoritmo algoritmo, int* df, int* dc, int* bf, int* bc);
+
 #endif // CUADROS_MAGICOS_H
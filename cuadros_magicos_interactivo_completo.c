@@ -13,8 +13,15 @@
 #include <stdbool.h>
 #include <time.h>
 #include <math.h>
+#include "lienzo_cuadro.h"
+#include "movimientos.h"
+#include "cuadros_pares.h"
 
-#define MAX_SIZE 21
+#define MAX_SIZE 1001
+#define MAX_SIZE_DETALLE 51    // Más grande: las sumas no se listan línea por línea
+
+// Celda (i, j) de la matriz del cuadro, guardada fila por fila
+#define CELDA(app, i, j) ((app)->matrix[(size_t)(i) * (app)->size + (j)])
 
 // Enumeración de métodos
 typedef enum {
@@ -22,7 +29,8 @@ typedef enum {
     METODO_L = 1,
     METODO_DIAGONAL_PRINCIPAL = 2,
     METODO_DIAGONAL_SECUNDARIA = 3,
-    NUM_METODOS = 4
+    METODO_PAR = 4,             // Construcción cerrada para n par, sin recorrido
+    NUM_METODOS = 5
 } MetodoLlenado;
 
 // Estructura principal de la aplicación
@@ -38,6 +46,10 @@ typedef struct {
     GtkWidget *start_button;
     GtkWidget *step_button;
     GtkWidget *complete_button;
+    GtkWidget *instant_button;
+    GtkWidget *speed_scale;
+    GtkWidget *pause_button;
+    GtkWidget *cancel_button;
     GtkWidget *reset_button;
     
     // Panel de información
@@ -50,8 +62,7 @@ typedef struct {
     
     // Grid del cuadro mágico
     GtkWidget *grid_frame;
-    GtkWidget *magic_grid;
-    GtkWidget *cell_labels[MAX_SIZE][MAX_SIZE];
+    LienzoCuadro *lienzo;
     
     // Panel de sumas parciales
     GtkWidget *sums_frame;
@@ -59,17 +70,36 @@ typedef struct {
     GtkTextBuffer *sums_buffer;
     
     // Estado del cuadro mágico
-    int matrix[MAX_SIZE][MAX_SIZE];
+    int *matrix;             // size*size celdas, fila por fila
     int size;
     int current_number;
     int current_row;
     int current_col;
+    Recorrido recorrido;     // Motor de movimientos del método seleccionado
+    int last_row;            // Celda del último número colocado (-1 si ninguna)
+    int last_col;
     int total_numbers;
     int magic_sum;
+    
+    // Sumas parciales mantenidas en O(1) por número colocado
+    int *row_sums;
+    int *col_sums;
+    int diag1_sum;
+    int diag2_sum;
+    int completed_rows;
+    int completed_cols;
+    int completed_diags;
+    
     bool is_filling;
     bool grid_created;
     MetodoLlenado selected_method;
     
+    // Estado del autocompletado (avanza desde el reloj de cuadros)
+    guint autocomplete_tick_id;
+    gint64 autocomplete_last_time;
+    double autocomplete_pending;   // Fracción de número acumulada
+    bool autocomplete_paused;
+    
     // CSS Provider para estilos
     GtkCssProvider *css_provider;
 } AppData;
@@ -78,121 +108,108 @@ typedef struct {
 static const char* method_descriptions[] = {
     "Método Siamés: Subir y derecha, si ocupado bajar",
     "Método en L: Subir 2 y derecha, si ocupado bajar",
-    "Método Diagonal Principal: Llenado por diagonal principal",
-    "Método Diagonal Secundaria: Llenado por diagonal secundaria"
+    "Método Diagonal Principal: Bajar por la diagonal y seguir por la paralela",
+    "Método Diagonal Secundaria: Bajar por la antidiagonal y seguir por la paralela",
+    "Construcción par: complementos en bloques de 4x4 (n múltiplo de 4) o LUX de Conway"
 };
 
 // ============= FUNCIONES DE MOVIMIENTOS =============
 
-// Método Siamés clásico
-void metodo_siames(AppData *app, int *new_row, int *new_col) {
-    *new_row = (app->current_row - 1 + app->size) % app->size;
-    *new_col = (app->current_col + 1) % app->size;
-    
-    if (app->matrix[*new_row][*new_col] != 0) {
-        *new_row = (app->current_row + 1) % app->size;
-        *new_col = app->current_col;
-    }
-}
+// Llenado por diagonales: baja por una diagonal y al cerrarla pasa a la
+// paralela siguiente (un break-move de dos columnas)
+static const DescriptorMovimiento diagonal_principal = {"diagonal principal", 1, 1, 1, 2, 0, 0};
+static const DescriptorMovimiento diagonal_secundaria = {"diagonal secundaria", 1, -1, 1, -2, 0, 2};
 
+// Descriptor de cada método, en el orden del combo (el método par no recorre)
+static const DescriptorMovimiento* descriptores_metodo[NUM_METODOS] = {
+    [METODO_SIAMES] = &descriptores_algoritmo[ALGORITMO_SIAMES],
+    [METODO_L] = &descriptores_algoritmo[ALGORITMO_L],
+    [METODO_DIAGONAL_PRINCIPAL] = &diagonal_principal,
+    [METODO_DIAGONAL_SECUNDARIA] = &diagonal_secundaria,
+};
 
-// Método en L
-void metodo_l(AppData *app, int *new_row, int *new_col) {
-    *new_row = (app->current_row - 2 + app->size) % app->size;
-    *new_col = (app->current_col + 1) % app->size;
-    
-    if (app->matrix[*new_row][*new_col] != 0) {
-        *new_row = (app->current_row + 1) % app->size;
-        *new_col = app->current_col;
-    }
+// ============= FUNCIONES AUXILIARES =============
+
+// Reservar la matriz y las sumas de filas y columnas (en cero)
+void inicializar_matriz(AppData *app) {
+    g_free(app->matrix);
+    g_free(app->row_sums);
+    g_free(app->col_sums);
+    app->matrix = g_new0(int, (size_t)app->size * app->size);
+    app->row_sums = g_new0(int, app->size);
+    app->col_sums = g_new0(int, app->size);
 }
 
+// Liberar la matriz y las sumas
+void liberar_matriz(AppData *app) {
+    g_free(app->matrix);
+    g_free(app->row_sums);
+    g_free(app->col_sums);
+    app->matrix = NULL;
+    app->row_sums = NULL;
+    app->col_sums = NULL;
+}
 
-// Método Diagonal Principal
-void metodo_diagonal_principal(AppData *app, int *new_row, int *new_col) {
-    // Avanzar por diagonal principal, luego columnas adyacentes
-    int pos = app->current_number - 1;
-    int diag_pos = pos % app->size;
-    int offset = pos / app->size;
-    
-    if (offset == 0) {
-        *new_row = diag_pos;
-        *new_col = diag_pos;
-    } else {
-        int side = (offset - 1) / 2 + 1;
-        bool is_right = ((offset - 1) % 2) == 0;
-        
-        if (is_right) {
-            *new_col = (diag_pos + side) % app->size;
-            *new_row = diag_pos;
-        } else {
-            *new_col = (diag_pos - side + app->size) % app->size;
-            *new_row = diag_pos;
-        }
-    }
+// Construcción par que corresponde al tamaño actual
+static TipoAlgoritmo algoritmo_par(const AppData *app) {
+    return app->size % 4 == 0 ? ALGORITMO_PAR_DOBLE : ALGORITMO_PAR_SIMPLE;
 }
 
-// Método Diagonal Secundaria
-void metodo_diagonal_secundaria(AppData *app, int *new_row, int *new_col) {
-    // Avanzar por diagonal secundaria, luego columnas adyacentes
-    int pos = app->current_number - 1;
-    int diag_pos = pos % app->size;
-    int offset = pos / app->size;
+// Preparar el recorrido del método y su posición inicial
+void obtener_posicion_inicial(AppData *app) {
+    MetodoLlenado metodo = app->selected_method;
+    if ((int)metodo < 0 || metodo >= NUM_METODOS) metodo = METODO_SIAMES;
     
-    if (offset == 0) {
-        *new_row = diag_pos;
-        *new_col = app->size - 1 - diag_pos;
-    } else {
-        int side = (offset - 1) / 2 + 1;
-        bool is_right = ((offset - 1) % 2) == 0;
-        
-        if (is_right) {
-            *new_col = (app->size - 1 - diag_pos + side) % app->size;
-            *new_row = diag_pos;
-        } else {
-            *new_col = (app->size - 1 - diag_pos - side + app->size) % app->size;
-            *new_row = diag_pos;
-        }
+    // El método par calcula la celda de cada número directamente
+    if (metodo == METODO_PAR) {
+        posicion_numero_par(algoritmo_par(app), app->size, 1, &app->current_row, &app->current_col);
+        return;
     }
+    iniciar_recorrido(&app->recorrido, app->size, descriptores_metodo[metodo]);
+    
+    // El método en L empieza en una posición aleatoria
+    if (metodo == METODO_L) {
+        app->recorrido.fila = rand() % app->size;
+        app->recorrido.columna = rand() % app->size;
+    }
+    
+    app->current_row = app->recorrido.fila;
+    app->current_col = app->recorrido.columna;
 }
 
-// ============= FUNCIONES AUXILIARES =============
-
-// Inicializar matriz
-void inicializar_matriz(AppData *app) {
+// Reiniciar las sumas parciales y los contadores de líneas completas
+void reiniciar_sumas_parciales(AppData *app) {
     for (int i = 0; i < app->size; i++) {
-        for (int j = 0; j < app->size; j++) {
-            app->matrix[i][j] = 0;
-        }
+        app->row_sums[i] = 0;
+        app->col_sums[i] = 0;
     }
+    app->diag1_sum = 0;
+    app->diag2_sum = 0;
+    app->completed_rows = 0;
+    app->completed_cols = 0;
+    app->completed_diags = 0;
 }
 
-// Calcular suma mágica
-int calcular_suma_magica(int n) {
-    return n * (n * n + 1) / 2;
+// Sumar delta a una línea manteniendo el contador de líneas completas
+static void sumar_a_linea(int *sum, int delta, int magic_sum, int *completed) {
+    if (*sum == magic_sum) (*completed)--;
+    *sum += delta;
+    if (*sum == magic_sum) (*completed)++;
 }
 
-// Obtener posición inicial aleatoria válida
-void obtener_posicion_inicial(AppData *app) {
-    // Para algunos métodos, usar posiciones específicas optimizadas
-    switch (app->selected_method) {
-        case METODO_SIAMES:
-            app->current_row = 0;
-            app->current_col = app->size / 2;
-            break;
-        case METODO_DIAGONAL_PRINCIPAL:
-            app->current_row = 0;
-            app->current_col = 0;
-            break;
-        case METODO_DIAGONAL_SECUNDARIA:
-            app->current_row = 0;
-            app->current_col = app->size - 1;
-            break;
-        default:
-            // Posición aleatoria para otros métodos
-            app->current_row = rand() % app->size;
-            app->current_col = rand() % app->size;
-            break;
+// Escribir un número en la matriz actualizando solo su fila, su columna
+// y las diagonales que lo contienen (también si la celda ya tenía valor)
+void colocar_numero(AppData *app, int row, int col, int number) {
+    int delta = number - CELDA(app, row, col);
+    CELDA(app, row, col) = number;
+    
+    sumar_a_linea(&app->row_sums[row], delta, app->magic_sum, &app->completed_rows);
+    sumar_a_linea(&app->col_sums[col], delta, app->magic_sum, &app->completed_cols);
+    if (row == col) {
+        sumar_a_linea(&app->diag1_sum, delta, app->magic_sum, &app->completed_diags);
+    }
+    if (row + col == app->size - 1) {
+        sumar_a_linea(&app->diag2_sum, delta, app->magic_sum, &app->completed_diags);
     }
 }
 
@@ -207,13 +224,13 @@ void actualizar_sumas_parciales(AppData *app) {
     g_string_append(text, "           SUMAS PARCIALES\n");
     g_string_append(text, "═══════════════════════════════════\n\n");
     
+    // En cuadros grandes solo se muestran los contadores
+    bool detalle = app->size <= MAX_SIZE_DETALLE;
+    
     // Sumas de filas
-    g_string_append(text, "📋 FILAS:\n");
-    for (int i = 0; i < app->size; i++) {
-        int sum = 0;
-        for (int j = 0; j < app->size; j++) {
-            sum += app->matrix[i][j];
-        }
+    if (detalle) g_string_append(text, "📋 FILAS:\n");
+    for (int i = 0; detalle && i < app->size; i++) {
+        int sum = app->row_sums[i];
         g_string_append_printf(text, "  Fila %2d: %3d", i + 1, sum);
         if (sum == app->magic_sum && sum > 0) {
             g_string_append(text, " ✓ ¡COMPLETA!");
@@ -224,12 +241,9 @@ void actualizar_sumas_parciales(AppData *app) {
     }
     
     // Sumas de columnas
-    g_string_append(text, "\n📋 COLUMNAS:\n");
-    for (int j = 0; j < app->size; j++) {
-        int sum = 0;
-        for (int i = 0; i < app->size; i++) {
-            sum += app->matrix[i][j];
-        }
+    if (detalle) g_string_append(text, "\n📋 COLUMNAS:\n");
+    for (int j = 0; detalle && j < app->size; j++) {
+        int sum = app->col_sums[j];
         g_string_append_printf(text, "  Col. %2d: %3d", j + 1, sum);
         if (sum == app->magic_sum && sum > 0) {
             g_string_append(text, " ✓ ¡COMPLETA!");
@@ -243,10 +257,7 @@ void actualizar_sumas_parciales(AppData *app) {
     g_string_append(text, "\n📋 DIAGONALES:\n");
     
     // Diagonal principal
-    int diag1_sum = 0;
-    for (int i = 0; i < app->size; i++) {
-        diag1_sum += app->matrix[i][i];
-    }
+    int diag1_sum = app->diag1_sum;
     g_string_append_printf(text, "  Principal: %3d", diag1_sum);
     if (diag1_sum == app->magic_sum && diag1_sum > 0) {
         g_string_append(text, " ✓ ¡COMPLETA!");
@@ -256,10 +267,7 @@ void actualizar_sumas_parciales(AppData *app) {
     g_string_append(text, "\n");
     
     // Diagonal secundaria
-    int diag2_sum = 0;
-    for (int i = 0; i < app->size; i++) {
-        diag2_sum += app->matrix[i][app->size - 1 - i];
-    }
+    int diag2_sum = app->diag2_sum;
     g_string_append_printf(text, "  Secundaria: %3d", diag2_sum);
     if (diag2_sum == app->magic_sum && diag2_sum > 0) {
         g_string_append(text, " ✓ ¡COMPLETA!");
@@ -268,30 +276,15 @@ void actualizar_sumas_parciales(AppData *app) {
     }
     g_string_append(text, "\n");
     
-    // Estadísticas
-    int completed_rows = 0, completed_cols = 0;
-    for (int i = 0; i < app->size; i++) {
-        int row_sum = 0, col_sum = 0;
-        for (int j = 0; j < app->size; j++) {
-            row_sum += app->matrix[i][j];
-            col_sum += app->matrix[j][i];
-        }
-        if (row_sum == app->magic_sum) completed_rows++;
-        if (col_sum == app->magic_sum) completed_cols++;
-    }
-    
-    bool diag1_complete = (diag1_sum == app->magic_sum);
-    bool diag2_complete = (diag2_sum == app->magic_sum);
-    
+    // Estadísticas (contadores mantenidos por colocar_numero)
     g_string_append(text, "\n═══════════════════════════════════\n");
     g_string_append_printf(text, "📊 PROGRESO:\n");
-    g_string_append_printf(text, "  Filas completas: %d/%d\n", completed_rows, app->size);
-    g_string_append_printf(text, "  Columnas completas: %d/%d\n", completed_cols, app->size);
-    g_string_append_printf(text, "  Diagonales completas: %d/2\n", 
-                          (diag1_complete ? 1 : 0) + (diag2_complete ? 1 : 0));
+    g_string_append_printf(text, "  Filas completas: %d/%d\n", app->completed_rows, app->size);
+    g_string_append_printf(text, "  Columnas completas: %d/%d\n", app->completed_cols, app->size);
+    g_string_append_printf(text, "  Diagonales completas: %d/2\n", app->completed_diags);
     
-    if (completed_rows == app->size && completed_cols == app->size && 
-        diag1_complete && diag2_complete) {
+    if (app->completed_rows == app->size && app->completed_cols == app->size && 
+        app->completed_diags == 2) {
         g_string_append(text, "\n🎉 ¡CUADRO MÁGICO COMPLETADO! 🎉\n");
         g_string_append(text, "   ¡Todas las sumas son correctas!\n");
     }
@@ -300,35 +293,171 @@ void actualizar_sumas_parciales(AppData *app) {
     g_string_free(text, TRUE);
 }
 
-// Actualizar display del cuadro
+// Calcular el estilo que corresponde a una celda
+static EstiloCeldaLienzo calcular_estilo_celda(AppData *app, int i, int j) {
+    if (CELDA(app, i, j) == 0) {
+        return LIENZO_CELDA_VACIA;
+    }
+    if (app->is_filling && i == app->current_row && j == app->current_col) {
+        return LIENZO_CELDA_ACTUAL;
+    }
+    if (app->is_filling && i == app->last_row && j == app->last_col) {
+        return LIENZO_CELDA_ULTIMA;
+    }
+    return LIENZO_CELDA_LLENA;
+}
+
+// Fuente de celdas del lienzo: valor y estilo salen del estado del llenado
+static int celda_para_lienzo(const void *datos, int fila, int columna, EstiloCeldaLienzo *estilo) {
+    AppData *app = (AppData*)datos;
+    *estilo = calcular_estilo_celda(app, fila, columna);
+    return CELDA(app, fila, columna);
+}
+
+// Refrescar una celda: el lienzo solo vuelve a pintar su rectángulo
+static void refrescar_celda(AppData *app, int i, int j) {
+    lienzo_redibujar_celda(app->lienzo, i, j);
+}
+
+// Actualizar display del cuadro completo
 void actualizar_display_cuadro(AppData *app) {
     if (!app->grid_created) return;
     
-    for (int i = 0; i < app->size; i++) {
-        for (int j = 0; j < app->size; j++) {
-            if (app->cell_labels[i][j]) {
-                if (app->matrix[i][j] == 0) {
-                    gtk_label_set_text(GTK_LABEL(app->cell_labels[i][j]), "");
-                    gtk_widget_set_name(app->cell_labels[i][j], "empty-cell");
-                } else {
-                    char text[10];
-                    snprintf(text, sizeof(text), "%d", app->matrix[i][j]);
-                    gtk_label_set_text(GTK_LABEL(app->cell_labels[i][j]), text);
-                    
-                    // Resaltar celda actual
-                    if (i == app->current_row && j == app->current_col && app->is_filling) {
-                        gtk_widget_set_name(app->cell_labels[i][j], "current-cell");
-                    } else if (app->matrix[i][j] == app->current_number - 1 && app->is_filling) {
-                        gtk_widget_set_name(app->cell_labels[i][j], "last-cell");
-                    } else {
-                        gtk_widget_set_name(app->cell_labels[i][j], "filled-cell");
-                    }
-                }
-            }
-        }
+    lienzo_redibujar(app->lienzo);
+    actualizar_sumas_parciales(app);
+}
+
+// ============= AVANCE DEL LLENADO =============
+
+// Colocar el número actual y calcular la siguiente posición.
+// Solo modifica el estado; los widgets se refrescan aparte.
+static void colocar_siguiente_numero(AppData *app) {
+    colocar_numero(app, app->current_row, app->current_col, app->current_number);
+    app->last_row = app->current_row;
+    app->last_col = app->current_col;
+    
+    // Verificar si terminamos
+    if (app->current_number >= app->total_numbers) {
+        app->is_filling = FALSE;
+        return;
     }
     
+    // Calcular siguiente posición (la matriz es de int, celdas de 32 bits)
+    if (app->selected_method == METODO_PAR) {
+        posicion_numero_par(algoritmo_par(app), app->size, app->current_number + 1,
+                            &app->current_row, &app->current_col);
+    } else {
+        avanzar_recorrido(&app->recorrido, app->matrix, CELDA_32);
+        app->current_row = app->recorrido.fila;
+        app->current_col = app->recorrido.columna;
+    }
+    app->current_number++;
+}
+
+// Avanzar un número refrescando solo las celdas que cambian: la que tenía
+// el resaltado de "último", la recién llenada y la nueva posición actual
+static void avanzar_y_refrescar(AppData *app) {
+    int prev_last_row = app->last_row;
+    int prev_last_col = app->last_col;
+    
+    colocar_siguiente_numero(app);
+    
+    refrescar_celda(app, prev_last_row, prev_last_col);
+    refrescar_celda(app, app->last_row, app->last_col);
+    if (app->is_filling) {
+        refrescar_celda(app, app->current_row, app->current_col);
+    }
+}
+
+// Actualizar las etiquetas de progreso, próximo número y posición
+static void actualizar_etiquetas_llenado(AppData *app) {
+    if (!app->is_filling) {
+        gtk_widget_set_sensitive(app->step_button, FALSE);
+        gtk_widget_set_sensitive(app->complete_button, FALSE);
+        gtk_widget_set_sensitive(app->instant_button, FALSE);
+        
+        gtk_label_set_markup(GTK_LABEL(app->current_number_label), 
+                            "<span size='x-large' color='green'><b>¡COMPLETADO!</b></span>");
+        
+        gtk_label_set_text(GTK_LABEL(app->progress_label), 
+                          "🎉 ¡Cuadro mágico completado exitosamente!");
+        return;
+    }
+    
+    char text[200];
+    int placed = app->current_number - 1;
+    snprintf(text, sizeof(text), "Números colocados: %d/%d (%.1f%%)", 
+             placed, app->total_numbers, 
+             (placed * 100.0) / app->total_numbers);
+    gtk_label_set_text(GTK_LABEL(app->progress_label), text);
+    
+    snprintf(text, sizeof(text), "<span size='large' color='blue'><b>Próximo número: %d</b></span>", 
+             app->current_number);
+    gtk_label_set_markup(GTK_LABEL(app->current_number_label), text);
+    
+    snprintf(text, sizeof(text), "Próxima posición: (%d, %d)", 
+             app->current_row + 1, app->current_col + 1);
+    gtk_label_set_text(GTK_LABEL(app->position_label), text);
+}
+
+// ============= AUTOCOMPLETADO =============
+
+// Quitar el autocompletado del reloj de cuadros y restaurar los controles
+static void detener_autocompletado(AppData *app) {
+    if (app->autocomplete_tick_id) {
+        gtk_widget_remove_tick_callback(app->main_window, app->autocomplete_tick_id);
+        app->autocomplete_tick_id = 0;
+    }
+    app->autocomplete_paused = FALSE;
+    
+    gtk_button_set_label(GTK_BUTTON(app->pause_button), "⏸️ Pausar");
+    gtk_widget_set_sensitive(app->pause_button, FALSE);
+    gtk_widget_set_sensitive(app->cancel_button, FALSE);
+    gtk_widget_set_sensitive(app->step_button, app->is_filling);
+    gtk_widget_set_sensitive(app->complete_button, app->is_filling);
+    gtk_widget_set_sensitive(app->instant_button, app->is_filling);
+}
+
+// Se ejecuta una vez por cuadro: coloca tantos números como correspondan a
+// la velocidad y al tiempo transcurrido, y redibuja una sola vez
+static gboolean tick_autocompletar(GtkWidget *widget, GdkFrameClock *clock, gpointer data) {
+    AppData *app = (AppData*)data;
+    gint64 now = gdk_frame_clock_get_frame_time(clock);
+    
+    if (app->autocomplete_last_time == 0 || app->autocomplete_paused) {
+        app->autocomplete_last_time = now;
+        return G_SOURCE_CONTINUE;
+    }
+    
+    double elapsed = (double)(now - app->autocomplete_last_time) / G_USEC_PER_SEC;
+    app->autocomplete_last_time = now;
+    
+    // Números por segundo; a más de ~60 se colocan varios por cuadro
+    double speed = gtk_range_get_value(GTK_RANGE(app->speed_scale));
+    app->autocomplete_pending += elapsed * speed;
+    
+    // Tras un bloqueo largo de la ventana no recuperar más de medio segundo
+    if (app->autocomplete_pending > speed / 2 + 1) {
+        app->autocomplete_pending = speed / 2 + 1;
+    }
+    
+    int count = (int)app->autocomplete_pending;
+    if (count == 0) return G_SOURCE_CONTINUE;
+    app->autocomplete_pending -= count;
+    
+    for (int i = 0; i < count && app->is_filling; i++) {
+        avanzar_y_refrescar(app);
+    }
     actualizar_sumas_parciales(app);
+    actualizar_etiquetas_llenado(app);
+    
+    if (!app->is_filling) {
+        // GTK quita el callback al devolver G_SOURCE_REMOVE
+        app->autocomplete_tick_id = 0;
+        detener_autocompletado(app);
+        return G_SOURCE_REMOVE;
+    }
+    return G_SOURCE_CONTINUE;
 }
 
 // ============= CALLBACKS =============
@@ -337,45 +466,26 @@ void actualizar_display_cuadro(AppData *app) {
 void on_create_button_clicked(GtkButton *button, AppData *app) {
     app->size = (int)gtk_spin_button_get_value(GTK_SPIN_BUTTON(app->size_spin));
     
-    // Asegurar que sea impar
+    // Los recorridos solo sirven para n impar: con n par se propone el método par
+    int metodo = gtk_combo_box_get_active(GTK_COMBO_BOX(app->method_combo));
     if (app->size % 2 == 0) {
-        app->size++;
-        gtk_spin_button_set_value(GTK_SPIN_BUTTON(app->size_spin), app->size);
-    }
-    
-    // Limpiar grid anterior
-    if (app->grid_created) {
-        gtk_container_foreach(GTK_CONTAINER(app->magic_grid), 
-                             (GtkCallback)gtk_widget_destroy, NULL);
+        gtk_combo_box_set_active(GTK_COMBO_BOX(app->method_combo), METODO_PAR);
+    } else if (metodo == METODO_PAR) {
+        gtk_combo_box_set_active(GTK_COMBO_BOX(app->method_combo), METODO_SIAMES);
     }
     
     // Calcular suma mágica
-    app->magic_sum = calcular_suma_magica(app->size);
+    app->magic_sum = (int)calcular_suma_magica(app->size);
     app->total_numbers = app->size * app->size;
     
-    // Crear nuevas celdas
-    for (int i = 0; i < app->size; i++) {
-        for (int j = 0; j < app->size; j++) {
-            GtkWidget *event_box = gtk_event_box_new();
-            app->cell_labels[i][j] = gtk_label_new("");
-            
-            // Configurar tamaño y estilo
-            int cell_size = MAX(40, 300 / app->size);
-            gtk_widget_set_size_request(event_box, cell_size, cell_size);
-            gtk_widget_set_name(app->cell_labels[i][j], "empty-cell");
-            
-            // Agregar borde visual
-            gtk_widget_set_name(event_box, "cell-container");
-            
-            gtk_container_add(GTK_CONTAINER(event_box), app->cell_labels[i][j]);
-            gtk_grid_attach(GTK_GRID(app->magic_grid), event_box, j, i, 1, 1);
-        }
-    }
-    
     inicializar_matriz(app);
+    reiniciar_sumas_parciales(app);
+    lienzo_mostrar_cuadro(app->lienzo, app->size, celda_para_lienzo, app);
     app->grid_created = TRUE;
     app->is_filling = FALSE;
     app->current_number = 1;
+    app->last_row = -1;
+    app->last_col = -1;
     
     // Actualizar información
     char text[200];
@@ -387,8 +497,6 @@ void on_create_button_clicked(GtkButton *button, AppData *app) {
              app->size, app->size);
     gtk_label_set_text(GTK_LABEL(app->progress_label), text);
     
-    gtk_widget_show_all(app->magic_grid);
-    
     // Habilitar controles
     gtk_widget_set_sensitive(app->method_combo, TRUE);
     gtk_widget_set_sensitive(app->start_button, TRUE);
@@ -401,8 +509,17 @@ void on_create_button_clicked(GtkButton *button, AppData *app) {
 void on_start_button_clicked(GtkButton *button, AppData *app) {
     app->selected_method = gtk_combo_box_get_active(GTK_COMBO_BOX(app->method_combo));
     
+    if ((app->size % 2 == 0) != (app->selected_method == METODO_PAR)) {
+        gtk_label_set_text(GTK_LABEL(app->progress_label),
+                          app->size % 2 == 0 ? "Para un tamaño par use la construcción par"
+                                             : "La construcción par necesita un tamaño par");
+        return;
+    }
+    
     obtener_posicion_inicial(app);
     app->current_number = 1;
+    app->last_row = -1;
+    app->last_col = -1;
     app->is_filling = TRUE;
     
     // Actualizar información
@@ -421,6 +538,7 @@ void on_start_button_clicked(GtkButton *button, AppData *app) {
     // Habilitar/deshabilitar controles
     gtk_widget_set_sensitive(app->step_button, TRUE);
     gtk_widget_set_sensitive(app->complete_button, TRUE);
+    gtk_widget_set_sensitive(app->instant_button, TRUE);
     gtk_widget_set_sensitive(app->start_button, FALSE);
     gtk_widget_set_sensitive(app->method_combo, FALSE);
     
@@ -431,93 +549,67 @@ void on_start_button_clicked(GtkButton *button, AppData *app) {
 void on_step_button_clicked(GtkButton *button, AppData *app) {
     if (!app->is_filling) return;
     
-    // Colocar número actual
-    app->matrix[app->current_row][app->current_col] = app->current_number;
-    
-    // Actualizar progreso
-    char text[200];
-    snprintf(text, sizeof(text), "Números colocados: %d/%d (%.1f%%)", 
-             app->current_number, app->total_numbers, 
-             (app->current_number * 100.0) / app->total_numbers);
-    gtk_label_set_text(GTK_LABEL(app->progress_label), text);
+    avanzar_y_refrescar(app);
+    lienzo_mostrar_celda(app->lienzo, app->last_row, app->last_col);
+    actualizar_sumas_parciales(app);
+    actualizar_etiquetas_llenado(app);
+}
+
+// Completar automáticamente sin bloquear la interfaz: el llenado avanza
+// desde el reloj de cuadros a la velocidad elegida
+void on_complete_button_clicked(GtkButton *button, AppData *app) {
+    if (!app->is_filling || app->autocomplete_tick_id) return;
     
-    // Verificar si terminamos
-    if (app->current_number >= app->total_numbers) {
-        app->is_filling = FALSE;
-        gtk_widget_set_sensitive(app->step_button, FALSE);
-        gtk_widget_set_sensitive(app->complete_button, FALSE);
-        
-        gtk_label_set_markup(GTK_LABEL(app->current_number_label), 
-                            "<span size='x-large' color='green'><b>¡COMPLETADO!</b></span>");
-        
-        gtk_label_set_text(GTK_LABEL(app->progress_label), 
-                          "🎉 ¡Cuadro mágico completado exitosamente!");
-        
-        actualizar_display_cuadro(app);
-        return;
-    }
+    gtk_widget_set_sensitive(app->step_button, FALSE);
+    gtk_widget_set_sensitive(app->complete_button, FALSE);
+    gtk_widget_set_sensitive(app->pause_button, TRUE);
+    gtk_widget_set_sensitive(app->cancel_button, TRUE);
+    
+    app->autocomplete_paused = FALSE;
+    app->autocomplete_pending = 0;
+    app->autocomplete_last_time = 0;
+    app->autocomplete_tick_id = gtk_widget_add_tick_callback(app->main_window,
+                                                             tick_autocompletar, app, NULL);
+}
+
+// Llenar al instante: se completa el estado y se dibuja una sola vez
+void on_instant_button_clicked(GtkButton *button, AppData *app) {
+    if (!app->is_filling) return;
     
-    // Calcular siguiente posición
-    int new_row, new_col;
-    switch (app->selected_method) {
-        case METODO_SIAMES:
-            metodo_siames(app, &new_row, &new_col);
-            break;
-        case METODO_L:
-            metodo_l(app, &new_row, &new_col);
-            break;
-        case METODO_DIAGONAL_PRINCIPAL:
-            metodo_diagonal_principal(app, &new_row, &new_col);
-            break;
-        case METODO_DIAGONAL_SECUNDARIA:
-            metodo_diagonal_secundaria(app, &new_row, &new_col);
-            break;
-        default:
-            metodo_siames(app, &new_row, &new_col);
-            break;
+    while (app->is_filling) {
+        colocar_siguiente_numero(app);
     }
     
-    app->current_row = new_row;
-    app->current_col = new_col;
-    app->current_number++;
-    
-    // Actualizar información
-    snprintf(text, sizeof(text), "<span size='large' color='blue'><b>Próximo número: %d</b></span>", 
-             app->current_number);
-    gtk_label_set_markup(GTK_LABEL(app->current_number_label), text);
-    
-    snprintf(text, sizeof(text), "Próxima posición: (%d, %d)", 
-             app->current_row + 1, app->current_col + 1);
-    gtk_label_set_text(GTK_LABEL(app->position_label), text);
-    
+    detener_autocompletado(app);
     actualizar_display_cuadro(app);
+    actualizar_etiquetas_llenado(app);
 }
 
-// Completar automáticamente
-void on_complete_button_clicked(GtkButton *button, AppData *app) {
-    gtk_widget_set_sensitive(app->step_button, FALSE);
-    gtk_widget_set_sensitive(app->complete_button, FALSE);
+// Pausar o reanudar el autocompletado
+void on_pause_button_clicked(GtkButton *button, AppData *app) {
+    if (!app->autocomplete_tick_id) return;
     
-    while (app->is_filling && app->current_number <= app->total_numbers) {
-        on_step_button_clicked(NULL, app);
-        
-        // Pequeña pausa para visualización
-        while (gtk_events_pending()) {
-            gtk_main_iteration();
-        }
-        g_usleep(50000); // 50ms
-    }
+    app->autocomplete_paused = !app->autocomplete_paused;
+    gtk_button_set_label(GTK_BUTTON(app->pause_button), 
+                        app->autocomplete_paused ? "▶️ Reanudar" : "⏸️ Pausar");
+}
+
+// Cancelar el autocompletado; el llenado puede seguir paso a paso
+void on_cancel_button_clicked(GtkButton *button, AppData *app) {
+    detener_autocompletado(app);
 }
 
 // Reiniciar
 void on_reset_button_clicked(GtkButton *button, AppData *app) {
+    app->is_filling = FALSE;
+    detener_autocompletado(app);
+    
     if (app->grid_created) {
-        gtk_container_foreach(GTK_CONTAINER(app->magic_grid), 
-                             (GtkCallback)gtk_widget_destroy, NULL);
+        lienzo_limpiar(app->lienzo);
+        liberar_matriz(app);
         app->grid_created = FALSE;
     }
     
-    app->is_filling = FALSE;
     app->current_number = 1;
     
     // Resetear controles
@@ -554,37 +646,6 @@ int main(int argc, char *argv[]) {
     // ===== CREAR ESTILOS CSS =====
     app->css_provider = gtk_css_provider_new();
     const char *css_data = 
-        "/* Estilos para celdas del cuadro mágico */"
-        ".cell-container {"
-        "    border: 2px solid #333333;"
-        "    border-radius: 4px;"
-        "    margin: 1px;"
-        "}"
-        "label#empty-cell {"
-        "    background-color: #f5f5f5;"
-        "    color: #888888;"
-        "    font-size: 14px;"
-        "    font-weight: bold;"
-        "}"
-        "label#filled-cell {"
-        "    background-color: #e3f2fd;"
-        "    color: #1976d2;"
-        "    font-size: 16px;"
-        "    font-weight: bold;"
-        "}"
-        "label#current-cell {"
-        "    background-color: #ffeb3b;"
-        "    color: #f57f17;"
-        "    font-size: 18px;"
-        "    font-weight: bold;"
-        "    border: 2px solid #ff9800;"
-        "}"
-        "label#last-cell {"
-        "    background-color: #c8e6c9;"
-        "    color: #388e3c;"
-        "    font-size: 16px;"
-        "    font-weight: bold;"
-        "}"
         "/* Estilos para frames */"
         "frame {"
         "    border-radius: 8px;"
@@ -646,10 +707,12 @@ int main(int argc, char *argv[]) {
     GtkWidget *size_hbox = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 10);
     gtk_box_pack_start(GTK_BOX(controls_vbox), size_hbox, FALSE, FALSE, 0);
     
-    GtkWidget *size_label = gtk_label_new("Tamaño del cuadro (impar, 3-21):");
+    char size_text[64];
+    snprintf(size_text, sizeof(size_text), "Tamaño del cuadro (3-%d):", MAX_SIZE);
+    GtkWidget *size_label = gtk_label_new(size_text);
     gtk_box_pack_start(GTK_BOX(size_hbox), size_label, FALSE, FALSE, 0);
     
-    app->size_spin = gtk_spin_button_new_with_range(3, 21, 2);
+    app->size_spin = gtk_spin_button_new_with_range(3, MAX_SIZE, 1);
     gtk_spin_button_set_value(GTK_SPIN_BUTTON(app->size_spin), 5);
     gtk_box_pack_start(GTK_BOX(size_hbox), app->size_spin, FALSE, FALSE, 0);
     
@@ -665,6 +728,7 @@ int main(int argc, char *argv[]) {
     gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(app->method_combo), "📐 Método en L");
     gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(app->method_combo), "📍 Diagonal Principal");
     gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(app->method_combo), "📍 Diagonal Secundaria");
+    gtk_combo_box_text_append_text(GTK_COMBO_BOX_TEXT(app->method_combo), "🧩 Construcción par");
     gtk_combo_box_set_active(GTK_COMBO_BOX(app->method_combo), 0);
     gtk_widget_set_sensitive(app->method_combo, FALSE);
     gtk_box_pack_start(GTK_BOX(controls_vbox), app->method_combo, FALSE, FALSE, 0);
@@ -689,6 +753,29 @@ int main(int argc, char *argv[]) {
     gtk_widget_set_sensitive(app->complete_button, FALSE);
     gtk_box_pack_start(GTK_BOX(filling_vbox), app->complete_button, FALSE, FALSE, 0);
     
+    // Velocidad del autocompletado en números por segundo
+    GtkWidget *speed_label = gtk_label_new("Velocidad (números/segundo):");
+    gtk_box_pack_start(GTK_BOX(filling_vbox), speed_label, FALSE, FALSE, 0);
+    
+    app->speed_scale = gtk_scale_new_with_range(GTK_ORIENTATION_HORIZONTAL, 1, 2000, 1);
+    gtk_range_set_value(GTK_RANGE(app->speed_scale), 20);
+    gtk_box_pack_start(GTK_BOX(filling_vbox), app->speed_scale, FALSE, FALSE, 0);
+    
+    GtkWidget *autocomplete_hbox = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 10);
+    gtk_box_pack_start(GTK_BOX(filling_vbox), autocomplete_hbox, FALSE, FALSE, 0);
+    
+    app->pause_button = gtk_button_new_with_label("⏸️ Pausar");
+    gtk_widget_set_sensitive(app->pause_button, FALSE);
+    gtk_box_pack_start(GTK_BOX(autocomplete_hbox), app->pause_button, TRUE, TRUE, 0);
+    
+    app->cancel_button = gtk_button_new_with_label("⏹️ Cancelar");
+    gtk_widget_set_sensitive(app->cancel_button, FALSE);
+    gtk_box_pack_start(GTK_BOX(autocomplete_hbox), app->cancel_button, TRUE, TRUE, 0);
+    
+    app->instant_button = gtk_button_new_with_label("⏭️ Llenar al Instante");
+    gtk_widget_set_sensitive(app->instant_button, FALSE);
+    gtk_box_pack_start(GTK_BOX(filling_vbox), app->instant_button, FALSE, FALSE, 0);
+    
     app->reset_button = gtk_button_new_with_label("🔄 Reiniciar Todo");
     gtk_box_pack_start(GTK_BOX(filling_vbox), app->reset_button, FALSE, FALSE, 0);
     
@@ -726,19 +813,9 @@ int main(int argc, char *argv[]) {
     app->grid_frame = gtk_frame_new("🎯 Cuadro Mágico");
     gtk_box_pack_start(GTK_BOX(right_vbox), app->grid_frame, TRUE, TRUE, 0);
     
-    GtkWidget *grid_scroll = gtk_scrolled_window_new(NULL, NULL);
-    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(grid_scroll), 
-                                   GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
-    gtk_container_add(GTK_CONTAINER(app->grid_frame), grid_scroll);
-    
-    app->magic_grid = gtk_grid_new();
-    gtk_grid_set_row_homogeneous(GTK_GRID(app->magic_grid), TRUE);
-    gtk_grid_set_column_homogeneous(GTK_GRID(app->magic_grid), TRUE);
-    gtk_grid_set_row_spacing(GTK_GRID(app->magic_grid), 2);
-    gtk_grid_set_column_spacing(GTK_GRID(app->magic_grid), 2);
-    gtk_widget_set_halign(app->magic_grid, GTK_ALIGN_CENTER);
-    gtk_widget_set_valign(app->magic_grid, GTK_ALIGN_CENTER);
-    gtk_container_add(GTK_CONTAINER(grid_scroll), app->magic_grid);
+    // Lienzo con desplazamiento y zoom (Ctrl+rueda)
+    app->lienzo = crear_lienzo_cuadro();
+    gtk_container_add(GTK_CONTAINER(app->grid_frame), widget_lienzo_cuadro(app->lienzo));
     
     // Frame de sumas parciales
     app->sums_frame = gtk_frame_new("📈 Sumas Parciales en Tiempo Real");
@@ -784,11 +861,16 @@ int main(int argc, char *argv[]) {
     g_signal_connect(app->start_button, "clicked", G_CALLBACK(on_start_button_clicked), app);
     g_signal_connect(app->step_button, "clicked", G_CALLBACK(on_step_button_clicked), app);
     g_signal_connect(app->complete_button, "clicked", G_CALLBACK(on_complete_button_clicked), app);
+    g_signal_connect(app->instant_button, "clicked", G_CALLBACK(on_instant_button_clicked), app);
+    g_signal_connect(app->pause_button, "clicked", G_CALLBACK(on_pause_button_clicked), app);
+    g_signal_connect(app->cancel_button, "clicked", G_CALLBACK(on_cancel_button_clicked), app);
     g_signal_connect(app->reset_button, "clicked", G_CALLBACK(on_reset_button_clicked), app);
     
     // ===== INICIALIZAR =====
     app->grid_created = FALSE;
     app->is_filling = FALSE;
+    app->last_row = -1;
+    app->last_col = -1;
     
     gtk_text_buffer_set_text(app->sums_buffer, 
                             "Crea un cuadro mágico para ver las sumas parciales en tiempo real...", -1);
@@ -800,6 +882,7 @@ int main(int argc, char *argv[]) {
     gtk_main();
     
     // Limpiar
+    liberar_matriz(app);
     g_object_unref(app->css_provider);
     g_free(app);
     
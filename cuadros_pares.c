@@ -0,0 +1,158 @@
+/*
+ * Construcciones de orden par, fila por fila
+ */
+
+#include "cuadros_pares.h"
+
+// Patrones de Conway: sumando (1 a 4) de cada celda del bloque de 2x2,
+// por fila del bloque y columna del bloque
+enum { PATRON_L, PATRON_U, PATRON_X };
+
+static const int patrones_lux[3][2][2] = {
+    [PATRON_L] = {{4, 1}, {2, 3}},
+    [PATRON_U] = {{1, 4}, {2, 3}},
+    [PATRON_X] = {{1, 4}, {3, 2}},
+};
+
+bool es_algoritmo_par(TipoAlgoritmo algoritmo) {
+    return algoritmo == ALGORITMO_PAR_DOBLE || algoritmo == ALGORITMO_PAR_SIMPLE;
+}
+
+// Reduce a al rango [0, n)
+static int reducir(int a, int n) {
+    int r = a % n;
+    return r < 0 ? r + n : r;
+}
+
+// Doblemente par: en cada fila, las columnas j con j % 4 igual a i % 4 o a
+// 3 - i % 4 caen en una diagonal de su bloque de 4x4 y van complementadas
+#define DEFINIR_FILA_PAR_DOBLE(NOMBRE, TIPO)                                        \
+static void NOMBRE(int n, int fila, TIPO* destino) {                                \
+    TIPO directo = (TIPO)((TIPO)fila * (TIPO)n + 1);                                \
+    TIPO complemento = (TIPO)((TIPO)n * (TIPO)n - (TIPO)fila * (TIPO)n);            \
+    int a = fila & 3, b = 3 - a;                                                    \
+                                                                                    \
+    for (int j = 0; j < n; j++) {                                                   \
+        int k = j & 3;                                                              \
+        destino[j] = (k == a || k == b) ? (TIPO)(complemento - (TIPO)j)             \
+                                        : (TIPO)(directo + (TIPO)j);                \
+    }                                                                               \
+}
+
+// Simplemente par (n = 4m + 2, h = n/2): la fila de bloques I del cuadro
+// siamés de orden h vale s(I, J) = h*q + p con q = (I + J - c0) mod h y
+// p = (I + 2J - 2c0) mod h. Entre dos vueltas de q o de p, s crece h + 2
+// por columna, así que la fila se escribe por tramos lineales (a lo sumo
+// cuatro). Los bloques usan L en las filas 0..m, U en la m + 1 y X en el
+// resto, salvo en la columna m, donde se cambian la U y la L de arriba.
+#define DEFINIR_FILA_PAR_SIMPLE(NOMBRE, TIPO)                                       \
+static void NOMBRE(int n, int fila, TIPO* destino) {                                \
+    int h = n / 2, m = (n - 2) / 4, c0 = (h - 1) / 2;                               \
+    int bloque = fila >> 1, di = fila & 1;                                          \
+    int patron = bloque <= m ? PATRON_L : bloque == m + 1 ? PATRON_U : PATRON_X;    \
+    TIPO izquierda = (TIPO)patrones_lux[patron][di][0];                             \
+    TIPO derecha = (TIPO)patrones_lux[patron][di][1];                               \
+    TIPO paso = (TIPO)(4 * ((TIPO)h + 2));                                          \
+                                                                                    \
+    int q = reducir(bloque - c0, h);                                                \
+    int p = reducir(bloque - 2 * c0, h);                                            \
+    for (int J = 0; J < h; ) {                                                      \
+        int tramo = h - J;                                                          \
+        if (h - q < tramo) tramo = h - q;                                           \
+        if ((h - p + 1) / 2 < tramo) tramo = (h - p + 1) / 2;                       \
+                                                                                    \
+        TIPO base = (TIPO)(4 * ((TIPO)h * (TIPO)q + (TIPO)p));                      \
+        TIPO* d = destino + 2 * (size_t)J;                                          \
+        for (int t = 0; t < tramo; t++) {                                           \
+            TIPO v = (TIPO)(base + paso * (TIPO)t);                                 \
+            d[2 * t] = (TIPO)(v + izquierda);                                       \
+            d[2 * t + 1] = (TIPO)(v + derecha);                                     \
+        }                                                                           \
+                                                                                    \
+        J += tramo;                                                                 \
+        q += tramo;                                                                 \
+        if (q >= h) q -= h;                                                         \
+        p += 2 * tramo;                                                             \
+        if (p >= h) p -= h;                                                         \
+    }                                                                               \
+                                                                                    \
+    if (bloque == m || bloque == m + 1) {                                           \
+        int otro = bloque == m ? PATRON_U : PATRON_L;                               \
+        TIPO v = (TIPO)(destino[2 * m] - izquierda);                                \
+        destino[2 * m] = (TIPO)(v + patrones_lux[otro][di][0]);                     \
+        destino[2 * m + 1] = (TIPO)(v + patrones_lux[otro][di][1]);                 \
+    }                                                                               \
+}
+
+DEFINIR_FILA_PAR_DOBLE(fila_par_doble_16, uint16_t)
+DEFINIR_FILA_PAR_DOBLE(fila_par_doble_32, uint32_t)
+DEFINIR_FILA_PAR_DOBLE(fila_par_doble_64, uint64_t)
+DEFINIR_FILA_PAR_SIMPLE(fila_par_simple_16, uint16_t)
+DEFINIR_FILA_PAR_SIMPLE(fila_par_simple_32, uint32_t)
+DEFINIR_FILA_PAR_SIMPLE(fila_par_simple_64, uint64_t)
+
+void llenar_fila_par(TipoAlgoritmo algoritmo, int n, int fila, void* destino, AnchoCelda ancho) {
+    bool doble = algoritmo == ALGORITMO_PAR_DOBLE;
+    switch (ancho) {
+        case CELDA_16:
+            if (doble) fila_par_doble_16(n, fila, (uint16_t*)destino);
+            else fila_par_simple_16(n, fila, (uint16_t*)destino);
+            break;
+        case CELDA_32:
+            if (doble) fila_par_doble_32(n, fila, (uint32_t*)destino);
+            else fila_par_simple_32(n, fila, (uint32_t*)destino);
+            break;
+        case CELDA_64:
+            if (doble) fila_par_doble_64(n, fila, (uint64_t*)destino);
+            else fila_par_simple_64(n, fila, (uint64_t*)destino);
+            break;
+    }
+}
+
+// Patrón de bloque que usa la fila de bloques I en la columna de bloques J
+static int patron_bloque(int m, int I, int J) {
+    if (J == m && I == m) return PATRON_U;
+    if (J == m && I == m + 1) return PATRON_L;
+    return I <= m ? PATRON_L : I == m + 1 ? PATRON_U : PATRON_X;
+}
+
+void posicion_numero_par(TipoAlgoritmo algoritmo, int n, long long numero, int* fila, int* columna) {
+    long long k = numero - 1;
+
+    if (algoritmo == ALGORITMO_PAR_DOBLE) {
+        // El número cae en su lugar natural salvo que ahí vaya un complemento;
+        // el patrón es simétrico respecto al centro, así que entonces está en
+        // el lugar natural de n² + 1 - numero
+        int i = (int)(k / n), j = (int)(k % n);
+        int a = i & 3, c = j & 3;
+        if (c == a || c == 3 - a) {
+            k = (long long)n * n - 1 - k;
+            i = (int)(k / n);
+            j = (int)(k % n);
+        }
+        *fila = i;
+        *columna = j;
+        return;
+    }
+
+    // Simplemente par: numero - 1 = 4s + (sumando - 1), con s el número del
+    // cuadro siamés (desde 0). s = h*q + p está q vueltas y p pasos después
+    // del inicio: fila 2q - p, columna c0 - q + p
+    int h = n / 2, m = (n - 2) / 4, c0 = (h - 1) / 2;
+    long long s = k / 4;
+    int sumando = (int)(k % 4) + 1;
+    int q = (int)(s / h), p = (int)(s % h);
+    int I = reducir(2 * q - p, h);
+    int J = reducir(c0 - q + p, h);
+
+    int patron = patron_bloque(m, I, J);
+    for (int di = 0; di < 2; di++) {
+        for (int dj = 0; dj < 2; dj++) {
+            if (patrones_lux[patron][di][dj] == sumando) {
+                *fila = 2 * I + di;
+                *columna = 2 * J + dj;
+                return;
+            }
+        }
+    }
+}
@@ -0,0 +1,33 @@
+/*
+ * Cuadros mágicos de orden par.
+ *
+ * Ningún recorrido con break-move sirve para n par, así que estos
+ * cuadros se escriben fila por fila con fórmulas cerradas:
+ *   - Doblemente par (n = 4m): la celda (i, j) vale i*n + j + 1, salvo en
+ *     las diagonales de cada bloque de 4x4, donde vale su complemento
+ *     n² + 1 - (i*n + j + 1).
+ *   - Simplemente par (n = 4m + 2): método LUX de Conway sobre el cuadro
+ *     siamés de orden n/2; cada celda de ese cuadro se vuelve un bloque de
+ *     2x2 con uno de los patrones L, U o X.
+ * Cada fila se reduce a tramos donde el valor crece linealmente con la
+ * columna, sin módulos ni consultas a la matriz, así que el compilador
+ * puede vectorizar el llenado.
+ */
+
+#ifndef CUADROS_PARES_H
+#define CUADROS_PARES_H
+
+#include <stdbool.h>
+#include "cuadros_magicos.h"
+
+// Si el algoritmo es una de las construcciones de orden par
+bool es_algoritmo_par(TipoAlgoritmo algoritmo);
+
+// Escribe la fila pedida: n celdas del ancho dado
+void llenar_fila_par(TipoAlgoritmo algoritmo, int n, int fila, void* destino, AnchoCelda ancho);
+
+// Celda donde la construcción pone el número dado (de 1 a n²), sin
+// construir el cuadro: sirve para llenarlo número por número
+void posicion_numero_par(TipoAlgoritmo algoritmo, int n, long long numero, int* fila, int* columna);
+
+#endif // CUADROS_PARES_H
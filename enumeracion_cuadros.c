@@ -0,0 +1,473 @@
+/*
+ * Enumeración de cuadros mágicos por backtracking con robo de trabajo
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "enumeracion_cuadros.h"
+#include "validacion.h"
+
+#define MAX_CELDAS_ENUMERACION (MAX_ORDEN_ENUMERACION * MAX_ORDEN_ENUMERACION)
+
+// Una línea del cuadro: suma de lo puesto y celdas que le faltan
+typedef struct {
+    int parcial;
+    int vacias;
+} LineaParcial;
+
+// Cuadro parcial: las celdas se llenan en el orden de orden[], que cierra
+// primero la fila 0, la columna 0 y las diagonales
+typedef struct {
+    int n;
+    int suma;
+    bool solo_canonicos;
+    uint8_t orden[MAX_CELDAS_ENUMERACION];
+    uint8_t valores[MAX_CELDAS_ENUMERACION];
+    LineaParcial filas[MAX_ORDEN_ENUMERACION];
+    LineaParcial columnas[MAX_ORDEN_ENUMERACION];
+    LineaParcial diagonal, antidiagonal;
+    uint32_t libres;        // Bit v - 1 encendido si v no se usó
+} CuadroParcial;
+
+typedef struct TrabajadorEnumeracion TrabajadorEnumeracion;
+
+// Estado compartido por todos los trabajadores. Cada tarea es un prefijo
+// de profundidad celdas del orden de llenado (una primera fila posible).
+typedef struct {
+    int n;
+    int suma;
+    bool solo_canonicos;
+    long long limite;
+    uint8_t* tareas;
+    int num_tareas;
+    int profundidad;
+    long long encontrados;      // Contador atómico de cuadros aceptados
+    int cortada;                // Se rechazó un cuadro por pasar el límite
+    int detener;                // Se activa al pasar el límite o sin memoria
+    TrabajadorEnumeracion* trabajadores;
+    int num_trabajadores;
+} EnumeracionCompartida;
+
+struct TrabajadorEnumeracion {
+    EnumeracionCompartida* compartida;
+    int indice;
+    uint64_t rango;             // Tareas pendientes: (siguiente << 32) | fin, atómico
+    uint8_t* cuadros;
+    long long cantidad;
+    long long capacidad;
+    long long nodos;
+    pthread_t hilo;
+};
+
+// ============= PODA =============
+
+// Suma de los k números libres más chicos / más grandes
+static int suma_menores(uint32_t libres, int k) {
+    int suma = 0;
+    for (; k > 0 && libres; k--) {
+        suma += __builtin_ctz(libres) + 1;
+        libres &= libres - 1;
+    }
+    return k == 0 ? suma : -1;
+}
+
+static int suma_mayores(uint32_t libres, int k) {
+    int suma = 0;
+    for (; k > 0 && libres; k--) {
+        int bit = 31 - __builtin_clz(libres);
+        suma += bit + 1;
+        libres &= ~((uint32_t)1 << bit);
+    }
+    return k == 0 ? suma : -1;
+}
+
+// Si a una línea con suma parcial y restantes celdas vacías todavía le
+// alcanzan los números libres para llegar a la suma mágica
+static bool linea_posible(int parcial, int restantes, uint32_t libres, int suma) {
+    int falta = suma - parcial;
+    if (restantes == 0) return falta == 0;
+    if (restantes == 1) return falta >= 1 && falta <= 32 && (libres >> (falta - 1) & 1);
+    int menor = suma_menores(libres, restantes);
+    return menor >= 0 && falta >= menor && falta <= suma_mayores(libres, restantes);
+}
+
+// Condiciones de simetría del cuadro canónico sobre las esquinas
+static bool esquina_canonica(const CuadroParcial* c, int fila, int columna, int v) {
+    int n = c->n;
+    if (fila == 0 && columna == n - 1) return v > c->valores[0];
+    if (fila == n - 1 && columna == 0) return v > c->valores[0] && v > c->valores[n - 1];
+    if (fila == n - 1 && columna == n - 1) return v > c->valores[0];
+    return true;
+}
+
+// Líneas que pasan por una celda (fila, columna y las diagonales que toque)
+static int lineas_de_celda(CuadroParcial* c, int celda, LineaParcial** lineas) {
+    int n = c->n;
+    int i = celda / n, j = celda % n;
+    int cantidad = 0;
+    lineas[cantidad++] = &c->filas[i];
+    lineas[cantidad++] = &c->columnas[j];
+    if (i == j) lineas[cantidad++] = &c->diagonal;
+    if (i + j == n - 1) lineas[cantidad++] = &c->antidiagonal;
+    return cantidad;
+}
+
+// Intenta poner v en la celda; si todas las líneas siguen siendo posibles
+// deja el valor puesto y devuelve true
+static bool poner_valor(CuadroParcial* c, int celda, int v) {
+    int n = c->n;
+    uint32_t libres = c->libres & ~((uint32_t)1 << (v - 1));
+    LineaParcial* lineas[4];
+    int num_lineas = lineas_de_celda(c, celda, lineas);
+
+    if (c->solo_canonicos && !esquina_canonica(c, celda / n, celda % n, v)) return false;
+    for (int k = 0; k < num_lineas; k++) {
+        if (!linea_posible(lineas[k]->parcial + v, lineas[k]->vacias - 1, libres, c->suma)) return false;
+    }
+
+    c->valores[celda] = (uint8_t)v;
+    c->libres = libres;
+    for (int k = 0; k < num_lineas; k++) {
+        lineas[k]->parcial += v;
+        lineas[k]->vacias--;
+    }
+    return true;
+}
+
+static void quitar_valor(CuadroParcial* c, int celda) {
+    int v = c->valores[celda];
+    LineaParcial* lineas[4];
+    int num_lineas = lineas_de_celda(c, celda, lineas);
+
+    c->libres |= (uint32_t)1 << (v - 1);
+    for (int k = 0; k < num_lineas; k++) {
+        lineas[k]->parcial -= v;
+        lineas[k]->vacias++;
+    }
+}
+
+// Candidatos de una celda: si es la última vacía de alguna de sus líneas
+// queda forzada por la suma; si no, puede tomar cualquier número libre
+static uint32_t candidatos(CuadroParcial* c, int celda) {
+    LineaParcial* lineas[4];
+    int num_lineas = lineas_de_celda(c, celda, lineas);
+    int forzado = 0;
+
+    for (int k = 0; k < num_lineas; k++) {
+        if (lineas[k]->vacias != 1) continue;
+        int falta = c->suma - lineas[k]->parcial;
+        if (forzado != 0 && forzado != falta) return 0;
+        forzado = falta;
+    }
+    if (forzado == 0) return c->libres;
+    if (forzado < 1 || forzado > c->n * c->n) return 0;
+    return c->libres & ((uint32_t)1 << (forzado - 1));
+}
+
+// Agrega al orden de llenado las celdas de una línea que todavía no están
+static void agregar_linea(uint8_t* orden, bool* usada, int* cantidad, int celda, int paso, int n) {
+    for (int k = 0; k < n; k++, celda += paso) {
+        if (usada[celda]) continue;
+        usada[celda] = true;
+        orden[(*cantidad)++] = (uint8_t)celda;
+    }
+}
+
+static void iniciar_parcial(CuadroParcial* c, int n, bool solo_canonicos) {
+    memset(c, 0, sizeof(*c));
+    c->n = n;
+    c->suma = n * (n * n + 1) / 2;
+    c->solo_canonicos = solo_canonicos;
+    c->libres = ((uint32_t)1 << (n * n)) - 1;
+
+    for (int k = 0; k < n; k++) {
+        c->filas[k].vacias = n;
+        c->columnas[k].vacias = n;
+    }
+    c->diagonal.vacias = n;
+    c->antidiagonal.vacias = n;
+
+    // Fila 0, columna 0, las dos diagonales y después filas y columnas
+    // alternadas: cada línea se cierra lo antes posible y su última celda
+    // queda forzada
+    bool usada[MAX_CELDAS_ENUMERACION] = {false};
+    int cantidad = 0;
+    agregar_linea(c->orden, usada, &cantidad, 0, 1, n);
+    agregar_linea(c->orden, usada, &cantidad, 0, n, n);
+    agregar_linea(c->orden, usada, &cantidad, 0, n + 1, n);
+    agregar_linea(c->orden, usada, &cantidad, n - 1, n - 1, n);
+    for (int k = 1; k < n; k++) {
+        agregar_linea(c->orden, usada, &cantidad, k * n, 1, n);
+        agregar_linea(c->orden, usada, &cantidad, k, n, n);
+    }
+}
+
+// ============= PREFIJOS =============
+
+typedef struct {
+    uint8_t* prefijos;
+    int cantidad;
+    int capacidad;
+    bool sin_memoria;
+} ListaPrefijos;
+
+// Recorre el árbol hasta la profundidad pedida y guarda cada prefijo vivo
+// (los valores de las primeras posiciones del orden de llenado)
+static void juntar_prefijos(CuadroParcial* c, int posicion, int profundidad, ListaPrefijos* lista) {
+    if (lista->sin_memoria) return;
+    if (posicion == profundidad) {
+        if (lista->cantidad == lista->capacidad) {
+            int capacidad = lista->capacidad ? lista->capacidad * 2 : 1024;
+            uint8_t* nuevos = (uint8_t*)realloc(lista->prefijos, (size_t)capacidad * profundidad);
+            if (!nuevos) {
+                lista->sin_memoria = true;
+                return;
+            }
+            lista->prefijos = nuevos;
+            lista->capacidad = capacidad;
+        }
+        uint8_t* prefijo = lista->prefijos + (size_t)lista->cantidad * profundidad;
+        for (int k = 0; k < profundidad; k++) prefijo[k] = c->valores[c->orden[k]];
+        lista->cantidad++;
+        return;
+    }
+
+    int celda = c->orden[posicion];
+    for (uint32_t opciones = candidatos(c, celda); opciones; opciones &= opciones - 1) {
+        int v = __builtin_ctz(opciones) + 1;
+        if (!poner_valor(c, celda, v)) continue;
+        juntar_prefijos(c, posicion + 1, profundidad, lista);
+        quitar_valor(c, celda);
+    }
+}
+
+// ============= BÚSQUEDA =============
+
+// Guarda un cuadro completo si todavía no se llegó al límite. La búsqueda
+// sigue después del último cuadro permitido: solo se corta al encontrar
+// otro, así una enumeración con exactamente limite cuadros queda completa.
+static void aceptar_cuadro(TrabajadorEnumeracion* t, const CuadroParcial* c) {
+    EnumeracionCompartida* e = t->compartida;
+    int celdas = c->n * c->n;
+
+    long long orden = __atomic_fetch_add(&e->encontrados, 1, __ATOMIC_RELAXED);
+    if (e->limite > 0 && orden >= e->limite) {
+        __atomic_store_n(&e->cortada, 1, __ATOMIC_RELAXED);
+        __atomic_store_n(&e->detener, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    if (t->cantidad == t->capacidad) {
+        long long capacidad = t->capacidad ? t->capacidad * 2 : 256;
+        uint8_t* nuevos = (uint8_t*)realloc(t->cuadros, (size_t)capacidad * celdas);
+        if (!nuevos) {
+            __atomic_store_n(&e->detener, 1, __ATOMIC_RELAXED);
+            return;
+        }
+        t->cuadros = nuevos;
+        t->capacidad = capacidad;
+    }
+    memcpy(t->cuadros + (size_t)t->cantidad * celdas, c->valores, (size_t)celdas);
+    t->cantidad++;
+}
+
+static void buscar(TrabajadorEnumeracion* t, CuadroParcial* c, int posicion) {
+    if (posicion == c->n * c->n) {
+        aceptar_cuadro(t, c);
+        return;
+    }
+    if (__atomic_load_n(&t->compartida->detener, __ATOMIC_RELAXED)) return;
+
+    int celda = c->orden[posicion];
+    for (uint32_t opciones = candidatos(c, celda); opciones; opciones &= opciones - 1) {
+        int v = __builtin_ctz(opciones) + 1;
+        t->nodos++;
+        if (!poner_valor(c, celda, v)) continue;
+        buscar(t, c, posicion + 1);
+        quitar_valor(c, celda);
+    }
+}
+
+// Resuelve el subárbol de una tarea: rehace su prefijo y sigue desde ahí
+static void resolver_tarea(TrabajadorEnumeracion* t, int tarea) {
+    EnumeracionCompartida* e = t->compartida;
+    const uint8_t* prefijo = e->tareas + (size_t)tarea * e->profundidad;
+    CuadroParcial c;
+    iniciar_parcial(&c, e->n, e->solo_canonicos);
+    for (int k = 0; k < e->profundidad; k++) {
+        poner_valor(&c, c.orden[k], prefijo[k]);
+    }
+    buscar(t, &c, e->profundidad);
+}
+
+// ============= ROBO DE TRABAJO =============
+
+static uint64_t empaquetar_rango(uint32_t siguiente, uint32_t fin) {
+    return (uint64_t)siguiente << 32 | fin;
+}
+
+// Toma la primera tarea del rango propio; -1 si está vacío
+static int tomar_tarea(TrabajadorEnumeracion* t) {
+    uint64_t rango = __atomic_load_n(&t->rango, __ATOMIC_ACQUIRE);
+    for (;;) {
+        uint32_t siguiente = (uint32_t)(rango >> 32), fin = (uint32_t)rango;
+        if (siguiente >= fin) return -1;
+        if (__atomic_compare_exchange_n(&t->rango, &rango, empaquetar_rango(siguiente + 1, fin),
+                                        false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            return (int)siguiente;
+        }
+    }
+}
+
+// Roba la mitad final del rango de otro trabajador: devuelve la primera
+// tarea robada y deja el resto como rango propio; -1 si nadie tiene trabajo
+static int robar_tarea(TrabajadorEnumeracion* t) {
+    EnumeracionCompartida* e = t->compartida;
+    for (int k = 1; k < e->num_trabajadores; k++) {
+        TrabajadorEnumeracion* victima = &e->trabajadores[(t->indice + k) % e->num_trabajadores];
+        uint64_t rango = __atomic_load_n(&victima->rango, __ATOMIC_ACQUIRE);
+        for (;;) {
+            uint32_t siguiente = (uint32_t)(rango >> 32), fin = (uint32_t)rango;
+            if (siguiente >= fin) break;
+            uint32_t mitad = (fin - siguiente + 1) / 2;
+            if (__atomic_compare_exchange_n(&victima->rango, &rango, empaquetar_rango(siguiente, fin - mitad),
+                                            false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                __atomic_store_n(&t->rango, empaquetar_rango(fin - mitad + 1, fin), __ATOMIC_RELEASE);
+                return (int)(fin - mitad);
+            }
+        }
+    }
+    return -1;
+}
+
+static void* trabajar(void* arg) {
+    TrabajadorEnumeracion* t = (TrabajadorEnumeracion*)arg;
+    EnumeracionCompartida* e = t->compartida;
+
+    while (!__atomic_load_n(&e->detener, __ATOMIC_RELAXED)) {
+        int tarea = tomar_tarea(t);
+        if (tarea < 0) tarea = robar_tarea(t);
+        if (tarea < 0) break;
+        resolver_tarea(t, tarea);
+    }
+    return NULL;
+}
+
+// ============= ENUMERACIÓN =============
+
+// Compara dos cuadros guardados en MAX_CELDAS_ENUMERACION bytes, con ceros
+// después de las n² celdas: el relleno es igual en todos, así que el orden
+// es el de las celdas sin necesidad de saber n
+static int comparar_cuadros(const void* a, const void* b) {
+    return memcmp(a, b, MAX_CELDAS_ENUMERACION);
+}
+
+bool enumerar_cuadros_magicos(int n, const OpcionesEnumeracion* opciones, EnumeracionCuadros* resultado) {
+    memset(resultado, 0, sizeof(*resultado));
+    if (n < 3 || n > MAX_ORDEN_ENUMERACION) return false;
+    resultado->tamaño = n;
+    int celdas = n * n;
+
+    EnumeracionCompartida e;
+    memset(&e, 0, sizeof(e));
+    e.n = n;
+    e.suma = n * (celdas + 1) / 2;
+    e.solo_canonicos = opciones && opciones->solo_canonicos;
+    e.limite = opciones ? opciones->limite : 0;
+    e.profundidad = n;
+
+    // Las tareas son las primeras filas que sobreviven a la poda
+    ListaPrefijos lista = {NULL, 0, 0, false};
+    CuadroParcial raiz;
+    iniciar_parcial(&raiz, n, e.solo_canonicos);
+    juntar_prefijos(&raiz, 0, e.profundidad, &lista);
+    if (lista.sin_memoria) {
+        free(lista.prefijos);
+        return false;
+    }
+    e.tareas = lista.prefijos;
+    e.num_tareas = lista.cantidad;
+
+    int num_hilos = opciones && opciones->hilos > 0 ? opciones->hilos : hilos_disponibles();
+    if (num_hilos > e.num_tareas) num_hilos = e.num_tareas > 0 ? e.num_tareas : 1;
+
+    TrabajadorEnumeracion* trabajadores =
+        (TrabajadorEnumeracion*)calloc((size_t)num_hilos, sizeof(TrabajadorEnumeracion));
+    if (!trabajadores) {
+        free(lista.prefijos);
+        return false;
+    }
+    e.trabajadores = trabajadores;
+    e.num_trabajadores = num_hilos;
+
+    // Cada trabajador empieza con un rango contiguo de tareas
+    for (int h = 0; h < num_hilos; h++) {
+        trabajadores[h].compartida = &e;
+        trabajadores[h].indice = h;
+        trabajadores[h].rango = empaquetar_rango((uint32_t)((long long)e.num_tareas * h / num_hilos),
+                                                 (uint32_t)((long long)e.num_tareas * (h + 1) / num_hilos));
+    }
+
+    // El hilo actual hace de trabajador 0; si otro no arranca, su rango se
+    // queda para que se lo roben
+    int lanzados = 0;
+    for (int h = 1; h < num_hilos; h++) {
+        if (pthread_create(&trabajadores[h].hilo, NULL, trabajar, &trabajadores[h]) != 0) break;
+        lanzados++;
+    }
+    trabajar(&trabajadores[0]);
+    for (int h = 1; h <= lanzados; h++) {
+        pthread_join(trabajadores[h].hilo, NULL);
+    }
+
+    // Reunir lo que encontró cada trabajador
+    bool ok = true;
+    long long cantidad = 0;
+    for (int h = 0; h < num_hilos; h++) {
+        cantidad += trabajadores[h].cantidad;
+        resultado->nodos += trabajadores[h].nodos;
+    }
+    bool cortada = e.cortada;
+    resultado->completa = !cortada && !e.detener;
+    // Sin memoria para algún cuadro la enumeración no sirve
+    if (!cortada && e.detener) ok = false;
+
+    if (ok && cantidad > 0) {
+        // Se ordena con cada cuadro rellenado a MAX_CELDAS_ENUMERACION bytes
+        // y después se compacta a n² bytes por cuadro
+        uint8_t* ordenados = (uint8_t*)calloc((size_t)cantidad, MAX_CELDAS_ENUMERACION);
+        resultado->cuadros = (uint8_t*)malloc((size_t)cantidad * celdas);
+        if (ordenados && resultado->cuadros) {
+            long long k = 0;
+            for (int h = 0; h < num_hilos; h++) {
+                for (long long i = 0; i < trabajadores[h].cantidad; i++, k++) {
+                    memcpy(ordenados + (size_t)k * MAX_CELDAS_ENUMERACION,
+                           trabajadores[h].cuadros + (size_t)i * celdas, (size_t)celdas);
+                }
+            }
+            qsort(ordenados, (size_t)cantidad, MAX_CELDAS_ENUMERACION, comparar_cuadros);
+            for (k = 0; k < cantidad; k++) {
+                memcpy(resultado->cuadros + (size_t)k * celdas, ordenados + (size_t)k * MAX_CELDAS_ENUMERACION,
+                       (size_t)celdas);
+            }
+            resultado->cantidad = cantidad;
+        } else {
+            free(resultado->cuadros);
+            resultado->cuadros = NULL;
+            ok = false;
+        }
+        free(ordenados);
+    }
+
+    for (int h = 0; h < num_hilos; h++) free(trabajadores[h].cuadros);
+    free(trabajadores);
+    free(lista.prefijos);
+    return ok;
+}
+
+void liberar_enumeracion_cuadros(EnumeracionCuadros* enumeracion) {
+    free(enumeracion->cuadros);
+    enumeracion->cuadros = NULL;
+    enumeracion->cantidad = 0;
+}
@@ -0,0 +1,53 @@
+/*
+ * Enumeración exhaustiva de cuadros mágicos de orden chico.
+ *
+ * En lugar de construir un cuadro por algoritmo, se buscan todos los
+ * cuadros mágicos normales de orden n (n² números distintos del 1 al n²)
+ * con backtracking. Las celdas se llenan cerrando primero la fila 0, la
+ * columna 0 y las diagonales. Cada línea se poda con su suma parcial: lo
+ * que le falta tiene que estar entre la suma de los números libres más
+ * chicos y la de los más grandes, y la última celda de cada fila, columna
+ * o diagonal queda forzada. Los números libres son un mapa de bits.
+ *
+ * Los subárboles (cada primera fila posible) se reparten entre los núcleos
+ * con robo de trabajo: cada hilo consume su rango de subárboles por
+ * delante y, cuando se le acaba, roba la mitad final del rango de otro.
+ *
+ * Órdenes 3 y 4 se enumeran completos (8 y 7040 cuadros; 1 y 880 salvo
+ * simetrías). Para orden 5 (275 305 224 salvo simetrías) conviene poner
+ * un límite de cuadros.
+ */
+
+#ifndef ENUMERACION_CUADROS_H
+#define ENUMERACION_CUADROS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Orden máximo: los números libres caben en un mapa de 32 bits
+#define MAX_ORDEN_ENUMERACION 5
+
+typedef struct {
+    bool solo_canonicos;    // Uno por clase de las 8 simetrías del cuadrado
+    long long limite;       // Cuadros a encontrar como máximo; 0 = todos
+    int hilos;              // <= 0 usa todos los núcleos
+} OpcionesEnumeracion;
+
+typedef struct {
+    int tamaño;
+    uint8_t* cuadros;       // cantidad cuadros de n*n valores, fila por fila,
+                            // en orden lexicográfico
+    long long cantidad;
+    long long nodos;        // Celdas probadas en toda la búsqueda
+    bool completa;          // Se recorrió todo el árbol, sin cortar por el límite
+} EnumeracionCuadros;
+
+// Enumera los cuadros mágicos de orden n (3 a MAX_ORDEN_ENUMERACION).
+// Un cuadro canónico tiene la esquina superior izquierda menor que las
+// otras tres y la superior derecha menor que la inferior izquierda. Si el
+// límite corta la búsqueda con varios hilos, qué cuadros se encuentran
+// depende del reparto; con un hilo son siempre los mismos.
+bool enumerar_cuadros_magicos(int n, const OpcionesEnumeracion* opciones, EnumeracionCuadros* resultado);
+void liberar_enumeracion_cuadros(EnumeracionCuadros* enumeracion);
+
+#endif // ENUMERACION_CUADROS_H
@@ -0,0 +1,239 @@
+/*
+ * Exploración paralela de movimientos y posiciones de inicio
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "exploracion_movimientos.h"
+#include "movimientos.h"
+#include "validacion.h"
+
+#define PALABRAS_OCUPACION ((MAX_ORDEN_EXPLORACION * MAX_ORDEN_EXPLORACION + 63) / 64)
+
+// Resultado de simular una combinación
+typedef enum {
+    RECORRIDO_MAGICO,
+    RECORRIDO_COLISION,     // Un break-move cayó en una celda ocupada
+    RECORRIDO_NO_MAGICO     // Una línea no da la suma mágica
+} ResultadoRecorrido;
+
+// Estado compartido por todos los trabajadores de una exploración. Cada
+// unidad de trabajo es un par (celda de inicio, movimiento principal) con
+// todos sus break-moves.
+typedef struct {
+    int n;
+    long long unidades;
+    long long siguiente_unidad;  // Contador atómico de unidades repartidas
+} ExploracionCompartida;
+
+typedef struct {
+    ExploracionCompartida* compartida;
+    CombinacionMagica* encontradas;
+    int cantidad;
+    int capacidad;
+    long long probadas;
+    long long colisiones;
+    bool sin_memoria;
+    pthread_t hilo;
+} TrabajadorExploracion;
+
+// Lleva a al rango (-n/2, n/2]
+static int con_signo(int a, int n) {
+    return a > n / 2 ? a - n : a;
+}
+
+// Simula el recorrido con los vectores ya reducidos a [0, n). Como los
+// números suman n veces la suma mágica, si ninguna fila ni columna se pasa
+// de ella todas la alcanzan: al final solo faltan las diagonales.
+static ResultadoRecorrido simular_recorrido(int n, int fila, int columna,
+                                            int df, int dc, int bf, int bc) {
+    uint64_t ocupadas[PALABRAS_OCUPACION];
+    int filas[MAX_ORDEN_EXPLORACION];
+    int columnas[MAX_ORDEN_EXPLORACION];
+    int total = n * n;
+    int suma = n * (total + 1) / 2;
+    int diagonal = 0, antidiagonal = 0;
+
+    memset(ocupadas, 0, (size_t)(total + 63) / 64 * sizeof(uint64_t));
+    memset(filas, 0, (size_t)n * sizeof(int));
+    memset(columnas, 0, (size_t)n * sizeof(int));
+
+    for (int numero = 1; ; numero++) {
+        int celda = fila * n + columna;
+        ocupadas[celda >> 6] |= (uint64_t)1 << (celda & 63);
+
+        filas[fila] += numero;
+        columnas[columna] += numero;
+        if (fila == columna) diagonal += numero;
+        if (fila + columna == n - 1) antidiagonal += numero;
+        if (filas[fila] > suma || columnas[columna] > suma ||
+            diagonal > suma || antidiagonal > suma) {
+            return RECORRIDO_NO_MAGICO;
+        }
+        if (numero == total) break;
+
+        int f = fila + df, c = columna + dc;
+        f = f >= n ? f - n : f;
+        c = c >= n ? c - n : c;
+        int destino = f * n + c;
+        if (ocupadas[destino >> 6] >> (destino & 63) & 1) {
+            f = fila + bf;
+            c = columna + bc;
+            f = f >= n ? f - n : f;
+            c = c >= n ? c - n : c;
+            destino = f * n + c;
+            if (ocupadas[destino >> 6] >> (destino & 63) & 1) return RECORRIDO_COLISION;
+        }
+        fila = f;
+        columna = c;
+    }
+
+    return diagonal == suma && antidiagonal == suma ? RECORRIDO_MAGICO : RECORRIDO_NO_MAGICO;
+}
+
+static bool agregar_combinacion(TrabajadorExploracion* t, const CombinacionMagica* combinacion) {
+    if (t->cantidad == t->capacidad) {
+        int capacidad = t->capacidad ? t->capacidad * 2 : 64;
+        CombinacionMagica* nuevas = (CombinacionMagica*)realloc(t->encontradas,
+                                                                (size_t)capacidad * sizeof(CombinacionMagica));
+        if (!nuevas) return false;
+        t->encontradas = nuevas;
+        t->capacidad = capacidad;
+    }
+    t->encontradas[t->cantidad++] = *combinacion;
+    return true;
+}
+
+// Toma unidades (inicio, movimiento principal) y prueba todos sus break-moves
+static void* explorar_unidades(void* arg) {
+    TrabajadorExploracion* t = (TrabajadorExploracion*)arg;
+    ExploracionCompartida* c = t->compartida;
+    int n = c->n;
+    int celdas = n * n;
+
+    while (!t->sin_memoria) {
+        long long unidad = __atomic_fetch_add(&c->siguiente_unidad, 1, __ATOMIC_RELAXED);
+        if (unidad >= c->unidades) break;
+
+        int inicio = (int)(unidad / celdas);
+        int paso = (int)(unidad % celdas);
+        int fila0 = inicio / n, columna0 = inicio % n;
+        int df = paso / n, dc = paso % n;
+
+        for (int ruptura = 0; ruptura < celdas; ruptura++) {
+            int bf = ruptura / n, bc = ruptura % n;
+            t->probadas++;
+
+            ResultadoRecorrido r = simular_recorrido(n, fila0, columna0, df, dc, bf, bc);
+            if (r == RECORRIDO_COLISION) t->colisiones++;
+            if (r != RECORRIDO_MAGICO) continue;
+
+            CombinacionMagica combinacion;
+            combinacion.fila0 = fila0;
+            combinacion.columna0 = columna0;
+            combinacion.df = con_signo(df, n);
+            combinacion.dc = con_signo(dc, n);
+            combinacion.bf = con_signo(bf, n);
+            combinacion.bc = con_signo(bc, n);
+
+            // El calendario solo depende de los vectores, no del inicio
+            DescriptorMovimiento d = {NULL, df, dc, bf, bc, 0, 0};
+            Recorrido recorrido;
+            iniciar_recorrido(&recorrido, n, &d);
+            combinacion.fijo = recorrido.fijo;
+
+            if (!agregar_combinacion(t, &combinacion)) {
+                t->sin_memoria = true;
+                break;
+            }
+        }
+    }
+    return NULL;
+}
+
+// Costo de generar con una combinación: primero las de calendario fijo,
+// luego los vectores más cortos
+static int costo_combinacion(const CombinacionMagica* c) {
+    int largo = abs(c->df) + abs(c->dc) + abs(c->bf) + abs(c->bc);
+    return (c->fijo ? 0 : 1 << 16) + largo;
+}
+
+static int comparar_combinaciones(const void* a, const void* b) {
+    const CombinacionMagica* x = (const CombinacionMagica*)a;
+    const CombinacionMagica* y = (const CombinacionMagica*)b;
+    int claves_x[] = {costo_combinacion(x), x->fila0, x->columna0, x->df, x->dc, x->bf, x->bc};
+    int claves_y[] = {costo_combinacion(y), y->fila0, y->columna0, y->df, y->dc, y->bf, y->bc};
+    for (int i = 0; i < 7; i++) {
+        if (claves_x[i] != claves_y[i]) return claves_x[i] < claves_y[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+bool explorar_movimientos(int n, int num_hilos, CatalogoMovimientos* catalogo) {
+    memset(catalogo, 0, sizeof(*catalogo));
+    if (n % 2 == 0 || n < 3 || n > MAX_ORDEN_EXPLORACION) return false;
+    catalogo->tamaño = n;
+
+    ExploracionCompartida compartida;
+    compartida.n = n;
+    compartida.unidades = (long long)n * n * n * n;
+    compartida.siguiente_unidad = 0;
+
+    if (num_hilos <= 0) num_hilos = hilos_disponibles();
+    if (num_hilos > n * n) num_hilos = n * n;
+
+    TrabajadorExploracion* trabajadores =
+        (TrabajadorExploracion*)calloc((size_t)num_hilos, sizeof(TrabajadorExploracion));
+    if (!trabajadores) return false;
+
+    // El hilo actual hace de trabajador 0
+    int lanzados = 0;
+    for (int h = 0; h < num_hilos; h++) trabajadores[h].compartida = &compartida;
+    for (int h = 1; h < num_hilos; h++) {
+        if (pthread_create(&trabajadores[h].hilo, NULL, explorar_unidades, &trabajadores[h]) != 0) {
+            break;
+        }
+        lanzados++;
+    }
+    explorar_unidades(&trabajadores[0]);
+    for (int h = 1; h <= lanzados; h++) {
+        pthread_join(trabajadores[h].hilo, NULL);
+    }
+
+    // Reunir lo que encontró cada trabajador
+    bool ok = true;
+    int cantidad = 0;
+    for (int h = 0; h <= lanzados; h++) {
+        if (trabajadores[h].sin_memoria) ok = false;
+        cantidad += trabajadores[h].cantidad;
+        catalogo->probadas += trabajadores[h].probadas;
+        catalogo->colisiones += trabajadores[h].colisiones;
+    }
+
+    if (ok && cantidad > 0) {
+        catalogo->combinaciones = (CombinacionMagica*)malloc((size_t)cantidad * sizeof(CombinacionMagica));
+        if (catalogo->combinaciones) {
+            for (int h = 0; h <= lanzados; h++) {
+                memcpy(catalogo->combinaciones + catalogo->cantidad, trabajadores[h].encontradas,
+                       (size_t)trabajadores[h].cantidad * sizeof(CombinacionMagica));
+                catalogo->cantidad += trabajadores[h].cantidad;
+            }
+            qsort(catalogo->combinaciones, (size_t)cantidad, sizeof(CombinacionMagica),
+                  comparar_combinaciones);
+        } else {
+            ok = false;
+        }
+    }
+
+    for (int h = 0; h < num_hilos; h++) free(trabajadores[h].encontradas);
+    free(trabajadores);
+    return ok;
+}
+
+void liberar_catalogo_movimientos(CatalogoMovimientos* catalogo) {
+    free(catalogo->combinaciones);
+    catalogo->combinaciones = NULL;
+    catalogo->cantidad = 0;
+}
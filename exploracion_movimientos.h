@@ -0,0 +1,45 @@
+/*
+ * Exploración de construcciones por recorrido con break-move.
+ *
+ * Para un orden n se prueban todas las celdas de inicio, todos los
+ * movimientos principales y todos los break-moves, repartidos entre los
+ * núcleos. Cada recorrido se simula con un mapa de bits de ocupación y se
+ * abandona en la primera falla: un break-move que cae en una celda ocupada
+ * o una línea que ya se pasó de la suma mágica. El resultado es un
+ * catálogo de las combinaciones que dan cuadros mágicos, de la más barata
+ * de generar a la más cara.
+ */
+
+#ifndef EXPLORACION_MOVIMIENTOS_H
+#define EXPLORACION_MOVIMIENTOS_H
+
+#include <stdbool.h>
+#include "cuadros_magicos.h"
+
+// Orden máximo que se explora: el mapa de bits va en la pila y el costo
+// crece como n⁶ combinaciones
+#define MAX_ORDEN_EXPLORACION 63
+
+// Una combinación que produce un cuadro mágico. Los vectores van con signo,
+// en el rango (-n/2, n/2].
+typedef struct {
+    int fila0, columna0;
+    int df, dc;             // Movimiento principal
+    int bf, bc;             // Break-move
+    bool fijo;              // Calendario fijo: se genera sin consultar la matriz
+} CombinacionMagica;
+
+typedef struct {
+    int tamaño;
+    CombinacionMagica* combinaciones;   // De la más barata a la más cara
+    int cantidad;
+    long long probadas;
+    long long colisiones;               // Descartadas por caer en una celda ocupada
+} CatalogoMovimientos;
+
+// Explora todas las combinaciones para el orden n (impar, entre 3 y
+// MAX_ORDEN_EXPLORACION). num_hilos <= 0 usa todos los núcleos.
+bool explorar_movimientos(int n, int num_hilos, CatalogoMovimientos* catalogo);
+void liberar_catalogo_movimientos(CatalogoMovimientos* catalogo);
+
+#endif // EXPLORACION_MOVIMIENTOS_H
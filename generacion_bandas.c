@@ -0,0 +1,169 @@
+/*
+ * Generación por bandas de filas hacia un archivo, con escritura solapada
+ */
+
+#define _DEFAULT_SOURCE
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "generacion_bandas.h"
+#include "archivo_cuadro.h"
+#include "validacion.h"
+
+// Doble buffer compartido entre el hilo que calcula y el que escribe
+typedef struct {
+    int fd;
+    void* bandas[2];
+    size_t bytes[2];            // Bytes válidos de cada banda
+    off_t desplazamiento[2];    // Posición de la banda en el archivo
+    bool llena[2];              // Calculada y pendiente de escribir
+    bool terminado;             // Ya no se calcularán más bandas
+    bool error;                 // Falló una escritura
+    pthread_mutex_t mutex;
+    pthread_cond_t cambio;
+} EscrituraBandas;
+
+// Escribe todo el bloque en la posición dada, reintentando escrituras parciales
+static bool escribir_completo(int fd, const void* datos, size_t bytes, off_t desplazamiento) {
+    const char* p = (const char*)datos;
+    while (bytes > 0) {
+        ssize_t escritos = pwrite(fd, p, bytes, desplazamiento);
+        if (escritos < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += escritos;
+        bytes -= (size_t)escritos;
+        desplazamiento += escritos;
+    }
+    return true;
+}
+
+// Hilo escritor: vacía las bandas en el mismo orden en que se llenan
+static void* escribir_bandas(void* arg) {
+    EscrituraBandas* e = (EscrituraBandas*)arg;
+
+    for (int k = 0;; k ^= 1) {
+        pthread_mutex_lock(&e->mutex);
+        while (!e->llena[k] && !e->terminado) {
+            pthread_cond_wait(&e->cambio, &e->mutex);
+        }
+        if (!e->llena[k]) {
+            pthread_mutex_unlock(&e->mutex);
+            return NULL;
+        }
+        pthread_mutex_unlock(&e->mutex);
+
+        bool ok = escribir_completo(e->fd, e->bandas[k], e->bytes[k], e->desplazamiento[k]);
+
+        pthread_mutex_lock(&e->mutex);
+        e->llena[k] = false;
+        if (!ok) e->error = true;
+        pthread_cond_broadcast(&e->cambio);
+        pthread_mutex_unlock(&e->mutex);
+    }
+}
+
+bool generar_cuadro_en_archivo(int n, TipoAlgoritmo algoritmo, const char* ruta, bool validar,
+                               bool* es_valido, CallbackProgreso progreso, void* datos) {
+    // La fórmula cerrada permite calcular cualquier fila sin las anteriores
+    CuadroMagico* virtual = crear_cuadro_virtual(n, algoritmo);
+    if (!virtual) return false;
+
+    AnchoCelda ancho = virtual->ancho;
+    int filas_por_banda = (int)(BYTES_BANDA_GENERACION / ((size_t)n * ancho));
+    if (filas_por_banda < 1) filas_por_banda = 1;
+    if (filas_por_banda > n) filas_por_banda = n;
+    size_t celdas_banda = (size_t)filas_por_banda * n;
+
+    EscrituraBandas e;
+    memset(&e, 0, sizeof(e));
+    e.fd = open(ruta, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    e.bandas[0] = malloc(celdas_banda * ancho);
+    e.bandas[1] = malloc(celdas_banda * ancho);
+    long long* sumas_columna = validar ? (long long*)calloc((size_t)n, sizeof(long long)) : NULL;
+
+    bool ok = e.fd >= 0 && e.bandas[0] && e.bandas[1] && (!validar || sumas_columna);
+    pthread_t escritor;
+    bool escritor_lanzado = false;
+    if (ok) {
+        pthread_mutex_init(&e.mutex, NULL);
+        pthread_cond_init(&e.cambio, NULL);
+        escritor_lanzado = pthread_create(&escritor, NULL, escribir_bandas, &e) == 0;
+        ok = escritor_lanzado;
+    }
+
+    KernelFila kernel = seleccionar_kernel_fila(ancho);
+    long long suma_magica = virtual->suma_magica;
+    bool valido = true;
+    long long diagonal_principal = 0, diagonal_secundaria = 0;
+
+    for (int inicio = 0, k = 0; ok && inicio < n; inicio += filas_por_banda, k ^= 1) {
+        int fin = inicio + filas_por_banda < n ? inicio + filas_por_banda : n;
+
+        // Esperar a que el escritor libere esta banda
+        pthread_mutex_lock(&e.mutex);
+        while (e.llena[k] && !e.error) {
+            pthread_cond_wait(&e.cambio, &e.mutex);
+        }
+        ok = !e.error;
+        pthread_mutex_unlock(&e.mutex);
+        if (!ok) break;
+
+        for (int i = inicio; i < fin; i++) {
+            void* fila = (char*)e.bandas[k] + (size_t)(i - inicio) * n * ancho;
+            obtener_fila_cuadro(virtual, i, fila);
+            if (validar) {
+                if (kernel(fila, n, sumas_columna) != suma_magica) valido = false;
+                diagonal_principal += (long long)leer_celda(fila, ancho, (size_t)i);
+                diagonal_secundaria += (long long)leer_celda(fila, ancho, (size_t)(n - 1 - i));
+            }
+        }
+
+        pthread_mutex_lock(&e.mutex);
+        e.bytes[k] = (size_t)(fin - inicio) * n * ancho;
+        e.desplazamiento[k] = BYTES_CABECERA_CUADRO + (off_t)inicio * n * (off_t)ancho;
+        e.llena[k] = true;
+        pthread_cond_broadcast(&e.cambio);
+        pthread_mutex_unlock(&e.mutex);
+
+        if (progreso && !progreso((double)fin / n, datos)) ok = false;
+    }
+
+    if (escritor_lanzado) {
+        pthread_mutex_lock(&e.mutex);
+        e.terminado = true;
+        pthread_cond_broadcast(&e.cambio);
+        pthread_mutex_unlock(&e.mutex);
+        pthread_join(escritor, NULL);
+        if (e.error) ok = false;
+        pthread_cond_destroy(&e.cambio);
+        pthread_mutex_destroy(&e.mutex);
+    }
+
+    if (ok && validar) {
+        valido = valido && diagonal_principal == suma_magica && diagonal_secundaria == suma_magica;
+        for (int j = 0; j < n && valido; j++) {
+            if (sumas_columna[j] != suma_magica) valido = false;
+        }
+    }
+
+    // La cabecera va al final, cuando se sabe si el cuadro es válido
+    if (ok) {
+        virtual->es_valido = validar && valido;
+        CabeceraCuadro cabecera;
+        llenar_cabecera_cuadro(virtual, CODIFICACION_PLANA, (uint64_t)n * n * ancho, &cabecera);
+        ok = escribir_completo(e.fd, &cabecera, sizeof(cabecera), 0);
+    }
+    if (e.fd >= 0 && close(e.fd) != 0) ok = false;
+    if (!ok && e.fd >= 0) unlink(ruta);
+    if (ok && es_valido) *es_valido = validar && valido;
+
+    free(sumas_columna);
+    free(e.bandas[1]);
+    free(e.bandas[0]);
+    liberar_cuadro_magico(virtual);
+    return ok;
+}
@@ -0,0 +1,25 @@
+/*
+ * Generación fuera de memoria: el cuadro se escribe directo a un archivo
+ * .cmag plano, por bandas de filas consecutivas, sin tener nunca la matriz
+ * completa en memoria. Mientras un hilo escribe una banda al disco, el
+ * hilo que llama calcula la siguiente con la fórmula cerrada, y de paso
+ * acumula las sumas para validar el cuadro en la misma pasada.
+ */
+
+#ifndef GENERACION_BANDAS_H
+#define GENERACION_BANDAS_H
+
+#include <stdbool.h>
+#include "cuadros_magicos.h"
+
+// Bytes aproximados de cada banda; se usan dos a la vez
+#define BYTES_BANDA_GENERACION (8u << 20)
+
+// Genera el cuadro n×n del algoritmo en ruta. La memoria usada es de dos
+// bandas más n sumas de columna, sin importar n. Si validar es true, el
+// resultado queda en *es_valido y en la cabecera del archivo. El callback
+// de progreso se llama tras cada banda y puede cancelar (se borra el archivo).
+bool generar_cuadro_en_archivo(int n, TipoAlgoritmo algoritmo, const char* ruta, bool validar,
+                               bool* es_valido, CallbackProgreso progreso, void* datos);
+
+#endif // GENERACION_BANDAS_H
@@ -0,0 +1,487 @@
+/*
+ * Lienzo de cuadros mágicos: dibujo con cairo de las celdas visibles,
+ * desplazamiento y zoom
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include "lienzo_cuadro.h"
+
+#define TAM_CELDA_MINIMO 1.0      // Píxeles por celda con el zoom más lejano
+#define TAM_CELDA_MAXIMO 160.0
+#define TAM_CELDA_INICIAL 60.0    // Tamaño con que se muestran los cuadros pequeños
+#define TAM_CELDA_DETALLE 6.0     // Por debajo se pinta un píxel por celda
+#define TAM_FUENTE_MINIMO 6.0     // Por debajo no se escriben los números
+#define FACTOR_ZOOM 1.15          // Zoom por cada paso de la rueda
+
+struct LienzoCuadro {
+    GtkWidget* contenedor;
+    GtkWidget* area;
+    GtkAdjustment* ajuste_h;
+    GtkAdjustment* ajuste_v;
+
+    // Cuadro mostrado
+    int n;
+    FuenteCeldaLienzo fuente;
+    const void* datos;
+
+    double tam_celda;             // Píxeles por celda
+    bool ajustar_al_asignar;      // Calcular el zoom cuando el área tenga tamaño
+
+    // Arrastre con el botón izquierdo
+    bool arrastrando;
+    double arrastre_x, arrastre_y;
+    double arrastre_h, arrastre_v;
+};
+
+// Colores de fondo y de texto de cada estilo (los mismos del CSS anterior)
+static const double colores_fondo[LIENZO_NUM_ESTILOS][3] = {
+    {0xf5 / 255.0, 0xf5 / 255.0, 0xf5 / 255.0},
+    {0xe3 / 255.0, 0xf2 / 255.0, 0xfd / 255.0},
+    {0xff / 255.0, 0xeb / 255.0, 0x3b / 255.0},
+    {0xc8 / 255.0, 0xe6 / 255.0, 0xc9 / 255.0}
+};
+static const double colores_texto[LIENZO_NUM_ESTILOS][3] = {
+    {0x88 / 255.0, 0x88 / 255.0, 0x88 / 255.0},
+    {0x19 / 255.0, 0x76 / 255.0, 0xd2 / 255.0},
+    {0xf5 / 255.0, 0x7f / 255.0, 0x17 / 255.0},
+    {0x38 / 255.0, 0x8e / 255.0, 0x3c / 255.0}
+};
+
+// ============= GEOMETRÍA =============
+
+static double limitar(double valor, double minimo, double maximo) {
+    if (valor < minimo) return minimo;
+    if (valor > maximo) return maximo;
+    return valor;
+}
+
+// Posición en el área de la esquina superior izquierda del cuadro. Si el
+// cuadro cabe en un eje se centra; si no, manda el desplazamiento.
+static void obtener_origen(LienzoCuadro* lienzo, double* x, double* y) {
+    double total = lienzo->n * lienzo->tam_celda;
+    double ancho = gtk_widget_get_allocated_width(lienzo->area);
+    double alto = gtk_widget_get_allocated_height(lienzo->area);
+
+    *x = total < ancho ? (ancho - total) / 2 : -gtk_adjustment_get_value(lienzo->ajuste_h);
+    *y = total < alto ? (alto - total) / 2 : -gtk_adjustment_get_value(lienzo->ajuste_v);
+}
+
+// Configura un eje de desplazamiento con el valor pedido, ya acotado
+static void configurar_eje(GtkAdjustment* ajuste, double valor, double total, double pagina, double paso) {
+    if (pagina < 1) pagina = 1;
+    double maximo = total > pagina ? total - pagina : 0;
+    gtk_adjustment_configure(ajuste, limitar(valor, 0, maximo), 0,
+                             total > pagina ? total : pagina, paso, pagina * 0.9, pagina);
+}
+
+// Reconfigura las barras para el tamaño de celda actual
+static void actualizar_ajustes(LienzoCuadro* lienzo, double valor_h, double valor_v) {
+    double total = lienzo->n * lienzo->tam_celda;
+    double paso = lienzo->tam_celda > 20 ? lienzo->tam_celda : 20;
+
+    configurar_eje(lienzo->ajuste_h, valor_h, total,
+                   gtk_widget_get_allocated_width(lienzo->area), paso);
+    configurar_eje(lienzo->ajuste_v, valor_v, total,
+                   gtk_widget_get_allocated_height(lienzo->area), paso);
+}
+
+// Zoom que hace caber el cuadro en el área, sin agrandar los cuadros pequeños
+static void ajustar_zoom_al_area(LienzoCuadro* lienzo) {
+    int ancho = gtk_widget_get_allocated_width(lienzo->area);
+    int alto = gtk_widget_get_allocated_height(lienzo->area);
+    int lado = ancho < alto ? ancho : alto;
+
+    lienzo->tam_celda = limitar((double)lado / lienzo->n, TAM_CELDA_MINIMO, TAM_CELDA_INICIAL);
+    actualizar_ajustes(lienzo, 0, 0);
+}
+
+// Cambia el zoom manteniendo fija la celda que está bajo el punto (x, y)
+static void aplicar_zoom(LienzoCuadro* lienzo, double factor, double x, double y) {
+    if (lienzo->n == 0) return;
+
+    double tam_nuevo = limitar(lienzo->tam_celda * factor, TAM_CELDA_MINIMO, TAM_CELDA_MAXIMO);
+    if (tam_nuevo == lienzo->tam_celda) return;
+
+    double origen_x, origen_y;
+    obtener_origen(lienzo, &origen_x, &origen_y);
+    double u = (x - origen_x) / lienzo->tam_celda;
+    double v = (y - origen_y) / lienzo->tam_celda;
+
+    lienzo->tam_celda = tam_nuevo;
+    actualizar_ajustes(lienzo, u * tam_nuevo - x, v * tam_nuevo - y);
+    gtk_widget_queue_draw(lienzo->area);
+}
+
+// ============= DIBUJO =============
+
+static int contar_cifras(long long valor) {
+    int cifras = 1;
+    while (valor >= 10) {
+        valor /= 10;
+        cifras++;
+    }
+    return cifras;
+}
+
+// Con zoom cercano: rectángulo por celda, números y líneas de la cuadrícula
+static void dibujar_celdas(LienzoCuadro* lienzo, cairo_t* cr, double origen_x, double origen_y,
+                           int fila_ini, int fila_fin, int col_ini, int col_fin) {
+    double tc = lienzo->tam_celda;
+
+    // Fuente del tamaño que permite escribir el número más largo (n²)
+    int cifras = contar_cifras((long long)lienzo->n * lienzo->n);
+    double tam_fuente = tc * 0.4;
+    if (tam_fuente > tc * 0.85 / (cifras * 0.62)) tam_fuente = tc * 0.85 / (cifras * 0.62);
+    bool con_texto = tam_fuente >= TAM_FUENTE_MINIMO;
+
+    cairo_text_extents_t ext_cifra;
+    if (con_texto) {
+        cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
+        cairo_set_font_size(cr, tam_fuente);
+        cairo_text_extents(cr, "0", &ext_cifra);
+    }
+
+    for (int i = fila_ini; i <= fila_fin; i++) {
+        double y = origen_y + i * tc;
+        for (int j = col_ini; j <= col_fin; j++) {
+            double x = origen_x + j * tc;
+            EstiloCeldaLienzo estilo = LIENZO_CELDA_LLENA;
+            int valor = lienzo->fuente(lienzo->datos, i, j, &estilo);
+            if ((unsigned)estilo >= LIENZO_NUM_ESTILOS) estilo = LIENZO_CELDA_LLENA;
+
+            const double* fondo = colores_fondo[estilo];
+            cairo_set_source_rgb(cr, fondo[0], fondo[1], fondo[2]);
+            cairo_rectangle(cr, x, y, tc, tc);
+            cairo_fill(cr);
+
+            if (estilo == LIENZO_CELDA_ACTUAL && tc >= 12) {
+                cairo_set_source_rgb(cr, 0xff / 255.0, 0x98 / 255.0, 0x00 / 255.0);
+                cairo_set_line_width(cr, 2);
+                cairo_rectangle(cr, x + 2, y + 2, tc - 4, tc - 4);
+                cairo_stroke(cr);
+            }
+
+            if (con_texto && valor != 0) {
+                char texto[16];
+                cairo_text_extents_t ext;
+                snprintf(texto, sizeof(texto), "%d", valor);
+                cairo_text_extents(cr, texto, &ext);
+
+                const double* color = colores_texto[estilo];
+                cairo_set_source_rgb(cr, color[0], color[1], color[2]);
+                cairo_move_to(cr, x + (tc - ext.x_advance) / 2,
+                              y + (tc - ext_cifra.height) / 2 - ext_cifra.y_bearing);
+                cairo_show_text(cr, texto);
+            }
+        }
+    }
+
+    // Cuadrícula de la zona pintada
+    cairo_set_source_rgb(cr, 0x33 / 255.0, 0x33 / 255.0, 0x33 / 255.0);
+    cairo_set_line_width(cr, tc >= 24 ? 2 : 1);
+    double x0 = origen_x + col_ini * tc, x1 = origen_x + (col_fin + 1) * tc;
+    double y0 = origen_y + fila_ini * tc, y1 = origen_y + (fila_fin + 1) * tc;
+    for (int j = col_ini; j <= col_fin + 1; j++) {
+        cairo_move_to(cr, origen_x + j * tc, y0);
+        cairo_line_to(cr, origen_x + j * tc, y1);
+    }
+    for (int i = fila_ini; i <= fila_fin + 1; i++) {
+        cairo_move_to(cr, x0, origen_y + i * tc);
+        cairo_line_to(cr, x1, origen_y + i * tc);
+    }
+    cairo_stroke(cr);
+}
+
+// Color de una celda en el modo de un píxel por celda: las llenas van de
+// claro a oscuro según su valor, así se ve el patrón del cuadro
+static uint32_t color_pixel(EstiloCeldaLienzo estilo, double t) {
+    switch (estilo) {
+        case LIENZO_CELDA_VACIA:  return 0xf5f5f5;
+        case LIENZO_CELDA_ACTUAL: return 0xff9800;
+        case LIENZO_CELDA_ULTIMA: return 0x388e3c;
+        default: break;
+    }
+    uint32_t r = (uint32_t)(0xe3 + (0x0d - 0xe3) * t);
+    uint32_t g = (uint32_t)(0xf2 + (0x47 - 0xf2) * t);
+    uint32_t b = (uint32_t)(0xfd + (0xa1 - 0xfd) * t);
+    return (r << 16) | (g << 8) | b;
+}
+
+// Con zoom lejano: las celdas visibles se escriben como píxeles de una
+// imagen que cairo escala sin suavizar
+static void dibujar_pixeles(LienzoCuadro* lienzo, cairo_t* cr, double origen_x, double origen_y,
+                            int fila_ini, int fila_fin, int col_ini, int col_fin) {
+    int columnas = col_fin - col_ini + 1;
+    int filas = fila_fin - fila_ini + 1;
+
+    cairo_surface_t* imagen = cairo_image_surface_create(CAIRO_FORMAT_RGB24, columnas, filas);
+    if (cairo_surface_status(imagen) != CAIRO_STATUS_SUCCESS) {
+        cairo_surface_destroy(imagen);
+        return;
+    }
+
+    cairo_surface_flush(imagen);
+    unsigned char* pixeles = cairo_image_surface_get_data(imagen);
+    int stride = cairo_image_surface_get_stride(imagen);
+    double escala = 1.0 / ((double)lienzo->n * lienzo->n);
+
+    for (int i = fila_ini; i <= fila_fin; i++) {
+        uint32_t* destino = (uint32_t*)(pixeles + (size_t)(i - fila_ini) * stride);
+        for (int j = col_ini; j <= col_fin; j++) {
+            EstiloCeldaLienzo estilo = LIENZO_CELDA_LLENA;
+            int valor = lienzo->fuente(lienzo->datos, i, j, &estilo);
+            if (valor == 0) estilo = LIENZO_CELDA_VACIA;
+            destino[j - col_ini] = color_pixel(estilo, valor * escala);
+        }
+    }
+    cairo_surface_mark_dirty(imagen);
+
+    cairo_save(cr);
+    cairo_translate(cr, origen_x + col_ini * lienzo->tam_celda, origen_y + fila_ini * lienzo->tam_celda);
+    cairo_scale(cr, lienzo->tam_celda, lienzo->tam_celda);
+    cairo_set_source_surface(cr, imagen, 0, 0);
+    cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_NEAREST);
+    cairo_paint(cr);
+    cairo_restore(cr);
+
+    cairo_surface_destroy(imagen);
+}
+
+// Pinta solo las celdas que tocan la zona a redibujar
+static gboolean on_dibujar_lienzo(GtkWidget* area, cairo_t* cr, gpointer data) {
+    LienzoCuadro* lienzo = (LienzoCuadro*)data;
+
+    cairo_set_source_rgb(cr, 1, 1, 1);
+    cairo_paint(cr);
+    if (lienzo->n == 0 || !lienzo->fuente) return FALSE;
+
+    double x1, y1, x2, y2;
+    cairo_clip_extents(cr, &x1, &y1, &x2, &y2);
+
+    double origen_x, origen_y;
+    obtener_origen(lienzo, &origen_x, &origen_y);
+    double tc = lienzo->tam_celda;
+    int n = lienzo->n;
+
+    int col_ini = (int)limitar(floor((x1 - origen_x) / tc), 0, n - 1);
+    int col_fin = (int)limitar(ceil((x2 - origen_x) / tc) - 1, 0, n - 1);
+    int fila_ini = (int)limitar(floor((y1 - origen_y) / tc), 0, n - 1);
+    int fila_fin = (int)limitar(ceil((y2 - origen_y) / tc) - 1, 0, n - 1);
+    if (x2 <= origen_x || y2 <= origen_y || x1 >= origen_x + n * tc || y1 >= origen_y + n * tc) {
+        return FALSE;
+    }
+
+    if (tc >= TAM_CELDA_DETALLE) {
+        dibujar_celdas(lienzo, cr, origen_x, origen_y, fila_ini, fila_fin, col_ini, col_fin);
+    } else {
+        dibujar_pixeles(lienzo, cr, origen_x, origen_y, fila_ini, fila_fin, col_ini, col_fin);
+    }
+    return FALSE;
+}
+
+// ============= EVENTOS =============
+
+static void on_lienzo_asignado(GtkWidget* area, GdkRectangle* asignacion, gpointer data) {
+    LienzoCuadro* lienzo = (LienzoCuadro*)data;
+
+    if (lienzo->ajustar_al_asignar && lienzo->n > 0) {
+        lienzo->ajustar_al_asignar = false;
+        ajustar_zoom_al_area(lienzo);
+    } else {
+        actualizar_ajustes(lienzo, gtk_adjustment_get_value(lienzo->ajuste_h),
+                           gtk_adjustment_get_value(lienzo->ajuste_v));
+    }
+}
+
+static void on_ajuste_cambiado(GtkAdjustment* ajuste, gpointer data) {
+    LienzoCuadro* lienzo = (LienzoCuadro*)data;
+    gtk_widget_queue_draw(lienzo->area);
+}
+
+// Rueda: desplaza; con Mayús desplaza en horizontal; con Ctrl hace zoom
+static gboolean on_rueda_lienzo(GtkWidget* area, GdkEventScroll* evento, gpointer data) {
+    LienzoCuadro* lienzo = (LienzoCuadro*)data;
+    double dx = 0, dy = 0;
+
+    switch (evento->direction) {
+        case GDK_SCROLL_UP:    dy = -1; break;
+        case GDK_SCROLL_DOWN:  dy = 1;  break;
+        case GDK_SCROLL_LEFT:  dx = -1; break;
+        case GDK_SCROLL_RIGHT: dx = 1;  break;
+        case GDK_SCROLL_SMOOTH:
+            gdk_event_get_scroll_deltas((GdkEvent*)evento, &dx, &dy);
+            break;
+    }
+
+    if (evento->state & GDK_CONTROL_MASK) {
+        aplicar_zoom(lienzo, pow(FACTOR_ZOOM, -dy), evento->x, evento->y);
+        return TRUE;
+    }
+    if (evento->state & GDK_SHIFT_MASK) {
+        dx += dy;
+        dy = 0;
+    }
+
+    double paso = lienzo->tam_celda * 3 > 60 ? lienzo->tam_celda * 3 : 60;
+    gtk_adjustment_set_value(lienzo->ajuste_h, gtk_adjustment_get_value(lienzo->ajuste_h) + dx * paso);
+    gtk_adjustment_set_value(lienzo->ajuste_v, gtk_adjustment_get_value(lienzo->ajuste_v) + dy * paso);
+    return TRUE;
+}
+
+static gboolean on_boton_lienzo(GtkWidget* area, GdkEventButton* evento, gpointer data) {
+    LienzoCuadro* lienzo = (LienzoCuadro*)data;
+    if (evento->button != 1) return FALSE;
+
+    lienzo->arrastrando = evento->type != GDK_BUTTON_RELEASE;
+    lienzo->arrastre_x = evento->x;
+    lienzo->arrastre_y = evento->y;
+    lienzo->arrastre_h = gtk_adjustment_get_value(lienzo->ajuste_h);
+    lienzo->arrastre_v = gtk_adjustment_get_value(lienzo->ajuste_v);
+    return TRUE;
+}
+
+static gboolean on_movimiento_lienzo(GtkWidget* area, GdkEventMotion* evento, gpointer data) {
+    LienzoCuadro* lienzo = (LienzoCuadro*)data;
+    if (!lienzo->arrastrando) return FALSE;
+
+    gtk_adjustment_set_value(lienzo->ajuste_h, lienzo->arrastre_h - (evento->x - lienzo->arrastre_x));
+    gtk_adjustment_set_value(lienzo->ajuste_v, lienzo->arrastre_v - (evento->y - lienzo->arrastre_y));
+    return TRUE;
+}
+
+// Tooltip con la posición y el valor de la celda bajo el puntero; sirve
+// sobre todo cuando las celdas son demasiado pequeñas para el número
+static gboolean on_tooltip_lienzo(GtkWidget* area, gint x, gint y, gboolean teclado,
+                                  GtkTooltip* tooltip, gpointer data) {
+    LienzoCuadro* lienzo = (LienzoCuadro*)data;
+    if (lienzo->n == 0 || !lienzo->fuente) return FALSE;
+
+    double origen_x, origen_y;
+    obtener_origen(lienzo, &origen_x, &origen_y);
+    double u = floor((x - origen_x) / lienzo->tam_celda);
+    double v = floor((y - origen_y) / lienzo->tam_celda);
+    if (u < 0 || v < 0 || u >= lienzo->n || v >= lienzo->n) return FALSE;
+
+    EstiloCeldaLienzo estilo;
+    int valor = lienzo->fuente(lienzo->datos, (int)v, (int)u, &estilo);
+
+    char texto[64];
+    snprintf(texto, sizeof(texto), "(%d, %d): %d", (int)v + 1, (int)u + 1, valor);
+    gtk_tooltip_set_text(tooltip, texto);
+    return TRUE;
+}
+
+static void on_lienzo_destruido(GtkWidget* widget, gpointer data) {
+    g_free(data);
+}
+
+// ============= API =============
+
+LienzoCuadro* crear_lienzo_cuadro(void) {
+    LienzoCuadro* lienzo = g_new0(LienzoCuadro, 1);
+    lienzo->tam_celda = TAM_CELDA_INICIAL;
+
+    lienzo->ajuste_h = gtk_adjustment_new(0, 0, 1, 1, 1, 1);
+    lienzo->ajuste_v = gtk_adjustment_new(0, 0, 1, 1, 1, 1);
+
+    lienzo->area = gtk_drawing_area_new();
+    gtk_widget_set_hexpand(lienzo->area, TRUE);
+    gtk_widget_set_vexpand(lienzo->area, TRUE);
+    gtk_widget_set_size_request(lienzo->area, 200, 200);
+    gtk_widget_set_has_tooltip(lienzo->area, TRUE);
+    gtk_widget_add_events(lienzo->area, GDK_SCROLL_MASK | GDK_SMOOTH_SCROLL_MASK |
+                          GDK_BUTTON_PRESS_MASK | GDK_BUTTON_RELEASE_MASK |
+                          GDK_BUTTON1_MOTION_MASK);
+
+    // Área con una barra a la derecha y otra debajo
+    lienzo->contenedor = gtk_grid_new();
+    gtk_grid_attach(GTK_GRID(lienzo->contenedor), lienzo->area, 0, 0, 1, 1);
+    gtk_grid_attach(GTK_GRID(lienzo->contenedor),
+                    gtk_scrollbar_new(GTK_ORIENTATION_VERTICAL, lienzo->ajuste_v), 1, 0, 1, 1);
+    gtk_grid_attach(GTK_GRID(lienzo->contenedor),
+                    gtk_scrollbar_new(GTK_ORIENTATION_HORIZONTAL, lienzo->ajuste_h), 0, 1, 1, 1);
+
+    g_signal_connect(lienzo->area, "draw", G_CALLBACK(on_dibujar_lienzo), lienzo);
+    g_signal_connect(lienzo->area, "size-allocate", G_CALLBACK(on_lienzo_asignado), lienzo);
+    g_signal_connect(lienzo->area, "scroll-event", G_CALLBACK(on_rueda_lienzo), lienzo);
+    g_signal_connect(lienzo->area, "button-press-event", G_CALLBACK(on_boton_lienzo), lienzo);
+    g_signal_connect(lienzo->area, "button-release-event", G_CALLBACK(on_boton_lienzo), lienzo);
+    g_signal_connect(lienzo->area, "motion-notify-event", G_CALLBACK(on_movimiento_lienzo), lienzo);
+    g_signal_connect(lienzo->area, "query-tooltip", G_CALLBACK(on_tooltip_lienzo), lienzo);
+    g_signal_connect(lienzo->ajuste_h, "value-changed", G_CALLBACK(on_ajuste_cambiado), lienzo);
+    g_signal_connect(lienzo->ajuste_v, "value-changed", G_CALLBACK(on_ajuste_cambiado), lienzo);
+    g_signal_connect(lienzo->contenedor, "destroy", G_CALLBACK(on_lienzo_destruido), lienzo);
+
+    return lienzo;
+}
+
+GtkWidget* widget_lienzo_cuadro(LienzoCuadro* lienzo) {
+    return lienzo->contenedor;
+}
+
+void lienzo_mostrar_cuadro(LienzoCuadro* lienzo, int n, FuenteCeldaLienzo fuente, const void* datos) {
+    lienzo->n = n;
+    lienzo->fuente = fuente;
+    lienzo->datos = datos;
+
+    // Antes de la primera asignación el área todavía no tiene tamaño
+    if (gtk_widget_get_allocated_width(lienzo->area) > 1) {
+        ajustar_zoom_al_area(lienzo);
+    } else {
+        lienzo->ajustar_al_asignar = true;
+    }
+    gtk_widget_queue_draw(lienzo->area);
+}
+
+void lienzo_limpiar(LienzoCuadro* lienzo) {
+    lienzo->n = 0;
+    lienzo->fuente = NULL;
+    lienzo->datos = NULL;
+    actualizar_ajustes(lienzo, 0, 0);
+    gtk_widget_queue_draw(lienzo->area);
+}
+
+void lienzo_redibujar(LienzoCuadro* lienzo) {
+    gtk_widget_queue_draw(lienzo->area);
+}
+
+void lienzo_redibujar_celda(LienzoCuadro* lienzo, int fila, int columna) {
+    if (fila < 0 || columna < 0 || fila >= lienzo->n || columna >= lienzo->n) return;
+
+    double origen_x, origen_y;
+    obtener_origen(lienzo, &origen_x, &origen_y);
+    double x = origen_x + columna * lienzo->tam_celda;
+    double y = origen_y + fila * lienzo->tam_celda;
+
+    // Celdas fuera de la vista no se redibujan
+    if (x + lienzo->tam_celda < 0 || y + lienzo->tam_celda < 0 ||
+        x > gtk_widget_get_allocated_width(lienzo->area) ||
+        y > gtk_widget_get_allocated_height(lienzo->area)) {
+        return;
+    }
+
+    // Un píxel de margen para la línea de la cuadrícula
+    gtk_widget_queue_draw_area(lienzo->area, (int)floor(x) - 1, (int)floor(y) - 1,
+                               (int)ceil(lienzo->tam_celda) + 3, (int)ceil(lienzo->tam_celda) + 3);
+}
+
+void lienzo_mostrar_celda(LienzoCuadro* lienzo, int fila, int columna) {
+    if (fila < 0 || columna < 0 || fila >= lienzo->n || columna >= lienzo->n) return;
+
+    double tc = lienzo->tam_celda;
+    double h = gtk_adjustment_get_value(lienzo->ajuste_h);
+    double v = gtk_adjustment_get_value(lienzo->ajuste_v);
+    double ancho = gtk_adjustment_get_page_size(lienzo->ajuste_h);
+    double alto = gtk_adjustment_get_page_size(lienzo->ajuste_v);
+
+    if (columna * tc < h) h = columna * tc;
+    else if ((columna + 1) * tc > h + ancho) h = (columna + 1) * tc - ancho;
+    if (fila * tc < v) v = fila * tc;
+    else if ((fila + 1) * tc > v + alto) v = (fila + 1) * tc - alto;
+
+    gtk_adjustment_set_value(lienzo->ajuste_h, h);
+    gtk_adjustment_set_value(lienzo->ajuste_v, v);
+}
@@ -0,0 +1,47 @@
+/*
+ * Lienzo para dibujar cuadros mágicos con cairo.
+ *
+ * Un solo GtkDrawingArea pinta únicamente las celdas visibles, así que la
+ * cantidad de widgets y el tiempo de dibujo no crecen con n². Se desplaza
+ * con la rueda, las barras o arrastrando con el ratón, y Ctrl+rueda hace
+ * zoom alrededor del puntero.
+ */
+
+#ifndef LIENZO_CUADRO_H
+#define LIENZO_CUADRO_H
+
+#include <gtk/gtk.h>
+
+// Estilo con que se pinta una celda
+typedef enum {
+    LIENZO_CELDA_VACIA = 0,
+    LIENZO_CELDA_LLENA,
+    LIENZO_CELDA_ACTUAL,
+    LIENZO_CELDA_ULTIMA,
+    LIENZO_NUM_ESTILOS
+} EstiloCeldaLienzo;
+
+// Devuelve el valor de una celda (0 si está vacía) y escribe su estilo
+typedef int (*FuenteCeldaLienzo)(const void* datos, int fila, int columna, EstiloCeldaLienzo* estilo);
+
+typedef struct LienzoCuadro LienzoCuadro;
+
+// Crea el lienzo; se libera solo cuando se destruye su widget
+LienzoCuadro* crear_lienzo_cuadro(void);
+
+// Widget contenedor (área de dibujo y barras de desplazamiento)
+GtkWidget* widget_lienzo_cuadro(LienzoCuadro* lienzo);
+
+// Muestra un cuadro de n×n cuyas celdas entrega la fuente. Los datos deben
+// seguir vivos hasta que se muestre otro cuadro o se limpie el lienzo.
+void lienzo_mostrar_cuadro(LienzoCuadro* lienzo, int n, FuenteCeldaLienzo fuente, const void* datos);
+void lienzo_limpiar(LienzoCuadro* lienzo);
+
+// Vuelve a pintar todo el cuadro o solo una celda
+void lienzo_redibujar(LienzoCuadro* lienzo);
+void lienzo_redibujar_celda(LienzoCuadro* lienzo, int fila, int columna);
+
+// Desplaza la vista lo justo para que la celda quede visible
+void lienzo_mostrar_celda(LienzoCuadro* lienzo, int fila, int columna);
+
+#endif // LIENZO_CUADRO_H
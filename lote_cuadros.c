@@ -0,0 +1,154 @@
+/*
+ * Lote de cuadros: un bloque contiguo y una generación por forma distinta
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "lote_cuadros.h"
+
+// Alineación de cada región y de las celdas de cada cuadro
+#define ALINEACION_LOTE 64
+
+// Partes del bloque de un lote, como desplazamientos desde su inicio
+typedef struct {
+    size_t cuadros;
+    size_t origen;
+    size_t tabla;
+    size_t celdas;
+    size_t total;
+    unsigned int mascara_tabla;     // Ranuras de la tabla de formas - 1
+} DistribucionLote;
+
+static size_t alinear(size_t bytes) {
+    return (bytes + ALINEACION_LOTE - 1) & ~(size_t)(ALINEACION_LOTE - 1);
+}
+
+// Calcula dónde va cada parte del bloque; false si algún pedido no es válido
+static bool distribuir_lote(const PedidoCuadro* pedidos, int cantidad, DistribucionLote* d) {
+    if (!pedidos || cantidad < 1) return false;
+
+    // La tabla de formas tiene al menos el doble de ranuras que pedidos
+    unsigned int ranuras = 16;
+    while (ranuras < 2u * (unsigned int)cantidad) ranuras <<= 1;
+    d->mascara_tabla = ranuras - 1;
+
+    d->cuadros = 0;
+    d->origen = alinear(sizeof(CuadroMagico) * cantidad);
+    d->tabla = d->origen + alinear(sizeof(int) * cantidad);
+    d->celdas = d->tabla + alinear(sizeof(int) * ranuras);
+
+    size_t total = d->celdas;
+    for (int i = 0; i < cantidad; i++) {
+        if (!orden_valido_para_algoritmo(pedidos[i].tamaño, pedidos[i].algoritmo)) return false;
+        total += alinear(bytes_celdas_cuadro(pedidos[i].tamaño));
+    }
+    d->total = total;
+    return true;
+}
+
+size_t bytes_lote_cuadros(const PedidoCuadro* pedidos, int cantidad) {
+    DistribucionLote d;
+    return distribuir_lote(pedidos, cantidad, &d) ? d.total : 0;
+}
+
+// Ranura de la tabla donde empieza la búsqueda de una forma
+static unsigned int ranura_forma(const PedidoCuadro* pedido, unsigned int mascara) {
+    unsigned int clave = (unsigned int)pedido->tamaño * 8u + (unsigned int)pedido->algoritmo;
+    return (clave * 2654435761u) & mascara;
+}
+
+// Devuelve el primer pedido con la misma forma que pedidos[i], o i si es el
+// primero. La tabla guarda índice + 1 (0 es una ranura libre).
+static int buscar_forma(const PedidoCuadro* pedidos, int i, int* tabla, unsigned int mascara) {
+    unsigned int ranura = ranura_forma(&pedidos[i], mascara);
+    while (tabla[ranura] != 0) {
+        int previo = tabla[ranura] - 1;
+        if (pedidos[previo].tamaño == pedidos[i].tamaño &&
+            pedidos[previo].algoritmo == pedidos[i].algoritmo) {
+            return previo;
+        }
+        ranura = (ranura + 1) & mascara;
+    }
+    tabla[ranura] = i + 1;
+    return i;
+}
+
+bool generar_lote_cuadros(LoteCuadros* lote, const PedidoCuadro* pedidos, int cantidad,
+                          void* bloque, size_t capacidad, bool validar) {
+    DistribucionLote d;
+    if (!lote || !bloque || !distribuir_lote(pedidos, cantidad, &d) || capacidad < d.total) {
+        return false;
+    }
+
+    char* base = (char*)bloque;
+    lote->cuadros = (CuadroMagico*)(base + d.cuadros);
+    lote->origen = (int*)(base + d.origen);
+    lote->cantidad = cantidad;
+    lote->validado = false;
+
+    int* tabla = (int*)(base + d.tabla);
+    memset(tabla, 0, sizeof(int) * (d.mascara_tabla + 1));
+
+    size_t desplazamiento = d.celdas;
+    for (int i = 0; i < cantidad; i++) {
+        size_t bytes = bytes_celdas_cuadro(pedidos[i].tamaño);
+        void* celdas = base + desplazamiento;
+        desplazamiento += alinear(bytes);
+
+        int origen = buscar_forma(pedidos, i, tabla, d.mascara_tabla);
+        lote->origen[i] = origen;
+
+        if (origen == i) {
+            if (!generar_cuadro_en_buffer(&lote->cuadros[i], celdas, bytes, pedidos[i].tamaño,
+                                          pedidos[i].algoritmo, NULL, NULL)) {
+                return false;
+            }
+        } else {
+            // Misma forma que un cuadro anterior: se copian sus celdas
+            lote->cuadros[i] = lote->cuadros[origen];
+            lote->cuadros[i].matriz = celdas;
+            memcpy(celdas, lote->cuadros[origen].matriz, bytes);
+        }
+    }
+
+    if (validar) validar_lote_cuadros(lote);
+    return true;
+}
+
+void validar_lote_cuadros(LoteCuadros* lote) {
+    // Los originales siempre van antes que sus copias
+    for (int i = 0; i < lote->cantidad; i++) {
+        int origen = lote->origen[i];
+        if (origen == i) {
+            lote->cuadros[i].es_valido = validar_cuadro_magico(&lote->cuadros[i]);
+        } else {
+            lote->cuadros[i].es_valido = lote->cuadros[origen].es_valido;
+        }
+    }
+    lote->validado = true;
+}
+
+LoteCuadros* crear_lote_cuadros(const PedidoCuadro* pedidos, int cantidad, bool validar) {
+    size_t bytes = bytes_lote_cuadros(pedidos, cantidad);
+    if (bytes == 0) return NULL;
+
+    // La estructura del lote va delante del bloque, en la misma reserva
+    size_t cabecera = alinear(sizeof(LoteCuadros));
+    char* memoria = (char*)malloc(cabecera + bytes + ALINEACION_LOTE);
+    if (!memoria) return NULL;
+
+    // malloc solo garantiza 16 bytes; el bloque se alinea a mano
+    char* bloque = memoria + cabecera;
+    bloque += (ALINEACION_LOTE - ((size_t)bloque & (ALINEACION_LOTE - 1))) & (ALINEACION_LOTE - 1);
+
+    LoteCuadros* lote = (LoteCuadros*)memoria;
+    if (!generar_lote_cuadros(lote, pedidos, cantidad, bloque, bytes, validar)) {
+        free(memoria);
+        return NULL;
+    }
+    return lote;
+}
+
+void liberar_lote_cuadros(LoteCuadros* lote) {
+    free(lote);
+}
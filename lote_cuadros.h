@@ -0,0 +1,46 @@
+/*
+ * Generación de muchos cuadros mágicos en una sola llamada.
+ *
+ * Los pedidos (orden, algoritmo) se resuelven dentro de un único bloque
+ * contiguo: las estructuras, la tabla de formas y todas las celdas. Los
+ * pedidos con la misma forma comparten el trabajo: el primero se genera
+ * (y se valida) y los demás se copian de él. La validación se puede
+ * dejar para después con validar_lote_cuadros.
+ */
+
+#ifndef LOTE_CUADROS_H
+#define LOTE_CUADROS_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "cuadros_magicos.h"
+
+// Un cuadro pedido al lote
+typedef struct {
+    int tamaño;
+    TipoAlgoritmo algoritmo;
+} PedidoCuadro;
+
+typedef struct {
+    CuadroMagico* cuadros;  // Un cuadro por pedido, en el mismo orden
+    int* origen;            // Pedido del que se copió cada cuadro (él mismo si se generó)
+    int cantidad;
+    bool validado;
+} LoteCuadros;
+
+// Bytes que necesita el bloque de un lote (0 si algún pedido no es válido)
+size_t bytes_lote_cuadros(const PedidoCuadro* pedidos, int cantidad);
+
+// Genera el lote dentro de bloque, que es del llamador. Si validar es
+// false los cuadros quedan sin validar hasta llamar a validar_lote_cuadros.
+bool generar_lote_cuadros(LoteCuadros* lote, const PedidoCuadro* pedidos, int cantidad,
+                          void* bloque, size_t capacidad, bool validar);
+
+// Valida una sola vez cada forma distinta del lote
+void validar_lote_cuadros(LoteCuadros* lote);
+
+// Igual que generar_lote_cuadros, pero con el bloque en una sola reserva
+LoteCuadros* crear_lote_cuadros(const PedidoCuadro* pedidos, int cantidad, bool validar);
+void liberar_lote_cuadros(LoteCuadros* lote);
+
+#endif // LOTE_CUADROS_H
@@ -2,6 +2,8 @@
 #include <stdlib.h>
 #include "cuadros_magicos.h"
 #include "movimientos.h"  // Incluir aquí las funciones de movimientos
+#include "modo_lote.h"
+#include "salida.h"
 
 void mostrar_menu() {
     printf("\n=== GENERADOR DE CUADROS MÁGICOS ===\n");
@@ -10,6 +12,8 @@ void mostrar_menu() {
     printf("3. Método De la Loubère\n");
     printf("4. Método L\n");
     printf("5. Método Alterno\n");
+    printf("6. Doblemente par (órdenes 4, 8, 12, ...)\n");
+    printf("7. Simplemente par (órdenes 6, 10, 14, ...)\n");
     printf("0. Salir\n");
     printf("=====================================\n");
 }
@@ -19,7 +23,7 @@ TipoAlgoritmo obtener_algoritmo_consola() {
     
     do {
         mostrar_menu();
-        printf("Seleccione un algoritmo (0-5): ");
+        printf("Seleccione un algoritmo (0-7): ");
         
         if (scanf("%d", &opcion) != 1) {
             printf("Error: Entrada inválida.\n");
@@ -35,6 +39,8 @@ TipoAlgoritmo obtener_algoritmo_consola() {
             case 3: return ALGORITMO_LOUBERE;
             case 4: return ALGORITMO_L;
             case 5: return ALGORITMO_ALTERNO;
+            case 6: return ALGORITMO_PAR_DOBLE;
+            case 7: return ALGORITMO_PAR_SIMPLE;
             case 0: 
                 printf("¡Hasta luego!\n");
                 exit(0);
@@ -44,11 +50,14 @@ TipoAlgoritmo obtener_algoritmo_consola() {
     } while (1);
 }
 
-int obtener_tamaño_consola() {
+// Pide un tamaño que sirva para el algoritmo elegido
+int obtener_tamaño_consola(TipoAlgoritmo algoritmo) {
     int tamaño;
+    const char* paridad = algoritmo == ALGORITMO_PAR_DOBLE ? "múltiplo de 4" :
+                          algoritmo == ALGORITMO_PAR_SIMPLE ? "par, no múltiplo de 4" : "impar";
     
     do {
-        printf("\nIngrese el tamaño del cuadro (número impar entre 3 y %d): ", max);
+        printf("\nIngrese el tamaño del cuadro (%s, entre 3 y %d): ", paridad, MAX_ORDEN);
         
         if (scanf("%d", &tamaño) != 1) {
             printf("Error: Entrada inválida.\n");
@@ -58,13 +67,13 @@ int obtener_tamaño_consola() {
             continue;
         }
         
-        if (tamaño < 3 || tamaño > max) {
-            printf("Error: El tamaño debe estar entre 3 y %d.\n", max);
+        if (tamaño < 3 || tamaño > MAX_ORDEN) {
+            printf("Error: El tamaño debe estar entre 3 y %d.\n", MAX_ORDEN);
             continue;
         }
         
-        if (tamaño % 2 == 0) {
-            printf("Error: El tamaño debe ser un número impar.\n");
+        if (!orden_valido_para_algoritmo(tamaño, algoritmo)) {
+            printf("Error: El tamaño debe ser %s para este algoritmo.\n", paridad);
             continue;
         }
         
@@ -73,6 +82,18 @@ int obtener_tamaño_consola() {
     } while (1);
 }
 
+// Escribe "  <etiqueta> <k>: <suma> ✓|✗" en el escritor
+static void escribir_suma(EscritorSalida* escritor, const char* etiqueta, int indice,
+                          long long suma, long long suma_esperada) {
+    escritor_texto(escritor, etiqueta);
+    escritor_entero(escritor, (unsigned long long)indice, 0);
+    escritor_texto(escritor, ": ");
+    escritor_entero_con_signo(escritor, suma);
+    escritor_texto(escritor, (suma == suma_esperada) ? " ✓\n" : " ✗\n");
+}
+
+// Las sumas se calculan en una sola pasada por filas y el reporte se escribe
+// con el escritor de salida.h en lugar de un printf por línea
 void mostrar_estadisticas_detalladas(CuadroMagico* cuadro) {
     if (!cuadro) {
         printf("Error: Cuadro mágico inválido.\n");
@@ -80,52 +101,67 @@ void mostrar_estadisticas_detalladas(CuadroMagico* cuadro) {
     }
     
     int n = cuadro->tamaño;
-    int suma_esperada = cuadro->suma_magica;
+    long long suma_esperada = cuadro->suma_magica;
     
-    printf("\n=== ESTADÍSTICAS DETALLADAS ===\n");
-    printf("Tamaño: %dx%d\n", n, n);
-    printf("Suma mágica esperada: %d\n", suma_esperada);
-    printf("Estado: %s\n", cuadro->es_valido ? "VÁLIDO ✓" : "INVÁLIDO ✗");
+    long long* fila = (long long*)malloc((size_t)n * sizeof(long long));
+    long long* sumas_fila = (long long*)malloc((size_t)n * sizeof(long long));
+    long long* sumas_columna = (long long*)calloc((size_t)n, sizeof(long long));
+    EscritorSalida* escritor = (EscritorSalida*)malloc(sizeof(EscritorSalida));
+    if (!fila || !sumas_fila || !sumas_columna || !escritor) {
+        free(fila);
+        free(sumas_fila);
+        free(sumas_columna);
+        free(escritor);
+        printf("Error: No hay memoria para las estadísticas.\n");
+        return;
+    }
     
-    // Verificar sumas de filas
-    printf("\nSumas por fila:\n");
+    long long suma_diag_principal = 0;
+    long long suma_diag_secundaria = 0;
     for (int i = 0; i < n; i++) {
-        int suma = 0;
+        obtener_fila_valores(cuadro, i, fila);
+        long long suma = 0;
         for (int j = 0; j < n; j++) {
-            suma += cuadro->matriz[i][j];
+            suma += fila[j];
+            sumas_columna[j] += fila[j];
         }
-        printf("  Fila %d: %d %s\n", i+1, suma, 
-               (suma == suma_esperada) ? "✓" : "✗");
+        sumas_fila[i] = suma;
+        suma_diag_principal += fila[i];
+        suma_diag_secundaria += fila[n - 1 - i];
     }
     
-    // Verificar sumas de columnas
-    printf("\nSumas por columna:\n");
-    for (int j = 0; j < n; j++) {
-        int suma = 0;
-        for (int i = 0; i < n; i++) {
-            suma += cuadro->matriz[i][j];
-        }
-        printf("  Columna %d: %d %s\n", j+1, suma, 
-               (suma == suma_esperada) ? "✓" : "✗");
-    }
+    printf("\n=== ESTADÍSTICAS DETALLADAS ===\n");
+    printf("Tamaño: %dx%d\n", n, n);
+    printf("Suma mágica esperada: %lld\n", suma_esperada);
+    printf("Estado: %s\n", cuadro->es_valido ? "VÁLIDO ✓" : "INVÁLIDO ✗");
+    
+    escritor_iniciar(escritor, stdout);
     
-    // Verificar diagonal principal
-    int suma_diag_principal = 0;
+    // Sumas de filas
+    escritor_texto(escritor, "\nSumas por fila:\n");
     for (int i = 0; i < n; i++) {
-        suma_diag_principal += cuadro->matriz[i][i];
+        escribir_suma(escritor, "  Fila ", i + 1, sumas_fila[i], suma_esperada);
     }
-    printf("\nDiagonal principal: %d %s\n", suma_diag_principal,
-           (suma_diag_principal == suma_esperada) ? "✓" : "✗");
     
-    // Verificar diagonal secundaria
-    int suma_diag_secundaria = 0;
-    for (int i = 0; i < n; i++) {
-        suma_diag_secundaria += cuadro->matriz[i][n - 1 - i];
+    // Sumas de columnas
+    escritor_texto(escritor, "\nSumas por columna:\n");
+    for (int j = 0; j < n; j++) {
+        escribir_suma(escritor, "  Columna ", j + 1, sumas_columna[j], suma_esperada);
     }
-    printf("Diagonal secundaria: %d %s\n", suma_diag_secundaria,
+    escritor_vaciar(escritor);
+    
+    // Diagonales
+    printf("\nDiagonal principal: %lld %s\n", suma_diag_principal,
+           (suma_diag_principal == suma_esperada) ? "✓" : "✗");
+    printf("Diagonal secundaria: %lld %s\n", suma_diag_secundaria,
            (suma_diag_secundaria == suma_esperada) ? "✓" : "✗");
     
     printf("===============================\n");
+    
+    free(escritor);
+    free(sumas_columna);
+    free(sumas_fila);
+    free(fila);
 }
 
 void mostrar_informacion_algoritmo(TipoAlgoritmo algoritmo) {
@@ -162,11 +198,28 @@ void mostrar_informacion_algoritmo(TipoAlgoritmo algoritmo) {
             printf("Break-move: Hacia abajo cuando encuentra celda ocupada\n");
             printf("Características: Variante alternativa de diagonales\n");
             break;
+        case ALGORITMO_PAR_DOBLE:
+            printf("Algoritmo: Doblemente par\n");
+            printf("Descripción: Números en orden, fila por fila\n");
+            printf("Complemento: n² + 1 - k en las diagonales de cada bloque de 4x4\n");
+            printf("Características: Solo para órdenes múltiplos de 4\n");
+            break;
+        case ALGORITMO_PAR_SIMPLE:
+            printf("Algoritmo: Simplemente par (LUX de Conway)\n");
+            printf("Descripción: Cuadro siamés de orden n/2, cada celda en un bloque de 2x2\n");
+            printf("Bloques: Patrones L, U y X según la fila del bloque\n");
+            printf("Características: Solo para órdenes pares no múltiplos de 4\n");
+            break;
     }
     printf("================================\n");
 }
 
-int main() {
+int main(int argc, char *argv[]) {
+    // Con argumentos se ejecuta el modo por lotes, sin menús ni preguntas
+    if (argc > 1) {
+        return ejecutar_modo_lote(argc, argv);
+    }
+    
     printf("=== BIENVENIDO AL GENERADOR DE CUADROS MÁGICOS ===\n");
     printf("Implementación de algoritmos para cuadros mágicos\n");
     printf("Incluyendo el algoritmo de Robert T. Kurosaka\n");
@@ -180,7 +233,7 @@ int main() {
         mostrar_informacion_algoritmo(algoritmo);
         
         // Obtener tamaño
-        int tamaño = obtener_tamaño_consola();
+        int tamaño = obtener_tamaño_consola(algoritmo);
         
         printf("\nGenerando cuadro mágico %dx%d...\n", tamaño, tamaño);
         
@@ -210,7 +263,7 @@ int main() {
             
         } else {
             printf("Error: No se pudo generar el cuadro mágico.\n");
-            printf("Verifique que el tamaño sea válido (impar, entre 3 y %d).\n", max);
+            printf("Verifique que el tamaño sea válido (entre 3 y %d, con la paridad del algoritmo).\n", MAX_ORDEN);
         }
     }
     
@@ -11,100 +11,16 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include "cuadros_magicos.h"
+#include "lienzo_cuadro.h"
 
-#define max 21  // Tamaño máximo para la matriz
-
-// ============= FUNCIONES DE MOVIMIENTOS =============
-
-// Método Siamés clásico: mueve en diagonal izquierda-abajo y ajusta si está ocupado
-int metodoSiames(int matriz[max][max], int n, int fila, int columna) {
-    int nuevaFila = (fila - 1 + n) % n;
-    int nuevaColumna = (columna + 1) % n;
-
-    if (matriz[nuevaFila][nuevaColumna] != 0) { 
-        nuevaFila = (fila + 1) % n;
-        nuevaColumna = columna;
-    }
-
-    return nuevaFila * max + nuevaColumna;
-}
-
-// Método en L: movimiento en forma de caballo del ajedrez
-int metodoEnL(int matriz[max][max], int n, int fila, int columna) {
-    int nuevaFila = (fila - 2 + n) % n;
-    int nuevaColumna = (columna + 1) % n;
-    if (matriz[nuevaFila][nuevaColumna] != 0) {
-        nuevaFila = (fila + 1) % n;
-        nuevaColumna = columna;
-    }
-    return nuevaFila * max + nuevaColumna;
-}
-
-// Método De la Loubère: mueve en diagonal derecha-arriba y ajusta si está ocupado
-int metodoLouber(int matriz[max][max], int n, int fila, int columna) {
-    int nuevaFila = (fila + 1) % n;
-    int nuevaColumna = (columna - 1 + n) % n;
-
-    if (matriz[nuevaFila][nuevaColumna] != 0) {
-        nuevaFila = (fila - 1 + n) % n;
-        nuevaColumna = columna;
-    }
-
-    return nuevaFila * max + nuevaColumna;
-}
-
-// Método Alterno de Diagonales: variante del método siamés
-int metodoAlterno(int matriz[max][max], int n, int fila, int columna) {
-    int nuevaFila = (fila - 1 + n) % n;
-    int nuevaColumna = (columna - 1 + n) % n;
-    if (matriz[nuevaFila][nuevaColumna] != 0) {
-        nuevaFila = (fila + 1) % n;
-        nuevaColumna = columna;
-    }
-    return nuevaFila * max + nuevaColumna;
-}
-
-// ============= ALGORITMO DE KUROSAKA =============
-
-// Implementación del algoritmo de Kurosaka (movimiento noreste con break-move)
-int metodo_kurosaka(int matriz[max][max], int n, int fila, int columna) {
-    // Movimiento noreste: arriba (-1) y derecha (+1)
-    int nuevaFila = (fila - 1 + n) % n;
-    int nuevaColumna = (columna + 1) % n;
-    
-    // Si la celda está ocupada, aplicar break-move (mover hacia abajo)
-    if (matriz[nuevaFila][nuevaColumna] != 0) {
-        nuevaFila = (fila + 1) % n;
-        nuevaColumna = columna;
-    }
-    
-    return nuevaFila * max + nuevaColumna;
-}
-
-// ============= ESTRUCTURAS Y ENUMS =============
-
-// Estructura para almacenar información del cuadro mágico
-typedef struct {
-    int matriz[max][max];
-    int tamaño;
-    int suma_magica;
-    bool es_valido;
-} CuadroMagico;
-
-// Enumeración para los diferentes algoritmos
-typedef enum {
-    ALGORITMO_KUROSAKA,
-    ALGORITMO_SIAMES,
-    ALGORITMO_LOUBERE,
-    ALGORITMO_L,
-    ALGORITMO_ALTERNO
-} TipoAlgoritmo;
+// ============= ESTRUCTURAS =============
 
 // Estructura para manejar los widgets de la aplicación
 typedef struct {
     GtkWidget *main_window;
     GtkWidget *size_spin;
-    GtkWidget *magic_square_grid;
+    LienzoCuadro *lienzo;
     GtkWidget *status_label;
     GtkWidget *validation_label;
     GtkWidget *validate_button;
@@ -115,325 +31,393 @@ typedef struct {
     GtkWidget *loubere_radio;
     GtkWidget *l_radio;
     GtkWidget *alterno_radio;
-    
-    // Cuadro mágico actual
+    GtkWidget *par_doble_radio;
+    GtkWidget *par_simple_radio;
+    
+    // Generación en segundo plano
+    GtkWidget *generate_button;
+    GtkWidget *cancel_button;
+    GtkWidget *progress_bar;
+    GTask *tarea_actual;             // Tarea en curso (NULL si no hay)
+    GCancellable *cancelable;
+    guint progreso_timeout_id;
+    
+    // Dos ranuras de cuadro que conservan sus celdas entre generaciones:
+    // el hilo llena la que no se está mostrando, así que un clic en
+    // "Generar" solo reserva memoria si el cuadro nuevo es más grande
+    CuadroMagico cuadros[2];
+    void *celdas[2];
+    size_t capacidad_celdas[2];
+    int ranura_actual;
+    
+    // Cuadro mágico actual (&cuadros[ranura_actual] o NULL)
     CuadroMagico *cuadro_actual;
 } AppWidgets;
 
-// ============= FUNCIONES AUXILIARES =============
+// Trabajo que se ejecuta en segundo plano (generación o validación)
+typedef struct {
+    int tamaño;
+    TipoAlgoritmo algoritmo;
+    int ranura;                      // Ranura de AppWidgets donde se genera o que se valida
+    CuadroMagico *cuadro;
+    bool solo_validar;               // Valida el cuadro mostrado en vez de generar
+    void *celdas;
+    size_t capacidad;
+    GCancellable *cancelable;
+    gint progreso_milesimas;         // Lo escribe el hilo, lo lee el bucle principal
+    gint64 tiempo_generacion_us;
+    gint64 tiempo_validacion_us;
+} TrabajoGeneracion;
+
+// ============= FUNCIONES GTK =============
 
-// Limpia la matriz inicializándola con ceros
-void limpiar_matriz(int matriz[max][max], int n) {
-    for (int i = 0; i < n; i++) {
-        for (int j = 0; j < n; j++) {
-            matriz[i][j] = 0;
-        }
-    }
-}
+// Variables globales
+static AppWidgets *app_widgets = NULL;
 
-// Calcula la suma mágica para un cuadro de tamaño n
-int calcular_suma_magica(int n) {
-    return (n * (n * n + 1)) / 2;
+// Fuente de celdas del lienzo: todas las celdas del cuadro están llenas
+static int celda_para_lienzo(const void *datos, int fila, int columna, EstiloCeldaLienzo *estilo) {
+    *estilo = LIENZO_CELDA_LLENA;
+    // El .glade limita el orden a 46339, así que n² cabe en un int
+    return (int)celda_cuadro_magico((const CuadroMagico*)datos, fila, columna);
 }
 
-// Obtiene la posición de inicio según el algoritmo seleccionado
-void obtener_posicion_inicio(int n, TipoAlgoritmo algoritmo, int* fila, int* columna) {
-    // Para evitar warning de parámetro no usado
-    (void)algoritmo;
-    
-    // Todos los algoritmos empiezan en el centro de la primera fila
-    *fila = 0;
-    *columna = n / 2;
+// Función para mostrar el cuadro mágico en el lienzo
+void mostrar_cuadro_en_lienzo(CuadroMagico *cuadro, LienzoCuadro *lienzo) {
+    if (!cuadro || !lienzo) return;
+    
+    lienzo_mostrar_cuadro(lienzo, cuadro->tamaño, celda_para_lienzo, cuadro);
 }
 
-// Valida si la suma de una fila es correcta
-bool validar_suma_fila(int matriz[max][max], int n, int fila, int suma_esperada) {
-    int suma = 0;
-    for (int j = 0; j < n; j++) {
-        suma += matriz[fila][j];
+// Función para obtener el algoritmo seleccionado
+TipoAlgoritmo obtener_algoritmo_seleccionado(AppWidgets *widgets) {
+    if (gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widgets->kurosaka_radio))) {
+        return ALGORITMO_KUROSAKA;
+    } else if (gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widgets->siames_radio))) {
+        return ALGORITMO_SIAMES;
+    } else if (gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widgets->loubere_radio))) {
+        return ALGORITMO_LOUBERE;
+    } else if (gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widgets->l_radio))) {
+        return ALGORITMO_L;
+    } else if (gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widgets->alterno_radio))) {
+        return ALGORITMO_ALTERNO;
+    } else if (gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widgets->par_doble_radio))) {
+        return ALGORITMO_PAR_DOBLE;
+    } else if (gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widgets->par_simple_radio))) {
+        return ALGORITMO_PAR_SIMPLE;
     }
-    return suma == suma_esperada;
+    return ALGORITMO_KUROSAKA; // Por defecto
 }
 
-// Valida si la suma de una columna es correcta
-bool validar_suma_columna(int matriz[max][max], int n, int columna, int suma_esperada) {
-    int suma = 0;
-    for (int i = 0; i < n; i++) {
-        suma += matriz[i][columna];
+// Nombre legible del algoritmo
+static const char* nombre_legible_algoritmo(TipoAlgoritmo algoritmo) {
+    switch (algoritmo) {
+        case ALGORITMO_KUROSAKA: return "Kurosaka";
+        case ALGORITMO_SIAMES: return "Siamés";
+        case ALGORITMO_LOUBERE: return "De la Loubère";
+        case ALGORITMO_L: return "Método L";
+        case ALGORITMO_ALTERNO: return "Alterno";
+        case ALGORITMO_PAR_DOBLE: return "Doblemente par";
+        case ALGORITMO_PAR_SIMPLE: return "Simplemente par";
     }
-    return suma == suma_esperada;
+    return "";
 }
 
-// Valida si la suma de la diagonal principal es correcta
-bool validar_suma_diagonal_principal(int matriz[max][max], int n, int suma_esperada) {
-    int suma = 0;
-    for (int i = 0; i < n; i++) {
-        suma += matriz[i][i];
-    }
-    return suma == suma_esperada;
+// ============= GENERACIÓN EN SEGUNDO PLANO =============
+
+static void liberar_trabajo(gpointer datos) {
+    TrabajoGeneracion *trabajo = (TrabajoGeneracion*)datos;
+    g_object_unref(trabajo->cancelable);
+    g_free(trabajo);
 }
 
-// Valida si la suma de la diagonal secundaria es correcta
-bool validar_suma_diagonal_secundaria(int matriz[max][max], int n, int suma_esperada) {
-    int suma = 0;
-    for (int i = 0; i < n; i++) {
-        suma += matriz[i][n - 1 - i];
-    }
-    return suma == suma_esperada;
+// Callback de progreso de la biblioteca (corre en el hilo de generación)
+static bool reportar_progreso(double fraccion, void *datos) {
+    TrabajoGeneracion *trabajo = (TrabajoGeneracion*)datos;
+    g_atomic_int_set(&trabajo->progreso_milesimas, (gint)(fraccion * 1000));
+    return !g_cancellable_is_cancelled(trabajo->cancelable);
 }
 
-// Valida si el cuadro es realmente mágico
-bool validar_cuadro_magico(CuadroMagico* cuadro) {
-    if (!cuadro) return false;
-    
-    int n = cuadro->tamaño;
-    int suma_esperada = cuadro->suma_magica;
-    
-    // Validar todas las filas
-    for (int i = 0; i < n; i++) {
-        if (!validar_suma_fila(cuadro->matriz, n, i, suma_esperada)) {
-            return false;
-        }
-    }
-    
-    // Validar todas las columnas
-    for (int j = 0; j < n; j++) {
-        if (!validar_suma_columna(cuadro->matriz, n, j, suma_esperada)) {
-            return false;
+// Genera y valida el cuadro fuera del hilo de GTK
+static void generar_en_hilo(GTask *task, gpointer source, gpointer task_data,
+                            GCancellable *cancellable) {
+    TrabajoGeneracion *trabajo = (TrabajoGeneracion*)task_data;
+    
+    gint64 inicio = g_get_monotonic_time();
+    bool generado = generar_cuadro_en_buffer(trabajo->cuadro, trabajo->celdas, trabajo->capacidad,
+                                             trabajo->tamaño, trabajo->algoritmo,
+                                             reportar_progreso, trabajo);
+    trabajo->tiempo_generacion_us = g_get_monotonic_time() - inicio;
+    
+    if (!generado) {
+        if (g_cancellable_is_cancelled(cancellable)) {
+            g_task_return_new_error(task, G_IO_ERROR, G_IO_ERROR_CANCELLED,
+                                    "Generación cancelada.");
+        } else {
+            g_task_return_new_error(task, G_IO_ERROR, G_IO_ERROR_FAILED,
+                                    "Error: No se pudo generar el cuadro mágico.");
         }
+        return;
     }
     
-    // Validar diagonal principal
-    if (!validar_suma_diagonal_principal(cuadro->matriz, n, suma_esperada)) {
-        return false;
-    }
+    // La barra vuelve a empezar para la validación, que también se cancela
+    CuadroMagico *cuadro = trabajo->cuadro;
+    inicio = g_get_monotonic_time();
+    cuadro->es_valido = validar_cuadro_magico_con_progreso(cuadro, reportar_progreso, trabajo);
+    trabajo->tiempo_validacion_us = g_get_monotonic_time() - inicio;
     
-    // Validar diagonal secundaria
-    if (!validar_suma_diagonal_secundaria(cuadro->matriz, n, suma_esperada)) {
-        return false;
+    if (g_cancellable_is_cancelled(cancellable)) {
+        g_task_return_new_error(task, G_IO_ERROR, G_IO_ERROR_CANCELLED,
+                                "Generación cancelada.");
+        return;
     }
     
-    return true;
+    // La ranura es de AppWidgets: no hay nada que liberar si nadie lo recoge
+    g_task_return_pointer(task, cuadro, NULL);
 }
 
-// Crea un cuadro mágico usando el algoritmo especificado
-CuadroMagico* crear_cuadro_magico(int n, TipoAlgoritmo algoritmo) {
-    if (n % 2 == 0 || n < 3 || n > max) {
-        return NULL; // Solo para cuadros impares
-    }
-    
-    CuadroMagico* cuadro = (CuadroMagico*)malloc(sizeof(CuadroMagico));
-    if (!cuadro) return NULL;
-    
-    cuadro->tamaño = n;
-    cuadro->suma_magica = calcular_suma_magica(n);
-    limpiar_matriz(cuadro->matriz, n);
-    
-    int fila, columna;
-    obtener_posicion_inicio(n, algoritmo, &fila, &columna);
+// Copia el avance del hilo a la barra de progreso (en el bucle principal)
+static gboolean actualizar_barra_progreso(gpointer data) {
+    AppWidgets *widgets = (AppWidgets*)data;
+    if (!widgets->tarea_actual) return G_SOURCE_REMOVE;
     
-    // Función de movimiento según el algoritmo
-    int (*funcion_movimiento)(int[max][max], int, int, int) = NULL;
+    TrabajoGeneracion *trabajo = g_task_get_task_data(widgets->tarea_actual);
+    gint milesimas = g_atomic_int_get(&trabajo->progreso_milesimas);
+    gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(widgets->progress_bar), milesimas / 1000.0);
+    return G_SOURCE_CONTINUE;
+}
+
+// Habilita los controles según haya o no una tarea en curso
+static void marcar_generando(AppWidgets *widgets, bool generando) {
+    gtk_widget_set_sensitive(widgets->generate_button, !generando);
+    gtk_widget_set_sensitive(widgets->cancel_button, generando);
+    gtk_widget_set_sensitive(widgets->validate_button, !generando && widgets->cuadro_actual != NULL);
+    gtk_widget_set_visible(widgets->progress_bar, generando);
+}
+
+// Recibe el resultado del hilo, ya de vuelta en el bucle principal
+static void generacion_terminada(GObject *source, GAsyncResult *result, gpointer data) {
+    AppWidgets *widgets = (AppWidgets*)data;
+    GTask *task = G_TASK(result);
+    TrabajoGeneracion *trabajo = g_task_get_task_data(task);
     
-    switch (algoritmo) {
-        case ALGORITMO_KUROSAKA:
-            funcion_movimiento = metodo_kurosaka;
-            break;
-        case ALGORITMO_SIAMES:
-            funcion_movimiento = metodoSiames;
-            break;
-        case ALGORITMO_LOUBERE:
-            funcion_movimiento = metodoLouber;
-            break;
-        case ALGORITMO_L:
-            funcion_movimiento = metodoEnL;
-            break;
-        case ALGORITMO_ALTERNO:
-            funcion_movimiento = metodoAlterno;
-            break;
-        default:
-            funcion_movimiento = metodo_kurosaka;
-            break;
+    if (widgets->progreso_timeout_id) {
+        g_source_remove(widgets->progreso_timeout_id);
+        widgets->progreso_timeout_id = 0;
     }
     
-    // Generar el cuadro mágico
-    for (int numero = 1; numero <= n * n; numero++) {
-        cuadro->matriz[fila][columna] = numero;
+    GError *error = NULL;
+    CuadroMagico *cuadro = g_task_propagate_pointer(task, &error);
+    
+    if (!cuadro) {
+        gtk_label_set_text(GTK_LABEL(widgets->status_label), error->message);
+        g_error_free(error);
+    } else {
+        // El cuadro anterior queda en la otra ranura para la próxima generación
+        widgets->ranura_actual = trabajo->ranura;
+        widgets->cuadro_actual = cuadro;
         
-        if (numero < n * n) { // No calcular siguiente posición para el último número
-            int siguiente_pos = funcion_movimiento(cuadro->matriz, n, fila, columna);
-            fila = siguiente_pos / max;
-            columna = siguiente_pos % max;
-        }
+        // Mostrar el cuadro en el lienzo
+        mostrar_cuadro_en_lienzo(cuadro, widgets->lienzo);
+        
+        // Actualizar status con los tiempos medidos en el hilo
+        char status_text[300];
+        snprintf(status_text, sizeof(status_text), 
+                "Cuadro %dx%d generado con algoritmo %s. Suma mágica: %lld\n"
+                "Generación: %.1f ms · Validación: %.1f ms", 
+                cuadro->tamaño, cuadro->tamaño, nombre_legible_algoritmo(trabajo->algoritmo),
+                cuadro->suma_magica,
+                trabajo->tiempo_generacion_us / 1000.0,
+                trabajo->tiempo_validacion_us / 1000.0);
+        gtk_label_set_text(GTK_LABEL(widgets->status_label), status_text);
+        
+        // El hilo ya validó el cuadro
+        gtk_label_set_text(GTK_LABEL(widgets->validation_label), 
+                          cuadro->es_valido ? "VÁLIDO ✓" : "INVÁLIDO ✗");
     }
     
-    cuadro->es_valido = validar_cuadro_magico(cuadro);
-    return cuadro;
-}
-
-// Libera la memoria del cuadro mágico
-void liberar_cuadro_magico(CuadroMagico* cuadro) {
-    if (cuadro) {
-        free(cuadro);
-    }
+    g_clear_object(&widgets->tarea_actual);
+    g_clear_object(&widgets->cancelable);
+    marcar_generando(widgets, false);
 }
 
-// Función imprimir_cuadro_magico removida - solo interfaz gráfica
-
-// ============= FUNCIONES GTK =============
-
-// Variables globales
-static AppWidgets *app_widgets = NULL;
-
-// Función para limpiar el grid del cuadro mágico
-void limpiar_grid(GtkWidget *grid) {
-    GList *children = gtk_container_get_children(GTK_CONTAINER(grid));
-    for (GList *iter = children; iter != NULL; iter = g_list_next(iter)) {
-        gtk_widget_destroy(GTK_WIDGET(iter->data));
+// Callback para el botón "Generar"
+void on_generate_button_clicked(GtkWidget *widget, gpointer data) {
+    AppWidgets *widgets = (AppWidgets*)data;
+    
+    if (widgets->tarea_actual) return;
+    
+    // Obtener el tamaño seleccionado
+    int tamaño = (int)gtk_spin_button_get_value(GTK_SPIN_BUTTON(widgets->size_spin));
+    
+    // Los recorridos piden n impar; cada construcción par, su propia paridad
+    TipoAlgoritmo algoritmo = obtener_algoritmo_seleccionado(widgets);
+    if (!orden_valido_para_algoritmo(tamaño, algoritmo)) {
+        const char* mensaje = algoritmo == ALGORITMO_PAR_DOBLE ?
+            "Error: El método doblemente par necesita un múltiplo de 4." :
+            algoritmo == ALGORITMO_PAR_SIMPLE ?
+            "Error: El método simplemente par necesita un par que no sea múltiplo de 4." :
+            "Error: Este método necesita un tamaño impar.";
+        gtk_label_set_text(GTK_LABEL(widgets->status_label), mensaje);
+        return;
     }
-    g_list_free(children);
-}
-
-// Función para mostrar el cuadro mágico en el grid
-void mostrar_cuadro_en_grid(CuadroMagico *cuadro, GtkWidget *grid) {
-    if (!cuadro || !grid) return;
-    
-    limpiar_grid(grid);
-    
-    int n = cuadro->tamaño;
-    
-    // Crear y agregar labels para cada celda
-    for (int i = 0; i < n; i++) {
-        for (int j = 0; j < n; j++) {
-            char texto[10];
-            snprintf(texto, sizeof(texto), "%d", cuadro->matriz[i][j]);
-            
-            GtkWidget *label = gtk_label_new(texto);
-            gtk_widget_set_size_request(label, 60, 60);
-            
-            // Crear un frame para cada celda
-            GtkWidget *frame = gtk_frame_new(NULL);
-            gtk_frame_set_shadow_type(GTK_FRAME(frame), GTK_SHADOW_IN);
-            gtk_container_add(GTK_CONTAINER(frame), label);
-            
-            // Agregar al grid
-            gtk_grid_attach(GTK_GRID(grid), frame, j, i, 1, 1);
+    
+    // Generar en la ranura que no se muestra, agrandándola solo si no alcanza
+    int ranura = widgets->cuadro_actual ? 1 - widgets->ranura_actual : widgets->ranura_actual;
+    size_t bytes = bytes_celdas_cuadro(tamaño);
+    if (widgets->capacidad_celdas[ranura] < bytes) {
+        g_free(widgets->celdas[ranura]);
+        widgets->celdas[ranura] = g_try_malloc(bytes);
+        widgets->capacidad_celdas[ranura] = widgets->celdas[ranura] ? bytes : 0;
+        if (!widgets->celdas[ranura]) {
+            gtk_label_set_text(GTK_LABEL(widgets->status_label),
+                              "Error: No hay memoria para un cuadro de ese tamaño.");
+            return;
         }
     }
     
-    gtk_widget_show_all(grid);
+    // Preparar el trabajo para el hilo
+    TrabajoGeneracion *trabajo = g_new0(TrabajoGeneracion, 1);
+    trabajo->tamaño = tamaño;
+    trabajo->algoritmo = algoritmo;
+    trabajo->ranura = ranura;
+    trabajo->cuadro = &widgets->cuadros[ranura];
+    trabajo->celdas = widgets->celdas[ranura];
+    trabajo->capacidad = widgets->capacidad_celdas[ranura];
+    widgets->cancelable = g_cancellable_new();
+    trabajo->cancelable = g_object_ref(widgets->cancelable);
+    
+    widgets->tarea_actual = g_task_new(NULL, widgets->cancelable, generacion_terminada, widgets);
+    g_task_set_task_data(widgets->tarea_actual, trabajo, liberar_trabajo);
+    
+    // Mostrar progreso mientras el hilo trabaja
+    char status_text[200];
+    snprintf(status_text, sizeof(status_text), "Generando cuadro %dx%d con algoritmo %s...",
+             tamaño, tamaño, nombre_legible_algoritmo(trabajo->algoritmo));
+    gtk_label_set_text(GTK_LABEL(widgets->status_label), status_text);
+    gtk_label_set_text(GTK_LABEL(widgets->validation_label), "-");
+    gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(widgets->progress_bar), 0.0);
+    marcar_generando(widgets, true);
+    widgets->progreso_timeout_id = g_timeout_add(100, actualizar_barra_progreso, widgets);
+    
+    g_task_run_in_thread(widgets->tarea_actual, generar_en_hilo);
 }
 
-// Función para obtener el algoritmo seleccionado
-TipoAlgoritmo obtener_algoritmo_seleccionado(AppWidgets *widgets) {
-    if (gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widgets->kurosaka_radio))) {
-        return ALGORITMO_KUROSAKA;
-    } else if (gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widgets->siames_radio))) {
-        return ALGORITMO_SIAMES;
-    } else if (gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widgets->loubere_radio))) {
-        return ALGORITMO_LOUBERE;
-    } else if (gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widgets->l_radio))) {
-        return ALGORITMO_L;
-    } else if (gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widgets->alterno_radio))) {
-        return ALGORITMO_ALTERNO;
+// Callback para el botón "Cancelar"
+void on_cancel_button_clicked(GtkWidget *widget, gpointer data) {
+    AppWidgets *widgets = (AppWidgets*)data;
+    
+    if (widgets->cancelable) {
+        g_cancellable_cancel(widgets->cancelable);
+        TrabajoGeneracion *trabajo = g_task_get_task_data(widgets->tarea_actual);
+        gtk_label_set_text(GTK_LABEL(widgets->status_label), trabajo->solo_validar ?
+                          "Cancelando validación..." : "Cancelando generación...");
     }
-    return ALGORITMO_KUROSAKA; // Por defecto
 }
 
-// Callback para el botón "Generar"
-void on_generate_button_clicked(GtkWidget *widget, gpointer data) {
-    AppWidgets *widgets = (AppWidgets*)data;
+// Valida el cuadro mostrado fuera del hilo de GTK
+static void validar_en_hilo(GTask *task, gpointer source, gpointer task_data,
+                            GCancellable *cancellable) {
+    TrabajoGeneracion *trabajo = (TrabajoGeneracion*)task_data;
     
-    // Obtener el tamaño seleccionado
-    int tamaño = (int)gtk_spin_button_get_value(GTK_SPIN_BUTTON(widgets->size_spin));
+    gint64 inicio = g_get_monotonic_time();
+    bool es_valido = validar_cuadro_magico_con_progreso(trabajo->cuadro, reportar_progreso, trabajo);
+    trabajo->tiempo_validacion_us = g_get_monotonic_time() - inicio;
     
-    // Verificar que sea impar
-    if (tamaño % 2 == 0) {
-        gtk_label_set_text(GTK_LABEL(widgets->status_label), 
-                          "Error: El tamaño debe ser un número impar.");
+    if (g_cancellable_is_cancelled(cancellable)) {
+        g_task_return_new_error(task, G_IO_ERROR, G_IO_ERROR_CANCELLED, "Validación cancelada.");
         return;
     }
+    g_task_return_boolean(task, es_valido);
+}
+
+// Recibe el resultado de la validación en el bucle principal
+static void validacion_terminada(GObject *source, GAsyncResult *result, gpointer data) {
+    AppWidgets *widgets = (AppWidgets*)data;
+    GTask *task = G_TASK(result);
+    TrabajoGeneracion *trabajo = g_task_get_task_data(task);
     
-    // Obtener el algoritmo seleccionado
-    TipoAlgoritmo algoritmo = obtener_algoritmo_seleccionado(widgets);
-    
-    // Liberar cuadro anterior si existe
-    if (widgets->cuadro_actual) {
-        liberar_cuadro_magico(widgets->cuadro_actual);
+    if (widgets->progreso_timeout_id) {
+        g_source_remove(widgets->progreso_timeout_id);
+        widgets->progreso_timeout_id = 0;
     }
     
-    // Generar nuevo cuadro mágico
-    widgets->cuadro_actual = crear_cuadro_magico(tamaño, algoritmo);
-    
-    if (widgets->cuadro_actual) {
-        // Mostrar el cuadro en el grid
-        mostrar_cuadro_en_grid(widgets->cuadro_actual, widgets->magic_square_grid);
+    GError *error = NULL;
+    bool es_valido = g_task_propagate_boolean(task, &error);
+    
+    if (error) {
+        gtk_label_set_text(GTK_LABEL(widgets->status_label), error->message);
+        g_error_free(error);
+    } else if (widgets->cuadro_actual == trabajo->cuadro) {
+        // Si mientras tanto se limpió el lienzo, el resultado ya no se muestra
+        trabajo->cuadro->es_valido = es_valido;
+        gtk_label_set_text(GTK_LABEL(widgets->validation_label), 
+                          es_valido ? "VÁLIDO ✓" : "INVÁLIDO ✗");
         
-        // Actualizar status
         char status_text[200];
-        const char *nombre_algoritmo = "";
-        switch (algoritmo) {
-            case ALGORITMO_KUROSAKA: nombre_algoritmo = "Kurosaka"; break;
-            case ALGORITMO_SIAMES: nombre_algoritmo = "Siamés"; break;
-            case ALGORITMO_LOUBERE: nombre_algoritmo = "De la Loubère"; break;
-            case ALGORITMO_L: nombre_algoritmo = "Método L"; break;
-            case ALGORITMO_ALTERNO: nombre_algoritmo = "Alterno"; break;
-        }
-        
         snprintf(status_text, sizeof(status_text), 
-                "Cuadro %dx%d generado con algoritmo %s. Suma mágica: %d", 
-                tamaño, tamaño, nombre_algoritmo, widgets->cuadro_actual->suma_magica);
+                "Validación completada - Suma mágica: %lld · Validación: %.1f ms", 
+                trabajo->cuadro->suma_magica, trabajo->tiempo_validacion_us / 1000.0);
         gtk_label_set_text(GTK_LABEL(widgets->status_label), status_text);
-        
-        // Habilitar botón de validación
-        gtk_widget_set_sensitive(widgets->validate_button, TRUE);
-        
-        // Limpiar validación anterior
-        gtk_label_set_text(GTK_LABEL(widgets->validation_label), "-");
-    } else {
-        gtk_label_set_text(GTK_LABEL(widgets->status_label), 
-                          "Error: No se pudo generar el cuadro mágico.");
     }
+    
+    g_clear_object(&widgets->tarea_actual);
+    g_clear_object(&widgets->cancelable);
+    marcar_generando(widgets, false);
 }
 
 // Callback para el botón "Validar"
 void on_validate_button_clicked(GtkWidget *widget, gpointer data) {
     AppWidgets *widgets = (AppWidgets*)data;
     
+    if (widgets->tarea_actual) return;
+    
     if (!widgets->cuadro_actual) {
         gtk_label_set_text(GTK_LABEL(widgets->status_label), 
                           "Error: No hay cuadro mágico para validar.");
         return;
     }
     
-    bool es_valido = validar_cuadro_magico(widgets->cuadro_actual);
-    widgets->cuadro_actual->es_valido = es_valido;
+    // Las celdas de la ranura mostrada no se tocan hasta que termine la
+    // tarea: "Generar" no arranca otra mientras tanto
+    TrabajoGeneracion *trabajo = g_new0(TrabajoGeneracion, 1);
+    trabajo->tamaño = widgets->cuadro_actual->tamaño;
+    trabajo->algoritmo = widgets->cuadro_actual->algoritmo;
+    trabajo->ranura = widgets->ranura_actual;
+    trabajo->cuadro = widgets->cuadro_actual;
+    trabajo->solo_validar = true;
+    widgets->cancelable = g_cancellable_new();
+    trabajo->cancelable = g_object_ref(widgets->cancelable);
     
-    // Actualizar label de validación
-    gtk_label_set_text(GTK_LABEL(widgets->validation_label), 
-                      es_valido ? "VÁLIDO ✓" : "INVÁLIDO ✗");
+    widgets->tarea_actual = g_task_new(NULL, widgets->cancelable, validacion_terminada, widgets);
+    g_task_set_task_data(widgets->tarea_actual, trabajo, liberar_trabajo);
     
-    // Actualizar status con información detallada
     char status_text[200];
-    snprintf(status_text, sizeof(status_text), 
-            "Validación completada - Suma mágica: %d", 
-            widgets->cuadro_actual->suma_magica);
+    snprintf(status_text, sizeof(status_text), "Validando cuadro %dx%d...",
+             trabajo->tamaño, trabajo->tamaño);
     gtk_label_set_text(GTK_LABEL(widgets->status_label), status_text);
+    gtk_label_set_text(GTK_LABEL(widgets->validation_label), "-");
+    gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(widgets->progress_bar), 0.0);
+    marcar_generando(widgets, true);
+    widgets->progreso_timeout_id = g_timeout_add(100, actualizar_barra_progreso, widgets);
+    
+    g_task_run_in_thread(widgets->tarea_actual, validar_en_hilo);
 }
 
 // Callback para el botón "Limpiar"
 void on_clear_button_clicked(GtkWidget *widget, gpointer data) {
     AppWidgets *widgets = (AppWidgets*)data;
     
-    // Limpiar el grid
-    limpiar_grid(widgets->magic_square_grid);
-    
-    // Liberar cuadro actual
-    if (widgets->cuadro_actual) {
-        liberar_cuadro_magico(widgets->cuadro_actual);
-        widgets->cuadro_actual = NULL;
+    // Cancelar una generación en curso
+    if (widgets->cancelable) {
+        g_cancellable_cancel(widgets->cancelable);
     }
     
+    // Limpiar el lienzo antes de liberar el cuadro que muestra
+    lienzo_limpiar(widgets->lienzo);
+    
+    // Soltar el cuadro actual (sus celdas se reutilizan en la próxima generación)
+    widgets->cuadro_actual = NULL;
+    
     // Actualizar status
     gtk_label_set_text(GTK_LABEL(widgets->status_label), 
                       "Listo para generar cuadro mágico...");
@@ -449,9 +433,19 @@ void on_clear_button_clicked(GtkWidget *widget, gpointer data) {
 void on_main_window_destroy(GtkWidget *widget, gpointer data) {
     AppWidgets *widgets = (AppWidgets*)data;
     
-    // Liberar cuadro actual
+    // Pedir al hilo de generación que termine
+    if (widgets->cancelable) {
+        g_cancellable_cancel(widgets->cancelable);
+    }
+    if (widgets->progreso_timeout_id) {
+        g_source_remove(widgets->progreso_timeout_id);
+        widgets->progreso_timeout_id = 0;
+    }
+    
+    // Soltar el cuadro actual; las celdas se liberan al salir de gtk_main
     if (widgets->cuadro_actual) {
-        liberar_cuadro_magico(widgets->cuadro_actual);
+        lienzo_limpiar(widgets->lienzo);
+        widgets->cuadro_actual = NULL;
     }
     
     gtk_main_quit();
@@ -462,22 +456,31 @@ void conectar_señales(GtkBuilder *builder, AppWidgets *widgets) {
     // Obtener widgets del builder
     widgets->main_window = GTK_WIDGET(gtk_builder_get_object(builder, "main_window"));
     widgets->size_spin = GTK_WIDGET(gtk_builder_get_object(builder, "size_spin"));
-    widgets->magic_square_grid = GTK_WIDGET(gtk_builder_get_object(builder, "magic_square_grid"));
     widgets->status_label = GTK_WIDGET(gtk_builder_get_object(builder, "status_label"));
     widgets->validation_label = GTK_WIDGET(gtk_builder_get_object(builder, "validation_label"));
     widgets->validate_button = GTK_WIDGET(gtk_builder_get_object(builder, "validate_button"));
+    widgets->generate_button = GTK_WIDGET(gtk_builder_get_object(builder, "generate_button"));
+    widgets->cancel_button = GTK_WIDGET(gtk_builder_get_object(builder, "cancel_button"));
+    widgets->progress_bar = GTK_WIDGET(gtk_builder_get_object(builder, "progress_bar"));
+    
+    // El lienzo del cuadro se crea en código y va dentro de canvas_box
+    GtkWidget *canvas_box = GTK_WIDGET(gtk_builder_get_object(builder, "canvas_box"));
+    widgets->lienzo = crear_lienzo_cuadro();
+    gtk_box_pack_start(GTK_BOX(canvas_box), widget_lienzo_cuadro(widgets->lienzo), TRUE, TRUE, 0);
     
     widgets->kurosaka_radio = GTK_WIDGET(gtk_builder_get_object(builder, "kurosaka_radio"));
     widgets->siames_radio = GTK_WIDGET(gtk_builder_get_object(builder, "siames_radio"));
     widgets->loubere_radio = GTK_WIDGET(gtk_builder_get_object(builder, "loubere_radio"));
     widgets->l_radio = GTK_WIDGET(gtk_builder_get_object(builder, "l_radio"));
     widgets->alterno_radio = GTK_WIDGET(gtk_builder_get_object(builder, "alterno_radio"));
+    widgets->par_doble_radio = GTK_WIDGET(gtk_builder_get_object(builder, "par_doble_radio"));
+    widgets->par_simple_radio = GTK_WIDGET(gtk_builder_get_object(builder, "par_simple_radio"));
     
     // Conectar señales de botones
-    GtkWidget *generate_button = GTK_WIDGET(gtk_builder_get_object(builder, "generate_button"));
     GtkWidget *clear_button = GTK_WIDGET(gtk_builder_get_object(builder, "clear_button"));
     
-    g_signal_connect(generate_button, "clicked", G_CALLBACK(on_generate_button_clicked), widgets);
+    g_signal_connect(widgets->generate_button, "clicked", G_CALLBACK(on_generate_button_clicked), widgets);
+    g_signal_connect(widgets->cancel_button, "clicked", G_CALLBACK(on_cancel_button_clicked), widgets);
     g_signal_connect(widgets->validate_button, "clicked", G_CALLBACK(on_validate_button_clicked), widgets);
     g_signal_connect(clear_button, "clicked", G_CALLBACK(on_clear_button_clicked), widgets);
     g_signal_connect(widgets->main_window, "destroy", G_CALLBACK(on_main_window_destroy), widgets);
@@ -487,8 +490,7 @@ int main(int argc, char *argv[]) {
     gtk_init(&argc, &argv);
     
     // Crear estructura de widgets
-    app_widgets = g_malloc(sizeof(AppWidgets));
-    app_widgets->cuadro_actual = NULL;
+    app_widgets = g_malloc0(sizeof(AppWidgets));
     
     // Cargar la interfaz desde el archivo Glade
     GtkBuilder *builder = gtk_builder_new();
@@ -505,6 +507,7 @@ int main(int argc, char *argv[]) {
     
     // Mostrar la ventana principal
     gtk_widget_show_all(app_widgets->main_window);
+    marcar_generando(app_widgets, false);
     
     // Inicializar status
     gtk_label_set_text(GTK_LABEL(app_widgets->status_label), 
@@ -513,9 +516,13 @@ int main(int argc, char *argv[]) {
     // Ejecutar el bucle principal de GTK
     gtk_main();
     
-    // Limpiar
+    // Limpiar (si un hilo sigue generando, sus celdas se dejan al sistema)
     g_object_unref(builder);
-    g_free(app_widgets);
+    if (!app_widgets->tarea_actual) {
+        g_free(app_widgets->celdas[0]);
+        g_free(app_widgets->celdas[1]);
+        g_free(app_widgets);
+    }
     
     return 0;
 }
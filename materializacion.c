@@ -0,0 +1,310 @@
+/*
+ * Kernels de filas de la fórmula cerrada (escalar, SSE2 y AVX2) y
+ * materialización paralela por bandas de filas
+ */
+
+#include <string.h>
+#include <pthread.h>
+#include "materializacion.h"
+#include "cuadros_pares.h"
+#include "validacion.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MATERIALIZACION_X86 1
+#include <immintrin.h>
+#endif
+
+// q y p de la celda (fila, columna); los coeficientes ya están en [0, n)
+static inline int coordenada_q(const FormulaCerrada* f, int n, int fila, int columna) {
+    return (int)(((long long)f->qf * fila + (long long)f->qc * columna + f->q0) % n);
+}
+
+static inline int coordenada_p(const FormulaCerrada* f, int n, int fila, int columna) {
+    return (int)(((long long)f->pf * fila + (long long)f->pc * columna + f->p0) % n);
+}
+
+// Escribe las columnas [desde, hasta) con q y p ya en la columna desde,
+// avanzándolos con una resta condicional en lugar de un módulo
+#define DEFINIR_TRAMO_ESCALAR(NOMBRE, TIPO)                                         \
+static void NOMBRE(const FormulaCerrada* f, int n, int q, int p, TIPO* destino,     \
+                   int desde, int hasta) {                                          \
+    for (int j = desde; j < hasta; j++) {                                           \
+        destino[j] = (TIPO)((long long)q * n + p + 1);                              \
+        q += f->qc;                                                                 \
+        if (q >= n) q -= n;                                                         \
+        p += f->pc;                                                                 \
+        if (p >= n) p -= n;                                                         \
+    }                                                                               \
+}
+
+DEFINIR_TRAMO_ESCALAR(tramo_escalar_16, uint16_t)
+DEFINIR_TRAMO_ESCALAR(tramo_escalar_32, uint32_t)
+DEFINIR_TRAMO_ESCALAR(tramo_escalar_64, uint64_t)
+
+// Kernels escalares: referencia y respaldo para otras arquitecturas
+#define DEFINIR_FILA_ESCALAR(NOMBRE, TIPO, TRAMO)                                   \
+static void NOMBRE(const FormulaCerrada* f, int n, int fila, void* destino) {       \
+    TRAMO(f, n, coordenada_q(f, n, fila, 0), coordenada_p(f, n, fila, 0),           \
+          (TIPO*)destino, 0, n);                                                    \
+}
+
+DEFINIR_FILA_ESCALAR(fila_escalar_16, uint16_t, tramo_escalar_16)
+DEFINIR_FILA_ESCALAR(fila_escalar_32, uint32_t, tramo_escalar_32)
+DEFINIR_FILA_ESCALAR(fila_escalar_64, uint64_t, tramo_escalar_64)
+
+#ifdef MATERIALIZACION_X86
+
+// Kernels vectoriales: cada carril lleva q, p y el valor de una columna, y
+// todos saltan CARRILES columnas por iteración. Al salto de q se le resta n
+// de antemano: si el resultado es negativo no dio la vuelta y se le
+// devuelve n (el signo del carril es la máscara). El valor n*q + p + 1 se
+// corrige con las mismas máscaras, sin multiplicar. La aritmética es
+// modular en el ancho del carril, que es el de la celda, así que los
+// valores intermedios pueden desbordar sin problema. Las columnas hasta que
+// el destino queda alineado y las que sobran al final van por el tramo
+// escalar.
+#define DEFINIR_FILA_SIMD(NOMBRE, OBJETIVO, TIPO, TRAMO, VECTOR, CARRILES, CONSTANTE,  \
+                          SUMAR, Y, SIGNO, CARGAR, GUARDAR, BARRERA)                   \
+__attribute__((target(OBJETIVO)))                                                      \
+static void NOMBRE(const FormulaCerrada* f, int n, int fila, void* datos) {            \
+    TIPO* destino = (TIPO*)datos;                                                      \
+    int j = (int)(((uintptr_t)0 - (uintptr_t)destino) % sizeof(VECTOR) / sizeof(TIPO)); \
+    if (j > n) j = n;                                                                  \
+    TRAMO(f, n, coordenada_q(f, n, fila, 0), coordenada_p(f, n, fila, 0), destino, 0, j); \
+                                                                                       \
+    if (j + CARRILES <= n) {                                                           \
+        TIPO q_carril[CARRILES], p_carril[CARRILES], v_carril[CARRILES];               \
+        int q = coordenada_q(f, n, fila, j), p = coordenada_p(f, n, fila, j);          \
+        for (int t = 0; t < CARRILES; t++) {                                           \
+            q_carril[t] = (TIPO)q;                                                     \
+            p_carril[t] = (TIPO)p;                                                     \
+            v_carril[t] = (TIPO)((long long)q * n + p + 1);                            \
+            q += f->qc;                                                                \
+            if (q >= n) q -= n;                                                        \
+            p += f->pc;                                                                \
+            if (p >= n) p -= n;                                                        \
+        }                                                                              \
+                                                                                       \
+        long long sq = (long long)CARRILES * f->qc % n;                                \
+        long long sp = (long long)CARRILES * f->pc % n;                                \
+        long long n2 = (long long)n * n;                                               \
+        const VECTOR vn = CONSTANTE(n), vn2 = CONSTANTE(n2);                           \
+        const VECTOR salto_q = CONSTANTE(sq - n), salto_p = CONSTANTE(sp - n);         \
+        const VECTOR salto_v = CONSTANTE(n * sq + sp - n2 - n);                        \
+        VECTOR vq = CARGAR(q_carril), vp = CARGAR(p_carril), vv = CARGAR(v_carril);    \
+                                                                                       \
+        for (; j + CARRILES <= n; j += CARRILES) {                                     \
+            GUARDAR((VECTOR*)(destino + j), vv);                                       \
+            vq = SUMAR(vq, salto_q);                                                   \
+            VECTOR mq = SIGNO(vq);                                                     \
+            vq = SUMAR(vq, Y(mq, vn));                                                 \
+            vp = SUMAR(vp, salto_p);                                                   \
+            VECTOR mp = SIGNO(vp);                                                     \
+            vp = SUMAR(vp, Y(mp, vn));                                                 \
+            vv = SUMAR(vv, SUMAR(salto_v, SUMAR(Y(mq, vn2), Y(mp, vn))));              \
+        }                                                                              \
+        BARRERA;                                                                       \
+    }                                                                                  \
+                                                                                       \
+    TRAMO(f, n, coordenada_q(f, n, fila, j), coordenada_p(f, n, fila, j), destino, j, n); \
+}
+
+#define CARGAR_SSE2(x) _mm_loadu_si128((const __m128i*)(x))
+#define CONSTANTE_SSE2_16(x) _mm_set1_epi16((short)(x))
+#define CONSTANTE_SSE2_32(x) _mm_set1_epi32((int)(x))
+#define CONSTANTE_SSE2_64(x) _mm_set1_epi64x((long long)(x))
+#define SIGNO_SSE2_16(x) _mm_srai_epi16(x, 15)
+#define SIGNO_SSE2_32(x) _mm_srai_epi32(x, 31)
+// SSE2 no desplaza 64 bits con signo: se copia el signo de la mitad alta
+#define SIGNO_SSE2_64(x) _mm_shuffle_epi32(_mm_srai_epi32(x, 31), _MM_SHUFFLE(3, 3, 1, 1))
+
+#define CARGAR_AVX2(x) _mm256_loadu_si256((const __m256i*)(x))
+#define CONSTANTE_AVX2_16(x) _mm256_set1_epi16((short)(x))
+#define CONSTANTE_AVX2_32(x) _mm256_set1_epi32((int)(x))
+#define CONSTANTE_AVX2_64(x) _mm256_set1_epi64x((long long)(x))
+#define SIGNO_AVX2_16(x) _mm256_srai_epi16(x, 15)
+#define SIGNO_AVX2_32(x) _mm256_srai_epi32(x, 31)
+#define SIGNO_AVX2_64(x) _mm256_cmpgt_epi64(_mm256_setzero_si256(), x)
+
+#define SIN_BARRERA ((void)0)
+
+// SSE2: 8, 4 o 2 celdas por iteración; las directas con _mm_stream_si128
+DEFINIR_FILA_SIMD(fila_sse2_16, "sse2", uint16_t, tramo_escalar_16, __m128i, 8, CONSTANTE_SSE2_16,
+                  _mm_add_epi16, _mm_and_si128, SIGNO_SSE2_16, CARGAR_SSE2, _mm_store_si128, SIN_BARRERA)
+DEFINIR_FILA_SIMD(fila_sse2_32, "sse2", uint32_t, tramo_escalar_32, __m128i, 4, CONSTANTE_SSE2_32,
+                  _mm_add_epi32, _mm_and_si128, SIGNO_SSE2_32, CARGAR_SSE2, _mm_store_si128, SIN_BARRERA)
+DEFINIR_FILA_SIMD(fila_sse2_64, "sse2", uint64_t, tramo_escalar_64, __m128i, 2, CONSTANTE_SSE2_64,
+                  _mm_add_epi64, _mm_and_si128, SIGNO_SSE2_64, CARGAR_SSE2, _mm_store_si128, SIN_BARRERA)
+DEFINIR_FILA_SIMD(fila_directa_sse2_16, "sse2", uint16_t, tramo_escalar_16, __m128i, 8, CONSTANTE_SSE2_16,
+                  _mm_add_epi16, _mm_and_si128, SIGNO_SSE2_16, CARGAR_SSE2, _mm_stream_si128, _mm_sfence())
+DEFINIR_FILA_SIMD(fila_directa_sse2_32, "sse2", uint32_t, tramo_escalar_32, __m128i, 4, CONSTANTE_SSE2_32,
+                  _mm_add_epi32, _mm_and_si128, SIGNO_SSE2_32, CARGAR_SSE2, _mm_stream_si128, _mm_sfence())
+DEFINIR_FILA_SIMD(fila_directa_sse2_64, "sse2", uint64_t, tramo_escalar_64, __m128i, 2, CONSTANTE_SSE2_64,
+                  _mm_add_epi64, _mm_and_si128, SIGNO_SSE2_64, CARGAR_SSE2, _mm_stream_si128, _mm_sfence())
+
+// AVX2: 16, 8 o 4 celdas por iteración; las directas con _mm256_stream_si256
+DEFINIR_FILA_SIMD(fila_avx2_16, "avx2", uint16_t, tramo_escalar_16, __m256i, 16, CONSTANTE_AVX2_16,
+                  _mm256_add_epi16, _mm256_and_si256, SIGNO_AVX2_16, CARGAR_AVX2, _mm256_store_si256, SIN_BARRERA)
+DEFINIR_FILA_SIMD(fila_avx2_32, "avx2", uint32_t, tramo_escalar_32, __m256i, 8, CONSTANTE_AVX2_32,
+                  _mm256_add_epi32, _mm256_and_si256, SIGNO_AVX2_32, CARGAR_AVX2, _mm256_store_si256, SIN_BARRERA)
+DEFINIR_FILA_SIMD(fila_avx2_64, "avx2", uint64_t, tramo_escalar_64, __m256i, 4, CONSTANTE_AVX2_64,
+                  _mm256_add_epi64, _mm256_and_si256, SIGNO_AVX2_64, CARGAR_AVX2, _mm256_store_si256, SIN_BARRERA)
+DEFINIR_FILA_SIMD(fila_directa_avx2_16, "avx2", uint16_t, tramo_escalar_16, __m256i, 16, CONSTANTE_AVX2_16,
+                  _mm256_add_epi16, _mm256_and_si256, SIGNO_AVX2_16, CARGAR_AVX2, _mm256_stream_si256, _mm_sfence())
+DEFINIR_FILA_SIMD(fila_directa_avx2_32, "avx2", uint32_t, tramo_escalar_32, __m256i, 8, CONSTANTE_AVX2_32,
+                  _mm256_add_epi32, _mm256_and_si256, SIGNO_AVX2_32, CARGAR_AVX2, _mm256_stream_si256, _mm_sfence())
+DEFINIR_FILA_SIMD(fila_directa_avx2_64, "avx2", uint64_t, tramo_escalar_64, __m256i, 4, CONSTANTE_AVX2_64,
+                  _mm256_add_epi64, _mm256_and_si256, SIGNO_AVX2_64, CARGAR_AVX2, _mm256_stream_si256, _mm_sfence())
+
+#endif // MATERIALIZACION_X86
+
+// Conjunto de kernels elegido, indexado por ancho de celda
+typedef struct {
+    KernelFilaFormula k16, k32, k64;
+    KernelFilaFormula directo16, directo32, directo64;
+    const char* nombre;
+} KernelsFormula;
+
+static KernelsFormula kernels_elegidos;
+static pthread_once_t kernels_una_vez = PTHREAD_ONCE_INIT;
+
+// Elige los kernels según las capacidades del procesador (vía pthread_once:
+// materializar puede empezar en varios hilos a la vez)
+static void elegir_kernels_una_vez(void) {
+    KernelsFormula k = {fila_escalar_16, fila_escalar_32, fila_escalar_64,
+                        fila_escalar_16, fila_escalar_32, fila_escalar_64, "escalar"};
+#ifdef MATERIALIZACION_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        k = (KernelsFormula){fila_avx2_16, fila_avx2_32, fila_avx2_64,
+                             fila_directa_avx2_16, fila_directa_avx2_32, fila_directa_avx2_64, "avx2"};
+    } else if (__builtin_cpu_supports("sse2")) {
+        k = (KernelsFormula){fila_sse2_16, fila_sse2_32, fila_sse2_64,
+                             fila_directa_sse2_16, fila_directa_sse2_32, fila_directa_sse2_64, "sse2"};
+    }
+#endif
+    kernels_elegidos = k;
+}
+
+static const KernelsFormula* elegir_kernels(void) {
+    pthread_once(&kernels_una_vez, elegir_kernels_una_vez);
+    return &kernels_elegidos;
+}
+
+// Devuelve el kernel más rápido para filas del ancho dado
+KernelFilaFormula seleccionar_kernel_formula(AnchoCelda ancho, bool directa) {
+    const KernelsFormula* k = elegir_kernels();
+    switch (ancho) {
+        case CELDA_16: return directa ? k->directo16 : k->k16;
+        case CELDA_64: return directa ? k->directo64 : k->k64;
+        default:       return directa ? k->directo32 : k->k32;
+    }
+}
+
+const char* nombre_kernel_formula(void) {
+    return elegir_kernels()->nombre;
+}
+
+// ============= MATERIALIZACIÓN POR BANDAS =============
+
+// Estado compartido por todos los trabajadores de una materialización
+typedef struct {
+    CuadroMagico* cuadro;
+    KernelFilaFormula kernel;    // NULL en las construcciones pares
+    size_t bytes_fila;
+    int filas_por_informe;
+    int filas_hechas;            // Contador atómico, en múltiplos de filas_por_informe
+    int cancelado;               // Se activa si el callback cancela
+} MaterializacionCompartida;
+
+// Cada trabajador llena una banda contigua de filas: así toca primero (y
+// deja en su nodo NUMA) las mismas páginas que escribe
+typedef struct {
+    MaterializacionCompartida* compartida;
+    int inicio, fin;
+    CallbackProgreso progreso;   // Solo el hilo que llama informa el avance
+    void* datos;
+    pthread_t hilo;
+} TrabajadorMaterializacion;
+
+static void* materializar_banda(void* arg) {
+    TrabajadorMaterializacion* t = (TrabajadorMaterializacion*)arg;
+    MaterializacionCompartida* c = t->compartida;
+    CuadroMagico* cuadro = c->cuadro;
+    int n = cuadro->tamaño;
+    char* matriz = (char*)cuadro->matriz;
+
+    for (int i = t->inicio; i < t->fin; i++) {
+        void* destino = matriz + (size_t)i * c->bytes_fila;
+        if (c->kernel) {
+            c->kernel(&cuadro->formula, n, i, destino);
+        } else {
+            llenar_fila_par(cuadro->algoritmo, n, i, destino, cuadro->ancho);
+        }
+
+        if ((i - t->inicio + 1) % c->filas_por_informe != 0) continue;
+        int hechas = __atomic_add_fetch(&c->filas_hechas, c->filas_por_informe, __ATOMIC_RELAXED);
+        if (__atomic_load_n(&c->cancelado, __ATOMIC_RELAXED)) break;
+        if (t->progreso && hechas < n && !t->progreso((double)hechas / n, t->datos)) {
+            __atomic_store_n(&c->cancelado, 1, __ATOMIC_RELAXED);
+            break;
+        }
+    }
+    return NULL;
+}
+
+bool materializar_por_filas(CuadroMagico* cuadro, int num_hilos, CallbackProgreso progreso, void* datos) {
+    int n = cuadro->tamaño;
+    size_t bytes = (size_t)n * n * cuadro->ancho;
+
+    if ((size_t)n * n < UMBRAL_MATERIALIZACION_PARALELA) num_hilos = 1;
+    if (num_hilos <= 0) num_hilos = hilos_disponibles();
+    if (num_hilos > n) num_hilos = n;
+
+    MaterializacionCompartida compartida;
+    compartida.cuadro = cuadro;
+    compartida.kernel = es_algoritmo_par(cuadro->algoritmo) ? NULL :
+        seleccionar_kernel_formula(cuadro->ancho, bytes >= UMBRAL_ESCRITURA_DIRECTA);
+    compartida.bytes_fila = (size_t)n * cuadro->ancho;
+    compartida.filas_por_informe = n / 100 > 1 ? n / 100 : 1;
+    compartida.filas_hechas = 0;
+    compartida.cancelado = 0;
+
+    TrabajadorMaterializacion trabajador_pila;
+    TrabajadorMaterializacion* trabajadores = num_hilos == 1 ? &trabajador_pila :
+        (TrabajadorMaterializacion*)malloc((size_t)num_hilos * sizeof(TrabajadorMaterializacion));
+    if (!trabajadores) {
+        // Sin memoria para los trabajadores: se llena todo en el hilo actual
+        trabajadores = &trabajador_pila;
+        num_hilos = 1;
+    }
+    memset(trabajadores, 0, (size_t)num_hilos * sizeof(TrabajadorMaterializacion));
+
+    for (int h = 0; h < num_hilos; h++) {
+        trabajadores[h].compartida = &compartida;
+        trabajadores[h].inicio = (int)((long long)n * h / num_hilos);
+        trabajadores[h].fin = (int)((long long)n * (h + 1) / num_hilos);
+    }
+    trabajadores[0].progreso = progreso;
+    trabajadores[0].datos = datos;
+
+    // El hilo actual hace de trabajador 0; las bandas de los hilos que no
+    // arranquen se llenan aquí al final
+    int lanzados = 0;
+    for (int h = 1; h < num_hilos; h++) {
+        if (pthread_create(&trabajadores[h].hilo, NULL, materializar_banda, &trabajadores[h]) != 0) {
+            break;
+        }
+        lanzados++;
+    }
+    materializar_banda(&trabajadores[0]);
+    for (int h = lanzados + 1; h < num_hilos && !compartida.cancelado; h++) {
+        materializar_banda(&trabajadores[h]);
+    }
+    for (int h = 1; h <= lanzados; h++) {
+        pthread_join(trabajadores[h].hilo, NULL);
+    }
+
+    if (trabajadores != &trabajador_pila) free(trabajadores);
+    return !compartida.cancelado;
+}
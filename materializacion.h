@@ -0,0 +1,42 @@
+/*
+ * Materialización por filas, vectorizada y en paralelo.
+ *
+ * Cuando cada celda sale de una fórmula de (i, j) (los recorridos con
+ * calendario fijo y las construcciones pares), el cuadro no tiene que
+ * llenarse siguiendo el recorrido: cada fila se escribe de izquierda a
+ * derecha y las filas se reparten entre los núcleos. En los recorridos,
+ * q y p avanzan por la fila con una suma y una resta condicional por
+ * carril (SSE2 o AVX2, elegido en tiempo de ejecución), sin módulos ni
+ * multiplicaciones. Cada hilo escribe una banda contigua de filas, así
+ * que las páginas quedan en el nodo NUMA del hilo que las toca primero.
+ */
+
+#ifndef MATERIALIZACION_H
+#define MATERIALIZACION_H
+
+#include <stdbool.h>
+#include "cuadros_magicos.h"
+
+// Celdas a partir de las cuales se materializa con varios hilos
+#define UMBRAL_MATERIALIZACION_PARALELA (1u << 22)
+
+// Bytes de matriz a partir de los cuales las filas se escriben sin pasar
+// por la caché (no se volverían a leer antes de ser desalojadas)
+#define UMBRAL_ESCRITURA_DIRECTA (64u << 20)
+
+// Escribe la fila pedida de la fórmula: n celdas del tipo del kernel.
+// Las variantes directas dejan la fila fuera de la caché.
+typedef void (*KernelFilaFormula)(const FormulaCerrada* f, int n, int fila, void* destino);
+
+// Devuelve el kernel más rápido que soporta el procesador para el ancho dado
+KernelFilaFormula seleccionar_kernel_formula(AnchoCelda ancho, bool directa);
+const char* nombre_kernel_formula(void);
+
+// Llena la matriz de un cuadro de una construcción par o con la fórmula ya
+// calculada en cuadro->formula. Con más de UMBRAL_MATERIALIZACION_PARALELA
+// celdas reparte bandas de filas entre num_hilos hilos (<= 0: todos los
+// núcleos). El hilo que llama informa el avance y, si el callback cancela,
+// todos se detienen y se devuelve false.
+bool materializar_por_filas(CuadroMagico* cuadro, int num_hilos, CallbackProgreso progreso, void* datos);
+
+#endif // MATERIALIZACION_H
@@ -0,0 +1,861 @@
+/*
+ * Modo por lotes de la versión de consola
+ *
+ * Uso: ./cuadros_magicos_consola [opciones]
+ *   --algoritmo A      kurosaka, siames, loubere, l, alterno, par_doble,
+ *                      par_simple, par (los dos pares) o todos (se pueden
+ *                      separar varios con comas); cada orden se genera solo
+ *                      con los algoritmos que lo admiten
+ *   --ordenes R        órdenes: "5", "3-101" o "3-21,101,1001"
+ *   --cantidad K       cuadros por algoritmo y orden (1 por defecto)
+ *   --no-validar       solo generar
+ *   --formato F        resumen (por defecto), csv o cuadro
+ *   --trabajos ARCHIVO una línea de opciones por trabajo; '#' comenta
+ *   --guardar DIR      guarda cada cuadro en DIR/<algoritmo>_<n>_<k>.cmag
+ *   --codificacion C   plana (por defecto) o delta para --guardar
+ *   --cargar ARCHIVO   carga un .cmag en lugar de generar (el tiempo de
+ *                      carga se informa como tiempo de generación)
+ *   --en-archivo       con --guardar, genera cada cuadro directo al archivo
+ *                      por bandas, sin tenerlo en memoria; la validación se
+ *                      hace en la misma pasada y entra en el tiempo de generación
+ *   --explorar         en lugar de generar, prueba todos los inicios,
+ *                      movimientos y break-moves de cada orden (hasta
+ *                      MAX_ORDEN_EXPLORACION) e informa los que dan cuadros
+ *                      mágicos; con csv se listan todos, si no la cantidad y
+ *                      la combinación más barata
+ *   --enumerar E       en lugar de generar, busca todos los cuadros mágicos
+ *                      de cada orden (hasta MAX_ORDEN_ENUMERACION): E es
+ *                      todos o canonicos (uno por clase de simetría); con
+ *                      csv o cuadro se listan, si no solo se cuentan
+ *   --limite K         con --enumerar, corta después de K cuadros por orden
+ *   --aleatorio K      en lugar de construir, genera K cuadros distintos de
+ *                      cada orden (hasta MAX_ORDEN_BUSQUEDA_LOCAL) por
+ *                      búsqueda local; se informan con el algoritmo
+ *                      "aleatorio" y no se pueden guardar
+ *   --semilla S        semilla de --aleatorio (por defecto, la hora)
+ *   --completar ARCH   completa el cuadro parcial de ARCH: n² números
+ *                      separados por espacios, fila por fila, con 0 o '.'
+ *                      en las celdas vacías (n hasta MAX_ORDEN_COMPLETADO);
+ *                      sin solución cuenta como inválido
+ *   --tiempo MS        tiempo máximo de --completar (10000 por defecto);
+ *                      el completado no se puede guardar
+ *
+ * Los cuadros en memoria se generan por tandas de hasta MAX_PEDIDOS_TANDA
+ * pedidos o BYTES_MAXIMOS_TANDA bytes con generar_lote_cuadros; los tiempos
+ * de generación y validación de cada cuadro son su parte del de la tanda.
+ *
+ * Las opciones dadas en la línea de comandos son los valores por defecto de
+ * cada trabajo del archivo. El resumen final va a stderr para que stdout
+ * quede limpio al usar --formato csv.
+ */
+
+#define _POSIX_C_SOURCE 199309L
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "cuadros_magicos.h"
+#include "modo_lote.h"
+#include "archivo_cuadro.h"
+#include "generacion_bandas.h"
+#include "arena_cuadros.h"
+#include "lote_cuadros.h"
+#include "exploracion_movimientos.h"
+#include "enumeracion_cuadros.h"
+#include "busqueda_local.h"
+#include "completado_cuadros.h"
+
+#define MAX_RANGOS 32
+#define MAX_LINEA_TRABAJO 1024
+#define MAX_ARGUMENTOS_TRABAJO 64
+#define MAX_PEDIDOS_TANDA 1024
+#define BYTES_MAXIMOS_TANDA (64u << 20)
+#define MAX_RUTA 4096
+#define MS_COMPLETADO_POR_DEFECTO 10000
+
+typedef enum {
+    FORMATO_RESUMEN,
+    FORMATO_CSV,
+    FORMATO_CUADRO
+} FormatoLote;
+
+// Rango de órdenes [desde, hasta]
+typedef struct {
+    int desde;
+    int hasta;
+} RangoOrdenes;
+
+// Un trabajo: qué cuadros generar y cómo informar cada uno
+typedef struct {
+    bool algoritmos[NUM_ALGORITMOS];
+    RangoOrdenes rangos[MAX_RANGOS];
+    int num_rangos;
+    int cantidad;
+    bool validar;
+    FormatoLote formato;
+    const char* directorio_guardado;    // NULL si no se guardan los cuadros
+    CodificacionCuadro codificacion;
+    const char* archivo_cuadro;         // Si no es NULL se carga en vez de generar
+    bool en_archivo;                    // Generar por bandas directo a directorio_guardado
+    bool explorar;                      // Catalogar combinaciones en vez de generar
+    bool enumerar;                      // Buscar todos los cuadros en vez de generar
+    bool solo_canonicos;                // Con enumerar: uno por clase de simetría
+    long long limite;                   // Con enumerar: cuadros por orden, 0 = todos
+    int aleatorios;                     // Cuadros por búsqueda local por orden, 0 = no
+    uint64_t semilla;
+    const char* archivo_parcial;        // Si no es NULL se completa en vez de generar
+    double ms_completado;
+} TrabajoLote;
+
+// Totales de todo el lote
+typedef struct {
+    long long generados;
+    long long validos;
+    long long invalidos;
+    long long errores;
+    long long combinaciones;    // Las de --explorar: no son cuadros distintos ni se validan
+    bool encabezado_csv;    // Ya se imprimió la cabecera CSV
+} TotalesLote;
+
+
+// Los cuadros generados se toman de aquí y se descartan en cuanto se informan
+static ArenaCuadros arena_lote;
+
+// Pedidos acumulados que todavía no se generaron
+typedef struct {
+    PedidoCuadro pedidos[MAX_PEDIDOS_TANDA];
+    int repeticiones[MAX_PEDIDOS_TANDA];
+    int cantidad;
+    size_t bytes;   // Celdas acumuladas, para no pasar de BYTES_MAXIMOS_TANDA
+} TandaLote;
+
+static TandaLote tanda_lote;
+
+static double ahora_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static void mostrar_uso_lote(void) {
+    fprintf(stderr,
+            "Uso: cuadros_magicos_consola [--algoritmo A] [--ordenes R] [--cantidad K]\n"
+            "                             [--no-validar] [--formato resumen|csv|cuadro]\n"
+            "                             [--trabajos ARCHIVO] [--guardar DIR]\n"
+            "                             [--codificacion plana|delta] [--cargar ARCHIVO]\n"
+            "                             [--en-archivo] [--explorar]\n"
+            "                             [--enumerar todos|canonicos] [--limite K]\n"
+            "                             [--aleatorio K] [--semilla S]\n"
+            "                             [--completar ARCHIVO] [--tiempo MS]\n"
+            "  A: kurosaka, siames, loubere, l, alterno, par_doble, par_simple, par o todos\n"
+            "     (lista separada por comas)\n"
+            "  R: órdenes entre 3 y %d, p. ej. 5, 3-101 o 3-21,101\n"
+            "Sin argumentos se abre el modo interactivo.\n", MAX_ORDEN);
+}
+
+// ============= LECTURA DE OPCIONES =============
+
+static bool leer_algoritmos(const char* texto, TrabajoLote* trabajo) {
+    char copia[256];
+    snprintf(copia, sizeof(copia), "%s", texto);
+
+    for (int a = 0; a < NUM_ALGORITMOS; a++) trabajo->algoritmos[a] = false;
+
+    for (char* nombre = strtok(copia, ","); nombre; nombre = strtok(NULL, ",")) {
+        bool encontrado = false;
+        for (int a = 0; a < NUM_ALGORITMOS; a++) {
+            bool par = a == ALGORITMO_PAR_DOBLE || a == ALGORITMO_PAR_SIMPLE;
+            if (strcmp(nombre, "todos") == 0 || strcmp(nombre, nombre_algoritmo(a)) == 0 ||
+                (par && strcmp(nombre, "par") == 0)) {
+                trabajo->algoritmos[a] = true;
+                encontrado = true;
+            }
+        }
+        if (!encontrado) {
+            fprintf(stderr, "Error: Algoritmo desconocido '%s'.\n", nombre);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool leer_rangos(const char* texto, TrabajoLote* trabajo) {
+    trabajo->num_rangos = 0;
+    const char* p = texto;
+
+    while (*p) {
+        if (trabajo->num_rangos == MAX_RANGOS) {
+            fprintf(stderr, "Error: Demasiados rangos de órdenes (máximo %d).\n", MAX_RANGOS);
+            return false;
+        }
+
+        char* fin;
+        long desde = strtol(p, &fin, 10);
+        long hasta = desde;
+        if (fin == p) break;
+        if (*fin == '-') {
+            p = fin + 1;
+            hasta = strtol(p, &fin, 10);
+            if (fin == p) break;
+        }
+        if (desde < 3 || hasta > MAX_ORDEN || desde > hasta) {
+            fprintf(stderr, "Error: Rango de órdenes inválido en '%s' (entre 3 y %d).\n",
+                    texto, MAX_ORDEN);
+            return false;
+        }
+
+        trabajo->rangos[trabajo->num_rangos].desde = (int)desde;
+        trabajo->rangos[trabajo->num_rangos].hasta = (int)hasta;
+        trabajo->num_rangos++;
+
+        if (*fin == '\0') return true;
+        if (*fin != ',') break;
+        p = fin + 1;
+    }
+
+    fprintf(stderr, "Error: Lista de órdenes inválida '%s'.\n", texto);
+    return false;
+}
+
+// Lee un entero entre minimo y maximo; todo el texto tiene que ser el número
+static bool leer_entero(const char* opcion, const char* valor, long long minimo, long long maximo,
+                        long long* resultado) {
+    char* fin;
+    errno = 0;
+    long long v = strtoll(valor, &fin, 10);
+    if (fin == valor || *fin != '\0' || errno == ERANGE) {
+        fprintf(stderr, "Error: Valor inválido '%s' para %s.\n", valor, opcion);
+        return false;
+    }
+    if (v < minimo || v > maximo) {
+        fprintf(stderr, "Error: %s debe estar entre %lld y %lld.\n", opcion, minimo, maximo);
+        return false;
+    }
+    *resultado = v;
+    return true;
+}
+
+// Lee una semilla de 64 bits sin signo (strtoull aceptaría un '-')
+static bool leer_semilla(const char* valor, uint64_t* semilla) {
+    char* fin;
+    errno = 0;
+    unsigned long long v = strtoull(valor, &fin, 10);
+    if (fin == valor || *fin != '\0' || errno == ERANGE || strchr(valor, '-')) {
+        fprintf(stderr, "Error: Valor inválido '%s' para --semilla.\n", valor);
+        return false;
+    }
+    *semilla = (uint64_t)v;
+    return true;
+}
+
+// Lee una cantidad de milisegundos positiva y finita
+static bool leer_milisegundos(const char* opcion, const char* valor, double* ms) {
+    char* fin;
+    errno = 0;
+    double v = strtod(valor, &fin);
+    if (fin == valor || *fin != '\0' || errno == ERANGE || !isfinite(v) || v <= 0) {
+        fprintf(stderr, "Error: %s debe ser un tiempo positivo en ms, no '%s'.\n", opcion, valor);
+        return false;
+    }
+    *ms = v;
+    return true;
+}
+
+// Aplica las opciones de argv sobre el trabajo. Si archivo no es NULL,
+// --trabajos es válido y su valor se devuelve ahí.
+static bool leer_opciones(int argc, char* argv[], TrabajoLote* trabajo, const char** archivo) {
+    for (int i = 0; i < argc; i++) {
+        const char* opcion = argv[i];
+        const char* valor = i + 1 < argc ? argv[i + 1] : NULL;
+
+        if (strcmp(opcion, "--no-validar") == 0) {
+            trabajo->validar = false;
+            continue;
+        }
+        if (strcmp(opcion, "--validar") == 0) {
+            trabajo->validar = true;
+            continue;
+        }
+        if (strcmp(opcion, "--en-archivo") == 0) {
+            trabajo->en_archivo = true;
+            continue;
+        }
+        if (strcmp(opcion, "--explorar") == 0) {
+            trabajo->explorar = true;
+            continue;
+        }
+        if (strcmp(opcion, "--ayuda") == 0 || strcmp(opcion, "-h") == 0) {
+            return false;
+        }
+        if (!valor) {
+            fprintf(stderr, "Error: Opción desconocida o sin valor '%s'.\n", opcion);
+            return false;
+        }
+        i++;
+
+        if (strcmp(opcion, "--algoritmo") == 0) {
+            if (!leer_algoritmos(valor, trabajo)) return false;
+        } else if (strcmp(opcion, "--ordenes") == 0) {
+            if (!leer_rangos(valor, trabajo)) return false;
+        } else if (strcmp(opcion, "--cantidad") == 0) {
+            long long cantidad;
+            if (!leer_entero(opcion, valor, 1, INT_MAX, &cantidad)) return false;
+            trabajo->cantidad = (int)cantidad;
+        } else if (strcmp(opcion, "--formato") == 0) {
+            if (strcmp(valor, "resumen") == 0) trabajo->formato = FORMATO_RESUMEN;
+            else if (strcmp(valor, "csv") == 0) trabajo->formato = FORMATO_CSV;
+            else if (strcmp(valor, "cuadro") == 0) trabajo->formato = FORMATO_CUADRO;
+            else {
+                fprintf(stderr, "Error: Formato desconocido '%s'.\n", valor);
+                return false;
+            }
+        } else if (strcmp(opcion, "--guardar") == 0) {
+            trabajo->directorio_guardado = valor;
+        } else if (strcmp(opcion, "--codificacion") == 0) {
+            if (strcmp(valor, "plana") == 0) trabajo->codificacion = CODIFICACION_PLANA;
+            else if (strcmp(valor, "delta") == 0) trabajo->codificacion = CODIFICACION_DELTA;
+            else {
+                fprintf(stderr, "Error: Codificación desconocida '%s'.\n", valor);
+                return false;
+            }
+        } else if (strcmp(opcion, "--enumerar") == 0) {
+            if (strcmp(valor, "todos") == 0) trabajo->solo_canonicos = false;
+            else if (strcmp(valor, "canonicos") == 0) trabajo->solo_canonicos = true;
+            else {
+                fprintf(stderr, "Error: Enumeración desconocida '%s'.\n", valor);
+                return false;
+            }
+            trabajo->enumerar = true;
+        } else if (strcmp(opcion, "--limite") == 0) {
+            if (!leer_entero(opcion, valor, 1, LLONG_MAX, &trabajo->limite)) return false;
+        } else if (strcmp(opcion, "--aleatorio") == 0) {
+            long long aleatorios;
+            if (!leer_entero(opcion, valor, 1, INT_MAX, &aleatorios)) return false;
+            trabajo->aleatorios = (int)aleatorios;
+        } else if (strcmp(opcion, "--semilla") == 0) {
+            if (!leer_semilla(valor, &trabajo->semilla)) return false;
+        } else if (strcmp(opcion, "--completar") == 0) {
+            trabajo->archivo_parcial = valor;
+        } else if (strcmp(opcion, "--tiempo") == 0) {
+            if (!leer_milisegundos(opcion, valor, &trabajo->ms_completado)) return false;
+        } else if (strcmp(opcion, "--cargar") == 0) {
+            trabajo->archivo_cuadro = valor;
+        } else if (strcmp(opcion, "--trabajos") == 0 && archivo) {
+            *archivo = valor;
+        } else {
+            fprintf(stderr, "Error: Opción desconocida '%s'.\n", opcion);
+            return false;
+        }
+    }
+    return true;
+}
+
+// ============= EJECUCIÓN =============
+
+static void informar_cuadro(const TrabajoLote* trabajo, TotalesLote* totales, CuadroMagico* cuadro,
+                            const char* algoritmo, int n, int repeticion,
+                            double ms_generacion, double ms_validacion) {
+    const char* estado = !trabajo->validar ? "SIN VALIDAR" :
+                         cuadro->es_valido ? "VÁLIDO" : "INVÁLIDO";
+
+    switch (trabajo->formato) {
+        case FORMATO_CSV:
+            if (!totales->encabezado_csv) {
+                printf("algoritmo,n,repeticion,valido,suma_magica,ms_generacion,ms_validacion\n");
+                totales->encabezado_csv = true;
+            }
+            printf("%s,%d,%d,%s,%lld,%.3f,%.3f\n", algoritmo, n, repeticion,
+                   !trabajo->validar ? "" : cuadro->es_valido ? "1" : "0",
+                   cuadro->suma_magica, ms_generacion, ms_validacion);
+            break;
+        case FORMATO_CUADRO:
+            imprimir_cuadro_magico(cuadro);
+            /* fall through */
+        case FORMATO_RESUMEN:
+            printf("%s n=%d #%d: %s (suma %lld, generación %.3f ms, validación %.3f ms)\n",
+                   algoritmo, n, repeticion, estado,
+                   cuadro->suma_magica, ms_generacion, ms_validacion);
+            break;
+    }
+}
+
+// Ruta DIR/<algoritmo>_<n>_<k>.cmag donde se guarda un cuadro
+static void ruta_guardado(const TrabajoLote* trabajo, TipoAlgoritmo algoritmo, int n, int repeticion,
+                          char ruta[MAX_RUTA]) {
+    snprintf(ruta, MAX_RUTA, "%s/%s_%d_%d.cmag", trabajo->directorio_guardado,
+             nombre_algoritmo(algoritmo), n, repeticion);
+}
+
+// Genera un cuadro por bandas directo a su archivo; para informarlo se
+// carga después con mmap, que no lee nada hasta que se accede a las celdas
+static void generar_en_archivo(const TrabajoLote* trabajo, TotalesLote* totales,
+                               TipoAlgoritmo algoritmo, int n, int repeticion) {
+    char ruta[MAX_RUTA];
+    ruta_guardado(trabajo, algoritmo, n, repeticion, ruta);
+
+    double inicio = ahora_ms();
+    bool es_valido = false;
+    bool ok = generar_cuadro_en_archivo(n, algoritmo, ruta, trabajo->validar, &es_valido, NULL, NULL);
+    double ms_generacion = ahora_ms() - inicio;
+
+    CuadroMagico* cuadro = ok ? cargar_cuadro_magico(ruta) : NULL;
+    if (!cuadro) {
+        fprintf(stderr, "Error: No se pudo generar %s n=%d en '%s'.\n", nombre_algoritmo(algoritmo), n, ruta);
+        totales->errores++;
+        return;
+    }
+
+    if (trabajo->validar) {
+        if (es_valido) totales->validos++;
+        else totales->invalidos++;
+    }
+    totales->generados++;
+
+    informar_cuadro(trabajo, totales, cuadro, nombre_algoritmo(algoritmo), n, repeticion, ms_generacion, 0);
+    liberar_cuadro_magico(cuadro);
+}
+
+// Cuenta, guarda e informa un cuadro ya generado (y validado, si corresponde)
+static void procesar_cuadro(const TrabajoLote* trabajo, TotalesLote* totales, CuadroMagico* cuadro,
+                            int repeticion, double ms_generacion, double ms_validacion) {
+    if (trabajo->validar) {
+        if (cuadro->es_valido) totales->validos++;
+        else totales->invalidos++;
+    }
+    totales->generados++;
+
+    if (trabajo->directorio_guardado) {
+        char ruta[MAX_RUTA];
+        ruta_guardado(trabajo, cuadro->algoritmo, cuadro->tamaño, repeticion, ruta);
+        if (!guardar_cuadro_magico(cuadro, ruta, trabajo->codificacion)) {
+            fprintf(stderr, "Error: No se pudo guardar '%s'.\n", ruta);
+            totales->errores++;
+        }
+    }
+
+    informar_cuadro(trabajo, totales, cuadro, nombre_algoritmo(cuadro->algoritmo), cuadro->tamaño, repeticion,
+                    ms_generacion, ms_validacion);
+}
+
+// Genera de una vez los pedidos acumulados, los informa y vacía la tanda
+static void generar_tanda(const TrabajoLote* trabajo, TotalesLote* totales) {
+    TandaLote* tanda = &tanda_lote;
+    if (tanda->cantidad == 0) return;
+
+    double inicio = ahora_ms();
+    size_t bytes = bytes_lote_cuadros(tanda->pedidos, tanda->cantidad);
+    void* bloque = bytes ? arena_reservar(&arena_lote, bytes) : NULL;
+    LoteCuadros lote;
+    bool ok = bloque && generar_lote_cuadros(&lote, tanda->pedidos, tanda->cantidad,
+                                             bloque, bytes, false);
+    double ms_generacion = ahora_ms() - inicio;
+
+    if (!ok) {
+        for (int i = 0; i < tanda->cantidad; i++) {
+            fprintf(stderr, "Error: No se pudo generar %s n=%d.\n",
+                    nombre_algoritmo(tanda->pedidos[i].algoritmo), tanda->pedidos[i].tamaño);
+        }
+        totales->errores += tanda->cantidad;
+    } else {
+        double ms_validacion = 0;
+        if (trabajo->validar) {
+            inicio = ahora_ms();
+            validar_lote_cuadros(&lote);
+            ms_validacion = ahora_ms() - inicio;
+        }
+
+        for (int i = 0; i < lote.cantidad; i++) {
+            procesar_cuadro(trabajo, totales, &lote.cuadros[i], tanda->repeticiones[i],
+                            ms_generacion / lote.cantidad, ms_validacion / lote.cantidad);
+        }
+    }
+
+    reiniciar_arena_cuadros(&arena_lote);
+    tanda->cantidad = 0;
+    tanda->bytes = 0;
+}
+
+// Agrega un pedido a la tanda, generándola antes si ya no cabe
+static void pedir_cuadro(const TrabajoLote* trabajo, TotalesLote* totales,
+                         TipoAlgoritmo algoritmo, int n, int repeticion) {
+    TandaLote* tanda = &tanda_lote;
+    size_t bytes = bytes_celdas_cuadro(n);
+
+    if (tanda->cantidad == MAX_PEDIDOS_TANDA ||
+        (tanda->cantidad > 0 && tanda->bytes + bytes > BYTES_MAXIMOS_TANDA)) {
+        generar_tanda(trabajo, totales);
+    }
+
+    tanda->pedidos[tanda->cantidad].tamaño = n;
+    tanda->pedidos[tanda->cantidad].algoritmo = algoritmo;
+    tanda->repeticiones[tanda->cantidad] = repeticion;
+    tanda->cantidad++;
+    tanda->bytes += bytes;
+}
+
+// Cataloga las combinaciones de un orden que dan cuadros mágicos. Se
+// cuentan aparte: varias combinaciones pueden dar el mismo cuadro.
+static void explorar_orden(const TrabajoLote* trabajo, TotalesLote* totales, int n) {
+    double inicio = ahora_ms();
+    CatalogoMovimientos catalogo;
+    if (!explorar_movimientos(n, 0, &catalogo)) {
+        fprintf(stderr, "Error: No se pudo explorar n=%d (órdenes impares hasta %d).\n",
+                n, MAX_ORDEN_EXPLORACION);
+        totales->errores++;
+        return;
+    }
+    double ms = ahora_ms() - inicio;
+    totales->combinaciones += catalogo.cantidad;
+
+    if (trabajo->formato == FORMATO_CSV) {
+        if (!totales->encabezado_csv) {
+            printf("n,fila0,columna0,df,dc,bf,bc,fijo\n");
+            totales->encabezado_csv = true;
+        }
+        for (int i = 0; i < catalogo.cantidad; i++) {
+            const CombinacionMagica* c = &catalogo.combinaciones[i];
+            printf("%d,%d,%d,%d,%d,%d,%d,%d\n", n, c->fila0, c->columna0,
+                   c->df, c->dc, c->bf, c->bc, c->fijo ? 1 : 0);
+        }
+    } else {
+        printf("n=%d: %d combinaciones mágicas de %lld (%lld con colisión) en %.1f ms\n",
+               n, catalogo.cantidad, catalogo.probadas, catalogo.colisiones, ms);
+        if (catalogo.cantidad > 0) {
+            const CombinacionMagica* c = &catalogo.combinaciones[0];
+            printf("  más barata: inicio (%d, %d), paso (%d, %d), break-move (%d, %d)%s\n",
+                   c->fila0, c->columna0, c->df, c->dc, c->bf, c->bc,
+                   c->fijo ? ", calendario fijo" : "");
+        }
+    }
+    liberar_catalogo_movimientos(&catalogo);
+}
+
+// Busca todos los cuadros mágicos de un orden (o los primeros limite).
+// Cada cuadro encontrado cuenta como generado y válido.
+static void enumerar_orden(const TrabajoLote* trabajo, TotalesLote* totales, int n) {
+    OpcionesEnumeracion opciones = {trabajo->solo_canonicos, trabajo->limite, 0};
+    EnumeracionCuadros enumeracion;
+
+    double inicio = ahora_ms();
+    if (!enumerar_cuadros_magicos(n, &opciones, &enumeracion)) {
+        fprintf(stderr, "Error: No se pudo enumerar n=%d (órdenes hasta %d).\n",
+                n, MAX_ORDEN_ENUMERACION);
+        totales->errores++;
+        return;
+    }
+    double ms = ahora_ms() - inicio;
+    totales->generados += enumeracion.cantidad;
+    totales->validos += enumeracion.cantidad;
+
+    int celdas = n * n;
+    for (long long k = 0; k < enumeracion.cantidad && trabajo->formato != FORMATO_RESUMEN; k++) {
+        const uint8_t* cuadro = enumeracion.cuadros + (size_t)k * celdas;
+        if (trabajo->formato == FORMATO_CSV) {
+            if (!totales->encabezado_csv) {
+                printf("n,celdas\n");
+                totales->encabezado_csv = true;
+            }
+            printf("%d,", n);
+            for (int c = 0; c < celdas; c++) printf("%s%d", c ? " " : "", cuadro[c]);
+            printf("\n");
+        } else {
+            for (int i = 0; i < n; i++) {
+                for (int j = 0; j < n; j++) printf("%3d", cuadro[i * n + j]);
+                printf("\n");
+            }
+            printf("\n");
+        }
+    }
+
+    if (trabajo->formato != FORMATO_CSV) {
+        printf("n=%d: %lld cuadros mágicos%s%s (%lld celdas probadas) en %.1f ms\n",
+               n, enumeracion.cantidad, trabajo->solo_canonicos ? " canónicos" : "",
+               enumeracion.completa ? "" : ", cortado por el límite", enumeracion.nodos, ms);
+    }
+    liberar_enumeracion_cuadros(&enumeracion);
+}
+
+// Genera los cuadros aleatorios de un orden y los informa como cualquier
+// otro cuadro; el tiempo de generación de cada uno es su parte del total
+static void generar_aleatorios_orden(const TrabajoLote* trabajo, TotalesLote* totales, int n) {
+    OpcionesBusquedaLocal opciones = {trabajo->aleatorios, trabajo->semilla + (uint64_t)n, 0};
+    CuadrosAleatorios aleatorios;
+
+    double inicio = ahora_ms();
+    if (!generar_cuadros_aleatorios(n, &opciones, &aleatorios)) {
+        fprintf(stderr, "Error: No se pudieron generar cuadros aleatorios de n=%d (órdenes hasta %d).\n",
+                n, MAX_ORDEN_BUSQUEDA_LOCAL);
+        totales->errores++;
+        return;
+    }
+    double ms_generacion = aleatorios.cantidad > 0 ? (ahora_ms() - inicio) / aleatorios.cantidad : 0;
+    if (aleatorios.cantidad < trabajo->aleatorios) {
+        fprintf(stderr, "Aviso: n=%d solo dio %d cuadros distintos de %d.\n",
+                n, aleatorios.cantidad, trabajo->aleatorios);
+    }
+
+    size_t bytes_cuadro = (size_t)n * n * aleatorios.ancho;
+    for (int k = 0; k < aleatorios.cantidad; k++) {
+        CuadroMagico cuadro;
+        memset(&cuadro, 0, sizeof(cuadro));
+        cuadro.matriz = (char*)aleatorios.cuadros + k * bytes_cuadro;
+        cuadro.ancho = aleatorios.ancho;
+        cuadro.tamaño = n;
+        cuadro.suma_magica = calcular_suma_magica(n);
+        cuadro.modo = CUADRO_MATERIALIZADO;
+
+        double ms_validacion = 0;
+        if (trabajo->validar) {
+            double inicio_validacion = ahora_ms();
+            cuadro.es_valido = validar_cuadro_magico(&cuadro);
+            ms_validacion = ahora_ms() - inicio_validacion;
+            if (cuadro.es_valido) totales->validos++;
+            else totales->invalidos++;
+        }
+        totales->generados++;
+        informar_cuadro(trabajo, totales, &cuadro, "aleatorio", n, k + 1, ms_generacion, ms_validacion);
+    }
+    liberar_cuadros_aleatorios(&aleatorios);
+}
+
+// Lee un cuadro parcial de texto: n² números con 0 o '.' en las vacías.
+// Devuelve n, o 0 si el archivo no tiene un cuadro de orden válido. Un
+// valor mayor que MAX_ORDEN_COMPLETADO² no entraría en la celda, así que
+// invalida el archivo; los que solo pasan de n² los da por imposibles el
+// completado.
+static int leer_cuadro_parcial(const char* ruta, int* valores, int max_celdas) {
+    FILE* archivo = fopen(ruta, "r");
+    if (!archivo) return 0;
+
+    int cantidad = 0;
+    char palabra[32];
+    bool ok = true;
+    while (ok && fscanf(archivo, "%31s", palabra) == 1) {
+        char* fin;
+        errno = 0;
+        long v = strcmp(palabra, ".") == 0 ? 0 : strtol(palabra, &fin, 10);
+        if (strcmp(palabra, ".") != 0 && (*fin != '\0' || errno == ERANGE || v < 0 ||
+                                          v > MAX_ORDEN_COMPLETADO * MAX_ORDEN_COMPLETADO)) ok = false;
+        else if (cantidad == max_celdas) ok = false;
+        else valores[cantidad++] = (int)v;
+    }
+    fclose(archivo);
+
+    int n = 3;
+    while (n * n < cantidad) n++;
+    return ok && n * n == cantidad ? n : 0;
+}
+
+// Completa el cuadro parcial del trabajo y lo informa como uno generado
+static void completar_archivo(const TrabajoLote* trabajo, TotalesLote* totales) {
+    if (trabajo->directorio_guardado) {
+        fprintf(stderr, "Error: Los cuadros de --completar no se pueden guardar.\n");
+        totales->errores++;
+        return;
+    }
+
+    int valores[MAX_ORDEN_COMPLETADO * MAX_ORDEN_COMPLETADO];
+    int n = leer_cuadro_parcial(trabajo->archivo_parcial, valores, MAX_ORDEN_COMPLETADO * MAX_ORDEN_COMPLETADO);
+    if (n == 0) {
+        fprintf(stderr, "Error: '%s' no tiene un cuadro parcial de orden 3 a %d.\n",
+                trabajo->archivo_parcial, MAX_ORDEN_COMPLETADO);
+        totales->errores++;
+        return;
+    }
+
+    CuadroMagico cuadro;
+    memset(&cuadro, 0, sizeof(cuadro));
+    cuadro.ancho = ancho_celda_para_orden(n);
+    cuadro.tamaño = n;
+    cuadro.suma_magica = calcular_suma_magica(n);
+    cuadro.modo = CUADRO_MATERIALIZADO;
+    cuadro.matriz = malloc((size_t)n * n * cuadro.ancho);
+    if (!cuadro.matriz) {
+        totales->errores++;
+        return;
+    }
+    for (int k = 0; k < n * n; k++) escribir_celda(cuadro.matriz, cuadro.ancho, k, (unsigned long long)valores[k]);
+
+    EstadisticasCompletado estadisticas;
+    ResultadoCompletado resultado = completar_cuadro_magico(&cuadro, 0, trabajo->ms_completado, &estadisticas);
+
+    if (resultado == COMPLETADO_ENCONTRADO) {
+        double ms_validacion = 0;
+        if (trabajo->validar) {
+            double inicio = ahora_ms();
+            cuadro.es_valido = validar_cuadro_magico(&cuadro);
+            ms_validacion = ahora_ms() - inicio;
+            if (cuadro.es_valido) totales->validos++;
+            else totales->invalidos++;
+        }
+        totales->generados++;
+        informar_cuadro(trabajo, totales, &cuadro, "completado", n, 1, estadisticas.ms, ms_validacion);
+    } else {
+        fprintf(stderr, "%s n=%d: %s (%lld estados, %d ramas, %.1f ms)\n", trabajo->archivo_parcial, n,
+                nombre_resultado_completado(resultado), estadisticas.nodos, estadisticas.ramas, estadisticas.ms);
+        if (resultado == COMPLETADO_IMPOSIBLE) {
+            totales->generados++;
+            totales->invalidos++;
+        } else {
+            totales->errores++;
+        }
+    }
+    free(cuadro.matriz);
+}
+
+static void ejecutar_trabajo(const TrabajoLote* trabajo, TotalesLote* totales) {
+    if (trabajo->archivo_parcial) {
+        completar_archivo(trabajo, totales);
+        return;
+    }
+
+    if (trabajo->archivo_cuadro) {
+        double inicio = ahora_ms();
+        CuadroMagico* cuadro = cargar_cuadro_magico(trabajo->archivo_cuadro);
+        double ms_carga = ahora_ms() - inicio;
+
+        if (!cuadro) {
+            fprintf(stderr, "Error: No se pudo cargar '%s'.\n", trabajo->archivo_cuadro);
+            totales->errores++;
+            return;
+        }
+
+        double ms_validacion = 0;
+        if (trabajo->validar) {
+            inicio = ahora_ms();
+            cuadro->es_valido = validar_cuadro_magico(cuadro);
+            ms_validacion = ahora_ms() - inicio;
+        }
+        procesar_cuadro(trabajo, totales, cuadro, 1, ms_carga, ms_validacion);
+        liberar_cuadro_magico(cuadro);
+        return;
+    }
+
+    if (trabajo->en_archivo && !trabajo->directorio_guardado) {
+        fprintf(stderr, "Error: --en-archivo necesita --guardar DIR.\n");
+        totales->errores++;
+        return;
+    }
+    if (trabajo->aleatorios > 0 && trabajo->directorio_guardado) {
+        fprintf(stderr, "Error: Los cuadros de --aleatorio no se pueden guardar.\n");
+        totales->errores++;
+        return;
+    }
+
+    for (int r = 0; r < trabajo->num_rangos; r++) {
+        for (int n = trabajo->rangos[r].desde; n <= trabajo->rangos[r].hasta; n++) {
+            if (trabajo->explorar) {
+                // Los recorridos solo existen para órdenes impares
+                if (n % 2 == 1) explorar_orden(trabajo, totales, n);
+                continue;
+            }
+            if (trabajo->enumerar) {
+                if (n <= MAX_ORDEN_ENUMERACION) enumerar_orden(trabajo, totales, n);
+                continue;
+            }
+            if (trabajo->aleatorios > 0) {
+                if (n <= MAX_ORDEN_BUSQUEDA_LOCAL) generar_aleatorios_orden(trabajo, totales, n);
+                continue;
+            }
+            for (int a = 0; a < NUM_ALGORITMOS; a++) {
+                if (!trabajo->algoritmos[a] || !orden_valido_para_algoritmo(n, (TipoAlgoritmo)a)) continue;
+
+                for (int k = 1; k <= trabajo->cantidad; k++) {
+                    if (trabajo->en_archivo) {
+                        generar_en_archivo(trabajo, totales, (TipoAlgoritmo)a, n, k);
+                        continue;
+                    }
+
+                    pedir_cuadro(trabajo, totales, (TipoAlgoritmo)a, n, k);
+                }
+            }
+        }
+    }
+    generar_tanda(trabajo, totales);
+}
+
+// Ejecuta cada línea del archivo como un trabajo que parte de las opciones base
+static bool ejecutar_archivo_trabajos(const char* ruta, const TrabajoLote* base, TotalesLote* totales) {
+    FILE* archivo = strcmp(ruta, "-") == 0 ? stdin : fopen(ruta, "r");
+    if (!archivo) {
+        fprintf(stderr, "Error: No se pudo abrir el archivo de trabajos '%s'.\n", ruta);
+        return false;
+    }
+
+    char linea[MAX_LINEA_TRABAJO];
+    int numero_linea = 0;
+    bool ok = true;
+
+    while (fgets(linea, sizeof(linea), archivo)) {
+        numero_linea++;
+        char* comentario = strchr(linea, '#');
+        if (comentario) *comentario = '\0';
+
+        char* argumentos[MAX_ARGUMENTOS_TRABAJO];
+        int num_argumentos = 0;
+        for (char* palabra = strtok(linea, " \t\r\n"); palabra && num_argumentos < MAX_ARGUMENTOS_TRABAJO;
+             palabra = strtok(NULL, " \t\r\n")) {
+            argumentos[num_argumentos++] = palabra;
+        }
+        if (num_argumentos == 0) continue;
+
+        TrabajoLote trabajo = *base;
+        if (!leer_opciones(num_argumentos, argumentos, &trabajo, NULL)) {
+            fprintf(stderr, "  (en %s, línea %d)\n", ruta, numero_linea);
+            ok = false;
+            continue;
+        }
+        ejecutar_trabajo(&trabajo, totales);
+    }
+
+    if (archivo != stdin) fclose(archivo);
+    return ok;
+}
+
+int ejecutar_modo_lote(int argc, char* argv[]) {
+    // Por defecto: Kurosaka, orden 5, un cuadro, validado, resumen
+    TrabajoLote base;
+    memset(&base, 0, sizeof(base));
+    base.algoritmos[ALGORITMO_KUROSAKA] = true;
+    base.rangos[0].desde = 5;
+    base.rangos[0].hasta = 5;
+    base.num_rangos = 1;
+    base.cantidad = 1;
+    base.validar = true;
+    base.formato = FORMATO_RESUMEN;
+    base.codificacion = CODIFICACION_PLANA;
+    base.semilla = (uint64_t)time(NULL);
+    base.ms_completado = MS_COMPLETADO_POR_DEFECTO;
+
+    const char* archivo = NULL;
+    if (!leer_opciones(argc - 1, argv + 1, &base, &archivo)) {
+        mostrar_uso_lote();
+        return 1;
+    }
+
+    TotalesLote totales;
+    memset(&totales, 0, sizeof(totales));
+
+    iniciar_arena_cuadros(&arena_lote, 0);
+    double inicio = ahora_ms();
+    bool ok = true;
+    if (archivo) {
+        ok = ejecutar_archivo_trabajos(archivo, &base, &totales);
+    } else {
+        ejecutar_trabajo(&base, &totales);
+    }
+    fflush(stdout);
+    destruir_arena_cuadros(&arena_lote);
+
+    if (totales.combinaciones > 0) {
+        fprintf(stderr, "Exploración: %lld combinaciones mágicas\n", totales.combinaciones);
+    }
+    fprintf(stderr, "Lote: %lld cuadros, %lld válidos, %lld inválidos, %lld errores en %.1f ms\n",
+            totales.generados, totales.validos, totales.invalidos, totales.errores,
+            ahora_ms() - inicio);
+
+    return ok && totales.errores == 0 ? 0 : 1;
+}
@@ -0,0 +1,13 @@
+/*
+ * Modo por lotes de la versión de consola: genera y valida muchos cuadros
+ * en un solo proceso, sin menús ni preguntas, según las opciones de la línea
+ * de comandos o de un archivo de trabajos.
+ */
+
+#ifndef MODO_LOTE_H
+#define MODO_LOTE_H
+
+// Ejecuta el lote descrito por argv; devuelve el código de salida del programa
+int ejecutar_modo_lote(int argc, char* argv[]);
+
+#endif // MODO_LOTE_H
@@ -1,57 +1,61 @@
 /*
- * Implementación de las funciones de movimientos
+ * Implementación del motor de movimientos
  * para evitar problemas de linkeo
  */
 
 #include "movimientos.h"
 
-// Método Siamés clásico: mueve en diagonal izquierda-abajo y ajusta si está ocupado
-int metodoSiames(int matriz[max][max], int n, int fila, int columna) {
-    int nuevaFila = (fila - 1 + n) % n;
-    int nuevaColumna = (columna + 1) % n;
-
-    if (matriz[nuevaFila][nuevaColumna] != 0) { 
-        nuevaFila = (fila + 1) % n;
-        nuevaColumna = columna;
+// Construcciones de la biblioteca, todas desde el centro de la primera fila
+const DescriptorMovimiento descriptores_algoritmo[ALGORITMO_ALTERNO + 1] = {
+    // Kurosaka: noreste, break-move hacia abajo
+    [ALGORITMO_KUROSAKA] = {"kurosaka", -1,  1,  1, 0, 0, 1},
+    // Siamés clásico: igual que Kurosaka
+    [ALGORITMO_SIAMES]   = {"siames",   -1,  1,  1, 0, 0, 1},
+    // De la Loubère: abajo-izquierda, break-move hacia arriba
+    [ALGORITMO_LOUBERE]  = {"loubere",   1, -1, -1, 0, 0, 1},
+    // Movimiento en L (caballo): dos arriba y uno a la derecha, break-move hacia abajo
+    [ALGORITMO_L]        = {"l",        -2,  1,  1, 0, 0, 1},
+    // Alterno de diagonales: arriba-izquierda, break-move hacia abajo
+    [ALGORITMO_ALTERNO]  = {"alterno",  -1, -1,  1, 0, 0, 1},
+};
+
+const DescriptorMovimiento* descriptor_de_algoritmo(TipoAlgoritmo algoritmo) {
+    if (algoritmo < ALGORITMO_KUROSAKA || algoritmo > ALGORITMO_ALTERNO) {
+        algoritmo = ALGORITMO_KUROSAKA;
     }
-
-    return nuevaFila * max + nuevaColumna;
+    return &descriptores_algoritmo[algoritmo];
 }
 
-// Método en L: movimiento en forma de caballo del ajedrez
-// (arriba y a la izquierda) y ajusta si está ocupado
-int metodoEnL(int matriz[max][max], int n, int fila, int columna) {
-    int nuevaFila = (fila - 2 + n) % n;
-    int nuevaColumna = (columna + 1) % n;
-    if (matriz[nuevaFila][nuevaColumna] != 0) {
-        nuevaFila = (fila + 1) % n;
-        nuevaColumna = columna;
+// Máximo común divisor (a y b no negativos)
+static int mcd(int a, int b) {
+    while (b != 0) {
+        int r = a % b;
+        a = b;
+        b = r;
     }
-    return nuevaFila * max + nuevaColumna;
+    return a;
 }
 
-// Método De la Loubère: mueve en diagonal derecha-arriba y ajusta si está ocupado
-int metodoLouber(int matriz[max][max], int n, int fila, int columna) {
-    int nuevaFila = (fila + 1) % n;
-    int nuevaColumna = (columna - 1 + n) % n;
-
-    if (matriz[nuevaFila][nuevaColumna] != 0) {
-        nuevaFila = (fila - 1 + n) % n;
-        nuevaColumna = columna;
-    }
-
-    return nuevaFila * max + nuevaColumna;
+// Reduce a al rango [0, n)
+static int reducir(int a, int n) {
+    int r = a % n;
+    return r < 0 ? r + n : r;
 }
 
-// Método Alterno de Diagonales: variante del método siamés,
-// mueve en diagonal derecha-abajo y ajusta si está ocupado
-int metodoAlterno(int matriz[max][max], int n, int fila, int columna) {
-    int nuevaFila = (fila - 1 + n) % n;
-    int nuevaColumna = (columna - 1 + n) % n;
-    if (matriz[nuevaFila][nuevaColumna] != 0) {
-        nuevaFila = (fila + 1) % n;
-        nuevaColumna = columna;
-    }
-    return nuevaFila * max + nuevaColumna;
+// Con d el movimiento principal y b el break-move, el número k = q*n + p
+// (base 0) cae en inicio + q*(b - d) + p*d. Si ese mapeo es biyectivo (el
+// determinante es invertible módulo n) ninguna celda se repite y el
+// movimiento principal solo choca al cerrar cada ciclo de n pasos.
+void iniciar_recorrido(Recorrido* recorrido, int n, const DescriptorMovimiento* d) {
+    int determinante = (d->bf - d->df) * d->dc - d->df * (d->bc - d->dc);
+
+    recorrido->n = n;
+    recorrido->fila = d->ancla_fila * (n - 1) / 2;
+    recorrido->columna = d->ancla_columna * (n - 1) / 2;
+    recorrido->df = reducir(d->df, n);
+    recorrido->dc = reducir(d->dc, n);
+    recorrido->bf = reducir(d->bf, n);
+    recorrido->bc = reducir(d->bc, n);
+    recorrido->restantes = n;
+    recorrido->fijo = mcd(reducir(determinante, n), n) == 1;
 }
-
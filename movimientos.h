@@ -1,19 +1,91 @@
 /*
-                Esta sección contiene las declaraciones de las funciones de movimientos
-                en las cuales se pueden colocar los números. Está el método
-                Siames, el movimiento en L, la espiral y el método alterno
-                al Siames.
+                Esta sección contiene el motor de movimientos con el que se
+                colocan los números. Cada construcción (Siamés, movimiento en
+                L, De la Loubère, alterno, ...) es un descriptor con su
+                movimiento principal, su break-move y su celda de inicio; el
+                mismo recorrido sirve a la biblioteca, la consola y las dos
+                interfaces gráficas.
 */
 
 #ifndef MOVIMIENTOS_H
 #define MOVIMIENTOS_H
 
-#define max 21  // Tamaño máximo para la matriz
+#include "cuadros_magicos.h"
 
-// Declaraciones de las funciones de movimientos
-int metodoSiames(int matriz[max][max], int n, int fila, int columna);
-int metodoEnL(int matriz[max][max], int n, int fila, int columna);
-int metodoLouber(int matriz[max][max], int n, int fila, int columna);
-int metodoAlterno(int matriz[max][max], int n, int fila, int columna);
+// Una construcción por recorrido con break-move. Agregar una construcción
+// es agregar una de estas entradas.
+typedef struct {
+    const char* nombre;
+    int df, dc;             // Movimiento principal (fila, columna)
+    int bf, bc;             // Break-move, si el destino ya está ocupado
+    int ancla_fila;         // Celda de inicio en mitades de n - 1:
+    int ancla_columna;      // 0 = primera, 1 = centro, 2 = última
+} DescriptorMovimiento;
 
-#endif // MOVIMIENTOS_H
\ No newline at end of file
+// Un descriptor por TipoAlgoritmo, en el orden de la enumeración
+extern const DescriptorMovimiento descriptores_algoritmo[ALGORITMO_ALTERNO + 1];
+
+const DescriptorMovimiento* descriptor_de_algoritmo(TipoAlgoritmo algoritmo);
+
+// Estado de un recorrido sobre un cuadro de orden n. Los vectores se
+// reducen a [0, n) una sola vez al iniciar, así que cada paso da la vuelta
+// al borde con una resta condicional en lugar de un módulo.
+//
+// Si el determinante de los vectores es invertible módulo n, el movimiento
+// principal llega a una celda ocupada exactamente cada n pasos (calendario
+// fijo): basta un contador en lugar de consultar la matriz. Si no lo es,
+// el recorrido depende de lo que ya está escrito y hay que consultarla.
+typedef struct {
+    int n;
+    int fila, columna;      // Posición del número actual
+    int df, dc;             // Movimiento principal, reducido a [0, n)
+    int bf, bc;             // Break-move, reducido a [0, n)
+    int restantes;          // Pasos hasta el próximo break-move (n al empezar)
+    bool fijo;              // El break-move sigue un calendario fijo
+} Recorrido;
+
+// Deja el recorrido en la celda de inicio del descriptor. La posición se
+// puede cambiar antes del primer paso: el calendario no depende de ella.
+void iniciar_recorrido(Recorrido* recorrido, int n, const DescriptorMovimiento* descriptor);
+
+// Avanza con calendario fijo, sin saltos ni lecturas de memoria
+static inline void avanzar_recorrido_fijo(Recorrido* r) {
+    int romper = --r->restantes == 0;
+    int df = romper ? r->bf : r->df;
+    int dc = romper ? r->bc : r->dc;
+    r->restantes = romper ? r->n : r->restantes;
+
+    int fila = r->fila + df;
+    int columna = r->columna + dc;
+    r->fila = fila >= r->n ? fila - r->n : fila;
+    r->columna = columna >= r->n ? columna - r->n : columna;
+}
+
+// Avanza consultando la matriz (n*n celdas del ancho dado, fila por fila):
+// break-move si el destino del movimiento principal no está en cero
+static inline void avanzar_recorrido_consultando(Recorrido* r, const void* matriz, AnchoCelda ancho) {
+    int fila = r->fila + r->df;
+    int columna = r->columna + r->dc;
+    fila = fila >= r->n ? fila - r->n : fila;
+    columna = columna >= r->n ? columna - r->n : columna;
+
+    if (leer_celda(matriz, ancho, (size_t)fila * r->n + columna) != 0) {
+        fila = r->fila + r->bf;
+        columna = r->columna + r->bc;
+        fila = fila >= r->n ? fila - r->n : fila;
+        columna = columna >= r->n ? columna - r->n : columna;
+    }
+    r->fila = fila;
+    r->columna = columna;
+}
+
+// Un paso para quien avanza de a uno (el llenado paso a paso de la interfaz)
+static inline void avanzar_recorrido(Recorrido* r, const void* matriz, AnchoCelda ancho) {
+    if (r->fijo) {
+        avanzar_recorrido_fijo(r);
+    } else {
+        avanzar_recorrido_consultando(r, matriz, ancho);
+    }
+}
+
+#endif // MOVIMIENTOS_H
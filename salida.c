@@ -0,0 +1,85 @@
+/*
+ * Escritor con buffer y conversión de enteros sin printf
+ */
+
+#include <string.h>
+#include "salida.h"
+
+void escritor_iniciar(EscritorSalida* escritor, FILE* destino) {
+    escritor->destino = destino;
+    escritor->usado = 0;
+}
+
+// Entrega lo acumulado al FILE; los printf previos sobre el mismo FILE
+// quedan antes en la salida porque fwrite respeta su buffer
+void escritor_vaciar(EscritorSalida* escritor) {
+    if (escritor->usado > 0) {
+        fwrite(escritor->buffer, 1, escritor->usado, escritor->destino);
+        escritor->usado = 0;
+    }
+    fflush(escritor->destino);
+}
+
+// Garantiza espacio para longitud bytes (longitud <= TAMANO_BUFFER_SALIDA)
+static inline void reservar_espacio(EscritorSalida* escritor, size_t longitud) {
+    if (escritor->usado + longitud > TAMANO_BUFFER_SALIDA) {
+        fwrite(escritor->buffer, 1, escritor->usado, escritor->destino);
+        escritor->usado = 0;
+    }
+}
+
+void escritor_bytes(EscritorSalida* escritor, const char* datos, size_t longitud) {
+    if (longitud > TAMANO_BUFFER_SALIDA) {
+        escritor_vaciar(escritor);
+        fwrite(datos, 1, longitud, escritor->destino);
+        return;
+    }
+    reservar_espacio(escritor, longitud);
+    memcpy(escritor->buffer + escritor->usado, datos, longitud);
+    escritor->usado += longitud;
+}
+
+void escritor_texto(EscritorSalida* escritor, const char* texto) {
+    escritor_bytes(escritor, texto, strlen(texto));
+}
+
+void escritor_caracter(EscritorSalida* escritor, char c) {
+    reservar_espacio(escritor, 1);
+    escritor->buffer[escritor->usado++] = c;
+}
+
+int digitos_decimales(unsigned long long valor) {
+    int digitos = 1;
+    while (valor >= 10) {
+        valor /= 10;
+        digitos++;
+    }
+    return digitos;
+}
+
+void escritor_entero(EscritorSalida* escritor, unsigned long long valor, int ancho) {
+    if (ancho > TAMANO_BUFFER_SALIDA / 2) ancho = TAMANO_BUFFER_SALIDA / 2;
+    int digitos = digitos_decimales(valor);
+    int total = digitos > ancho ? digitos : ancho;
+    reservar_espacio(escritor, (size_t)total);
+
+    // Relleno a la izquierda y luego los dígitos escritos de atrás hacia adelante
+    char* inicio = escritor->buffer + escritor->usado;
+    memset(inicio, ' ', (size_t)(total - digitos));
+    char* p = inicio + total;
+    do {
+        *--p = (char)('0' + valor % 10);
+        valor /= 10;
+    } while (valor != 0);
+
+    escritor->usado += (size_t)total;
+}
+
+void escritor_entero_con_signo(EscritorSalida* escritor, long long valor) {
+    if (valor < 0) {
+        escritor_caracter(escritor, '-');
+        escritor_entero(escritor, 0ULL - (unsigned long long)valor, 0);
+    } else {
+        escritor_entero(escritor, (unsigned long long)valor, 0);
+    }
+}
@@ -0,0 +1,38 @@
+/*
+ * Escritura de texto con buffer propio para la salida de consola.
+ *
+ * Los números se convierten a dígitos directamente en un buffer grande que
+ * se vacía con pocas llamadas a fwrite, en lugar de un printf por celda.
+ */
+
+#ifndef SALIDA_H
+#define SALIDA_H
+
+#include <stdio.h>
+#include <stddef.h>
+
+// Tamaño del buffer de un escritor
+#define TAMANO_BUFFER_SALIDA (1 << 16)
+
+typedef struct {
+    FILE* destino;
+    size_t usado;
+    char buffer[TAMANO_BUFFER_SALIDA];
+} EscritorSalida;
+
+void escritor_iniciar(EscritorSalida* escritor, FILE* destino);
+void escritor_vaciar(EscritorSalida* escritor);
+
+void escritor_texto(EscritorSalida* escritor, const char* texto);
+void escritor_bytes(EscritorSalida* escritor, const char* datos, size_t longitud);
+void escritor_caracter(EscritorSalida* escritor, char c);
+
+// Escribe un entero no negativo alineado a la derecha en ancho columnas
+// (ancho 0 no agrega relleno)
+void escritor_entero(EscritorSalida* escritor, unsigned long long valor, int ancho);
+void escritor_entero_con_signo(EscritorSalida* escritor, long long valor);
+
+// Cantidad de dígitos decimales de valor
+int digitos_decimales(unsigned long long valor);
+
+#endif // SALIDA_H
@@ -0,0 +1,402 @@
+/*
+ * Kernels de validación por filas (escalar, SSE2 y AVX2) y
+ * validación paralela por bandas de filas
+ */
+
+#define _DEFAULT_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "validacion.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VALIDACION_X86 1
+#include <immintrin.h>
+#endif
+
+// Kernels escalares: referencia y respaldo para otras arquitecturas.
+// Las celdas no tienen signo, así que se extienden con ceros a 64 bits.
+#define DEFINIR_KERNEL_ESCALAR(NOMBRE, TIPO)                                        \
+static long long NOMBRE(const void* datos, int n, long long* sumas_columna) {       \
+    const TIPO* fila = (const TIPO*)datos;                                          \
+    long long suma = 0;                                                             \
+    for (int j = 0; j < n; j++) {                                                   \
+        suma += (long long)fila[j];                                                 \
+        sumas_columna[j] += (long long)fila[j];                                     \
+    }                                                                               \
+    return suma;                                                                    \
+}
+
+DEFINIR_KERNEL_ESCALAR(kernel_fila_escalar_16, uint16_t)
+DEFINIR_KERNEL_ESCALAR(kernel_fila_escalar_32, uint32_t)
+DEFINIR_KERNEL_ESCALAR(kernel_fila_escalar_64, uint64_t)
+
+#ifdef VALIDACION_X86
+
+// Suma cuatro columnas de 64 bits (bajo: j, j+1; alto: j+2, j+3) a los acumuladores
+__attribute__((target("sse2")))
+static inline __m128i acumular_sse2(long long* sumas_columna, __m128i bajo, __m128i alto) {
+    __m128i* col = (__m128i*)sumas_columna;
+    _mm_storeu_si128(col, _mm_add_epi64(_mm_loadu_si128(col), bajo));
+    _mm_storeu_si128(col + 1, _mm_add_epi64(_mm_loadu_si128(col + 1), alto));
+    return _mm_add_epi64(bajo, alto);
+}
+
+__attribute__((target("sse2")))
+static inline long long reducir_sse2(__m128i suma) {
+    long long parcial[2];
+    _mm_storeu_si128((__m128i*)parcial, suma);
+    return parcial[0] + parcial[1];
+}
+
+// SSE2, 16 bits: 8 celdas por iteración, extendidas intercalando ceros dos veces
+__attribute__((target("sse2")))
+static long long kernel_fila_sse2_16(const void* datos, int n, long long* sumas_columna) {
+    const uint16_t* fila = (const uint16_t*)datos;
+    const __m128i cero = _mm_setzero_si128();
+    __m128i suma = _mm_setzero_si128();
+    int j = 0;
+
+    for (; j + 8 <= n; j += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(fila + j));
+        __m128i bajo32 = _mm_unpacklo_epi16(v, cero);     // columnas j..j+3
+        __m128i alto32 = _mm_unpackhi_epi16(v, cero);     // columnas j+4..j+7
+        suma = _mm_add_epi64(suma, acumular_sse2(sumas_columna + j,
+                                                 _mm_unpacklo_epi32(bajo32, cero),
+                                                 _mm_unpackhi_epi32(bajo32, cero)));
+        suma = _mm_add_epi64(suma, acumular_sse2(sumas_columna + j + 4,
+                                                 _mm_unpacklo_epi32(alto32, cero),
+                                                 _mm_unpackhi_epi32(alto32, cero)));
+    }
+
+    return reducir_sse2(suma) + kernel_fila_escalar_16(fila + j, n - j, sumas_columna + j);
+}
+
+// SSE2, 32 bits: 4 celdas por iteración
+__attribute__((target("sse2")))
+static long long kernel_fila_sse2_32(const void* datos, int n, long long* sumas_columna) {
+    const uint32_t* fila = (const uint32_t*)datos;
+    const __m128i cero = _mm_setzero_si128();
+    __m128i suma = _mm_setzero_si128();
+    int j = 0;
+
+    for (; j + 4 <= n; j += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(fila + j));
+        suma = _mm_add_epi64(suma, acumular_sse2(sumas_columna + j,
+                                                 _mm_unpacklo_epi32(v, cero),    // columnas j, j+1
+                                                 _mm_unpackhi_epi32(v, cero)));  // columnas j+2, j+3
+    }
+
+    return reducir_sse2(suma) + kernel_fila_escalar_32(fila + j, n - j, sumas_columna + j);
+}
+
+// SSE2, 64 bits: las celdas ya tienen el ancho de los acumuladores
+__attribute__((target("sse2")))
+static long long kernel_fila_sse2_64(const void* datos, int n, long long* sumas_columna) {
+    const uint64_t* fila = (const uint64_t*)datos;
+    __m128i suma = _mm_setzero_si128();
+    int j = 0;
+
+    for (; j + 4 <= n; j += 4) {
+        suma = _mm_add_epi64(suma, acumular_sse2(sumas_columna + j,
+                                                 _mm_loadu_si128((const __m128i*)(fila + j)),
+                                                 _mm_loadu_si128((const __m128i*)(fila + j + 2))));
+    }
+
+    return reducir_sse2(suma) + kernel_fila_escalar_64(fila + j, n - j, sumas_columna + j);
+}
+
+// Suma ocho columnas de 64 bits (bajo: j..j+3; alto: j+4..j+7) a los acumuladores
+__attribute__((target("avx2")))
+static inline __m256i acumular_avx2(long long* sumas_columna, __m256i bajo, __m256i alto) {
+    __m256i* col = (__m256i*)sumas_columna;
+    _mm256_storeu_si256(col, _mm256_add_epi64(_mm256_loadu_si256(col), bajo));
+    _mm256_storeu_si256(col + 1, _mm256_add_epi64(_mm256_loadu_si256(col + 1), alto));
+    return _mm256_add_epi64(bajo, alto);
+}
+
+__attribute__((target("avx2")))
+static inline long long reducir_avx2(__m256i suma) {
+    long long parcial[4];
+    _mm256_storeu_si256((__m256i*)parcial, suma);
+    return parcial[0] + parcial[1] + parcial[2] + parcial[3];
+}
+
+// AVX2, 16 bits: 8 celdas por iteración, extendidas con vpmovzxwq
+__attribute__((target("avx2")))
+static long long kernel_fila_avx2_16(const void* datos, int n, long long* sumas_columna) {
+    const uint16_t* fila = (const uint16_t*)datos;
+    __m256i suma = _mm256_setzero_si256();
+    int j = 0;
+
+    for (; j + 8 <= n; j += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(fila + j));
+        suma = _mm256_add_epi64(suma, acumular_avx2(sumas_columna + j,
+                                                    _mm256_cvtepu16_epi64(v),
+                                                    _mm256_cvtepu16_epi64(_mm_srli_si128(v, 8))));
+    }
+
+    return reducir_avx2(suma) + kernel_fila_escalar_16(fila + j, n - j, sumas_columna + j);
+}
+
+// AVX2, 32 bits: 8 celdas por iteración, extendidas con vpmovzxdq
+__attribute__((target("avx2")))
+static long long kernel_fila_avx2_32(const void* datos, int n, long long* sumas_columna) {
+    const uint32_t* fila = (const uint32_t*)datos;
+    __m256i suma = _mm256_setzero_si256();
+    int j = 0;
+
+    for (; j + 8 <= n; j += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(fila + j));
+        suma = _mm256_add_epi64(suma, acumular_avx2(sumas_columna + j,
+                                                    _mm256_cvtepu32_epi64(_mm256_castsi256_si128(v)),
+                                                    _mm256_cvtepu32_epi64(_mm256_extracti128_si256(v, 1))));
+    }
+
+    return reducir_avx2(suma) + kernel_fila_escalar_32(fila + j, n - j, sumas_columna + j);
+}
+
+// AVX2, 64 bits: 8 celdas por iteración, sin extensión
+__attribute__((target("avx2")))
+static long long kernel_fila_avx2_64(const void* datos, int n, long long* sumas_columna) {
+    const uint64_t* fila = (const uint64_t*)datos;
+    __m256i suma = _mm256_setzero_si256();
+    int j = 0;
+
+    for (; j + 8 <= n; j += 8) {
+        suma = _mm256_add_epi64(suma, acumular_avx2(sumas_columna + j,
+                                                    _mm256_loadu_si256((const __m256i*)(fila + j)),
+                                                    _mm256_loadu_si256((const __m256i*)(fila + j + 4))));
+    }
+
+    return reducir_avx2(suma) + kernel_fila_escalar_64(fila + j, n - j, sumas_columna + j);
+}
+
+#endif // VALIDACION_X86
+
+// Conjunto de kernels elegido, indexado por ancho de celda
+typedef struct {
+    KernelFila k16, k32, k64;
+    const char* nombre;
+} KernelsFila;
+
+static KernelsFila kernels_elegidos;
+static pthread_once_t kernels_una_vez = PTHREAD_ONCE_INIT;
+
+// Elige los kernels según las capacidades del procesador. Corre una sola
+// vez aunque la primera llamada llegue desde varios hilos a la vez.
+static void elegir_kernels_una_vez(void) {
+    KernelsFila k = {kernel_fila_escalar_16, kernel_fila_escalar_32, kernel_fila_escalar_64, "escalar"};
+#ifdef VALIDACION_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        k = (KernelsFila){kernel_fila_avx2_16, kernel_fila_avx2_32, kernel_fila_avx2_64, "avx2"};
+    } else if (__builtin_cpu_supports("sse2")) {
+        k = (KernelsFila){kernel_fila_sse2_16, kernel_fila_sse2_32, kernel_fila_sse2_64, "sse2"};
+    }
+#endif
+    kernels_elegidos = k;
+}
+
+static const KernelsFila* elegir_kernels(void) {
+    pthread_once(&kernels_una_vez, elegir_kernels_una_vez);
+    return &kernels_elegidos;
+}
+
+// Devuelve el kernel más rápido para filas del ancho dado
+KernelFila seleccionar_kernel_fila(AnchoCelda ancho) {
+    const KernelsFila* k = elegir_kernels();
+    switch (ancho) {
+        case CELDA_16: return k->k16;
+        case CELDA_64: return k->k64;
+        default:       return k->k32;
+    }
+}
+
+const char* nombre_kernel_fila(void) {
+    return elegir_kernels()->nombre;
+}
+
+// Número de núcleos en línea (al menos 1)
+int hilos_disponibles(void) {
+    long nucleos = sysconf(_SC_NPROCESSORS_ONLN);
+    return nucleos > 0 ? (int)nucleos : 1;
+}
+
+// ============= VALIDACIÓN POR BANDAS =============
+
+// Estado compartido por todos los trabajadores de una validación
+typedef struct {
+    FuenteFila fuente;
+    const void* datos;
+    AnchoCelda ancho;
+    int n;
+    long long suma_esperada;
+    KernelFila kernel;
+    int filas_por_banda;
+    int siguiente_banda;     // Contador atómico de bandas repartidas
+    int cancelado;           // Se activa en cuanto una línea falla
+} ValidacionCompartida;
+
+// Sumas parciales que produce cada trabajador
+typedef struct {
+    ValidacionCompartida* compartida;
+    long long* sumas_columna;
+    long long diagonal_principal;
+    long long diagonal_secundaria;
+    void* buffer;                // Buffer de fila prestado, o NULL para reservarlo
+    pthread_t hilo;
+} TrabajadorValidacion;
+
+// Toma bandas de filas hasta que se acaben o alguien cancele
+static void* procesar_bandas(void* arg) {
+    TrabajadorValidacion* t = (TrabajadorValidacion*)arg;
+    ValidacionCompartida* c = t->compartida;
+    int n = c->n;
+
+    void* buffer = t->buffer ? t->buffer : malloc((size_t)n * c->ancho);
+    if (!buffer) {
+        __atomic_store_n(&c->cancelado, 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+
+    while (!__atomic_load_n(&c->cancelado, __ATOMIC_RELAXED)) {
+        int banda = __atomic_fetch_add(&c->siguiente_banda, 1, __ATOMIC_RELAXED);
+        int inicio = banda * c->filas_por_banda;
+        if (inicio >= n) break;
+        int fin = inicio + c->filas_por_banda;
+        if (fin > n) fin = n;
+
+        for (int i = inicio; i < fin; i++) {
+            const void* fila = c->fuente(c->datos, n, i, buffer);
+            if (c->kernel(fila, n, t->sumas_columna) != c->suma_esperada) {
+                __atomic_store_n(&c->cancelado, 1, __ATOMIC_RELAXED);
+                break;
+            }
+            t->diagonal_principal += (long long)leer_celda(fila, c->ancho, (size_t)i);
+            t->diagonal_secundaria += (long long)leer_celda(fila, c->ancho, (size_t)(n - 1 - i));
+        }
+    }
+
+    if (buffer != t->buffer) free(buffer);
+    return NULL;
+}
+
+// Valida las n filas que entrega la fuente. Con num_hilos > 1 las filas se
+// reparten en bandas entre los hilos; cada uno acumula sus propias sumas de
+// columna y diagonales, que se reducen al final.
+bool validar_filas(FuenteFila fuente, const void* datos, AnchoCelda ancho, int n,
+                   long long suma_esperada, int num_hilos) {
+    if (num_hilos <= 0) num_hilos = hilos_disponibles();
+    if (num_hilos > n) num_hilos = n;
+
+    ValidacionCompartida compartida;
+    compartida.fuente = fuente;
+    compartida.datos = datos;
+    compartida.ancho = ancho;
+    compartida.n = n;
+    compartida.suma_esperada = suma_esperada;
+    compartida.kernel = seleccionar_kernel_fila(ancho);
+    compartida.siguiente_banda = 0;
+    compartida.cancelado = 0;
+    // Varias bandas por hilo para repartir bien la carga
+    compartida.filas_por_banda = n / (num_hilos * 8);
+    if (compartida.filas_por_banda < 1) compartida.filas_por_banda = 1;
+
+    // Con un hilo y n chico todo vive en la pila: validar no reserva memoria
+    long long sumas_pila[MAX_ORDEN_VALIDACION_EN_PILA];
+    uint64_t buffer_pila[MAX_ORDEN_VALIDACION_EN_PILA];
+    TrabajadorValidacion trabajador_pila;
+    bool en_pila = num_hilos == 1 && n <= MAX_ORDEN_VALIDACION_EN_PILA;
+
+    TrabajadorValidacion* trabajadores = en_pila ? &trabajador_pila :
+        (TrabajadorValidacion*)malloc((size_t)num_hilos * sizeof(TrabajadorValidacion));
+    if (!trabajadores) return false;
+    memset(trabajadores, 0, (size_t)num_hilos * sizeof(TrabajadorValidacion));
+
+    int lanzados = 0;
+    bool valido = true;
+    for (int h = 0; h < num_hilos; h++) {
+        trabajadores[h].compartida = &compartida;
+        if (en_pila) {
+            memset(sumas_pila, 0, (size_t)n * sizeof(long long));
+            trabajadores[h].sumas_columna = sumas_pila;
+            trabajadores[h].buffer = buffer_pila;
+            continue;
+        }
+        trabajadores[h].sumas_columna = (long long*)calloc((size_t)n, sizeof(long long));
+        if (!trabajadores[h].sumas_columna) {
+            valido = false;
+            break;
+        }
+    }
+
+    if (valido) {
+        // El hilo actual hace de trabajador 0
+        for (int h = 1; h < num_hilos; h++) {
+            if (pthread_create(&trabajadores[h].hilo, NULL, procesar_bandas, &trabajadores[h]) != 0) {
+                break;
+            }
+            lanzados++;
+        }
+        procesar_bandas(&trabajadores[0]);
+        for (int h = 1; h <= lanzados; h++) {
+            pthread_join(trabajadores[h].hilo, NULL);
+        }
+        valido = !compartida.cancelado;
+    }
+
+    // Reducción de las sumas parciales
+    if (valido) {
+        long long diagonal_principal = 0, diagonal_secundaria = 0;
+        for (int h = 0; h <= lanzados; h++) {
+            diagonal_principal += trabajadores[h].diagonal_principal;
+            diagonal_secundaria += trabajadores[h].diagonal_secundaria;
+        }
+        if (diagonal_principal != suma_esperada || diagonal_secundaria != suma_esperada) {
+            valido = false;
+        }
+
+        for (int j = 0; j < n && valido; j++) {
+            long long suma = 0;
+            for (int h = 0; h <= lanzados; h++) {
+                suma += trabajadores[h].sumas_columna[j];
+            }
+            if (suma != suma_esperada) valido = false;
+        }
+    }
+
+    if (!en_pila) {
+        for (int h = 0; h < num_hilos; h++) {
+            free(trabajadores[h].sumas_columna);
+        }
+        free(trabajadores);
+    }
+    return valido;
+}
+
+// Matriz guardada fila por fila y el ancho de sus celdas
+typedef struct {
+    const void* matriz;
+    AnchoCelda ancho;
+} MatrizFilas;
+
+// Fuente de filas de una matriz guardada fila por fila: sin copias
+static const void* fila_de_matriz(const void* datos, int n, int fila, void* buffer) {
+    (void)buffer;
+    const MatrizFilas* m = (const MatrizFilas*)datos;
+    return (const char*)m->matriz + (size_t)fila * n * m->ancho;
+}
+
+// Valida una matriz n*n guardada fila por fila en el hilo actual
+bool validar_matriz_por_filas(const void* matriz, AnchoCelda ancho, int n, long long suma_esperada) {
+    return validar_matriz_paralela(matriz, ancho, n, suma_esperada, 1);
+}
+
+// Valida una matriz n*n repartiendo bandas de filas entre num_hilos hilos
+bool validar_matriz_paralela(const void* matriz, AnchoCelda ancho, int n, long long suma_esperada,
+                             int num_hilos) {
+    MatrizFilas m = {matriz, ancho};
+    return validar_filas(fila_de_matriz, &m, ancho, n, suma_esperada, num_hilos);
+}
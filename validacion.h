@@ -0,0 +1,46 @@
+/*
+ * Validación de cuadros mágicos en una sola pasada por filas.
+ *
+ * Cada fila se lee una vez: se suma, se agrega a los acumuladores de
+ * columna y se toman sus dos elementos de las diagonales. Hay un kernel
+ * por ancho de celda (16, 32 y 64 bits) y el juego de kernels (escalar,
+ * SSE2 o AVX2) se elige en tiempo de ejecución.
+ * Los cuadros grandes se validan en paralelo por bandas de filas.
+ */
+
+#ifndef VALIDACION_H
+#define VALIDACION_H
+
+#include <stdbool.h>
+#include "cuadros_magicos.h"
+
+// Orden hasta el que una validación de un solo hilo usa solo la pila
+#define MAX_ORDEN_VALIDACION_EN_PILA 1024
+
+// Suma una fila a los acumuladores de columna y devuelve la suma de la fila.
+// Las celdas son enteros sin signo del ancho con que se eligió el kernel.
+typedef long long (*KernelFila)(const void* fila, int n, long long* sumas_columna);
+
+// Devuelve la fila pedida; puede escribirla en buffer (n celdas) y
+// devolver buffer, o devolver un puntero a datos ya existentes
+typedef const void* (*FuenteFila)(const void* datos, int n, int fila, void* buffer);
+
+// Devuelve el kernel más rápido que soporta el procesador para el ancho dado
+KernelFila seleccionar_kernel_fila(AnchoCelda ancho);
+const char* nombre_kernel_fila(void);
+
+// Número de núcleos disponibles para validar en paralelo
+int hilos_disponibles(void);
+
+// Valida las n filas de una fuente. Con num_hilos > 1 reparte bandas de filas
+// entre hilos y cancela a todos en cuanto una fila falla; num_hilos <= 0 usa
+// todos los núcleos.
+bool validar_filas(FuenteFila fuente, const void* datos, AnchoCelda ancho, int n,
+                   long long suma_esperada, int num_hilos);
+
+// Valida una matriz n*n guardada fila por fila
+bool validar_matriz_por_filas(const void* matriz, AnchoCelda ancho, int n, long long suma_esperada);
+bool validar_matriz_paralela(const void* matriz, AnchoCelda ancho, int n, long long suma_esperada,
+                             int num_hilos);
+
+#endif // VALIDACION_H